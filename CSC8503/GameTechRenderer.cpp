@@ -142,12 +142,11 @@ void GameTechRenderer::RenderFrame() {
 void GameTechRenderer::BuildObjectList() {
 	activeObjects.clear();
 
-	gameWorld.OperateOnContents(
-		[&](GameObject* o) {
-			if (o->IsActive()) {
-				const RenderObject* g = o->GetRenderObject();
-				if (g) {
-					activeObjects.emplace_back(g);
+	gameWorld.OperateOnArchetypes(RenderComponent,
+		[&](Archetype& a) {
+			for (size_t i = 0; i < a.Size(); ++i) {
+				if (a.objects[i]->IsActive()) {
+					activeObjects.emplace_back(a.renders[i]);
 				}
 			}
 		}
@@ -177,7 +176,7 @@ void GameTechRenderer::RenderShadowMap() {
 	shadowMatrix = biasMatrix * mvMatrix; //we'll use this one later on
 
 	for (const auto&i : activeObjects) {
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
+		const Matrix4& modelMatrix = (*i).GetTransform()->GetMatrix();
 		Matrix4 mvpMatrix	= mvMatrix * modelMatrix;
 		glUniformMatrix4fv(mvpLocation, 1, false, (float*)&mvpMatrix);
 		BindMesh((OGLMesh&)*(*i).GetMesh());
@@ -285,7 +284,7 @@ void GameTechRenderer::RenderCamera() {
 			activeShader = shader;
 		}
 
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
+		const Matrix4& modelMatrix = (*i).GetTransform()->GetMatrix();
 		glUniformMatrix4fv(modelLocation, 1, false, (float*)&modelMatrix);			
 		
 		Matrix4 fullShadowMat = shadowMatrix * modelMatrix;
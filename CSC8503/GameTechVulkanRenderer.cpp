@@ -375,11 +375,11 @@ void GameTechVulkanRenderer::UpdateObjectList() {
 
 	VulkanMesh* pipeMesh = nullptr;
 	int at = 0;
-	gameWorld.OperateOnContents(
-		[&](GameObject* o) {
-			if (o->IsActive()) {
-				RenderObject* g = o->GetRenderObject();
-				if (g) {
+	gameWorld.OperateOnArchetypes(RenderComponent,
+		[&](Archetype& a) {
+			for (size_t i = 0; i < a.Size(); ++i) {
+				if (a.objects[i]->IsActive()) {
+					RenderObject* g = a.renders[i];
 					activeObjects.emplace_back(g);
 
 					ObjectState state;
@@ -23,6 +23,7 @@
 #include "BehaviourSelector.h"
 #include "BehaviourSequence.h"
 #include "BehaviourAction.h"
+#include "CompiledBehaviourTree.h"
 
 using namespace NCL;
 using namespace CSC8503;
@@ -96,6 +97,98 @@ void DisplayPathfinding() {
 	}
 }
 
+/*
+Compares the grid search modes on a mostly open grid, and on a maze made
+of one node wide corridors - JPS does best in the open, where it can make
+long jumps, and has far less of an advantage in the maze. Bear in mind that
+the A* mode is 4-connected, and its heuristic is in world units rather than
+steps, so it behaves like a greedy search - quick, but its paths are longer.
+*/
+std::vector<char> MakeOpenGrid(int width, int height) {
+	std::vector<char> types(width * height, '.');
+	for (char& t : types) {
+		if (rand() % 100 < 10) {
+			t = 'x';
+		}
+	}
+	return types;
+}
+
+std::vector<char> MakeMazeGrid(int width, int height) {
+	std::vector<char> types(width * height, 'x');
+	std::vector<std::pair<int, int>> stack;
+
+	types[width + 1] = '.';
+	stack.push_back({ 1, 1 });
+
+	while (!stack.empty()) { //carve out a maze with a randomised depth first search
+		int x = stack.back().first;
+		int y = stack.back().second;
+
+		const int dirs[4][2] = { {2, 0}, {-2, 0}, {0, 2}, {0, -2} };
+		int options[4];
+		int optionCount = 0;
+		for (int i = 0; i < 4; ++i) {
+			int nx = x + dirs[i][0];
+			int ny = y + dirs[i][1];
+			if (nx > 0 && nx < width - 1 && ny > 0 && ny < height - 1 && types[(ny * width) + nx] == 'x') {
+				options[optionCount++] = i;
+			}
+		}
+		if (optionCount == 0) {
+			stack.pop_back();
+			continue;
+		}
+		int d = options[rand() % optionCount];
+		types[((y + dirs[d][1] / 2) * width) + x + dirs[d][0] / 2] = '.';
+		types[((y + dirs[d][1]) * width) + x + dirs[d][0]] = '.';
+		stack.push_back({ x + dirs[d][0], y + dirs[d][1] });
+	}
+	return types;
+}
+
+void BenchmarkPathfinding() {
+	const int gridSize		= 257;
+	const int nodeSize		= 10;
+	const int queryCount	= 200;
+
+	const char* gridNames[2] = { "Open", "Maze" };
+	const char* modeNames[3] = { "A*", "JPS", "JPS+" };
+
+	for (int grid = 0; grid < 2; ++grid) {
+		std::vector<char> types = grid == 0 ? MakeOpenGrid(gridSize, gridSize) : MakeMazeGrid(gridSize, gridSize);
+
+		NavigationGrid navGrid(nodeSize, gridSize, gridSize, types.data());
+		navGrid.BuildJumpPointTable();
+
+		std::vector<std::pair<Vector3, Vector3>> queries;
+		while (queries.size() < queryCount) {
+			int a = rand() % (gridSize * gridSize);
+			int b = rand() % (gridSize * gridSize);
+			if (types[a] == 'x' || types[b] == 'x') {
+				continue;
+			}
+			queries.push_back({
+				Vector3((float)((a % gridSize) * nodeSize), 0, (float)((a / gridSize) * nodeSize)),
+				Vector3((float)((b % gridSize) * nodeSize), 0, (float)((b / gridSize) * nodeSize))
+			});
+		}
+
+		GridSearchScratch scratch;
+		for (int mode = AStarSearch; mode <= JumpPointPlusSearch; ++mode) {
+			int found = 0;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (auto& q : queries) {
+				NavigationPath path;
+				found += navGrid.FindPath(q.first, q.second, path, scratch, (GridSearchMode)mode) ? 1 : 0;
+			}
+			std::chrono::duration<float, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+			std::cout << gridNames[grid] << " grid, " << modeNames[mode] << ": " << time.count() / queryCount
+				<< "ms per path (" << found << " / " << queryCount << " found)\n";
+		}
+	}
+}
+
 void TestBehaviourTree() {
 	float behaviourTimer;
 	float distanceToTarget;
@@ -210,6 +303,82 @@ void TestBehaviourTree() {
 	std::cout << "All done\n";
 }
 
+/*
+The same adventure as TestBehaviourTree, but using a CompiledBehaviourTree - the
+timers that were captured locals now live in each agent's blackboard, so the
+one tree can run a whole party of adventurers at once.
+*/
+void TestCompiledBehaviourTree() {
+	const int timerSlot		= 0;
+	const int distanceSlot	= 1;
+
+	CompiledBehaviourTree tree;
+	tree.BeginSequence("Root Sequence");
+		tree.BeginSequence("Room Sequence");
+		tree.AddAction("Find Key", [](float dt, BehaviourState state, BehaviourAgentState& agent, void*)->BehaviourState {
+			if (state == Initialise) {
+				agent.blackboard[timerSlot] = (float)(rand() % 100);
+				return Ongoing;
+			}
+			agent.blackboard[timerSlot] -= dt;
+			return agent.blackboard[timerSlot] <= 0.0f ? Success : Ongoing;
+		});
+		tree.AddAction("Go To Room", [](float dt, BehaviourState state, BehaviourAgentState& agent, void*)->BehaviourState {
+			agent.blackboard[distanceSlot] -= dt;
+			return agent.blackboard[distanceSlot] <= 0.0f ? Success : Ongoing;
+		});
+		tree.AddAction("Open Door", [](float dt, BehaviourState state, BehaviourAgentState& agent, void*)->BehaviourState {
+			return Success;
+		});
+		tree.End();
+
+		tree.BeginSelector("Loot Selection");
+		tree.AddAction("Look For Treasure", [](float dt, BehaviourState state, BehaviourAgentState& agent, void*)->BehaviourState {
+			if (state == Initialise) {
+				return Ongoing;
+			}
+			return rand() % 2 ? Success : Failure;
+		});
+		tree.AddAction("Look For Items", [](float dt, BehaviourState state, BehaviourAgentState& agent, void*)->BehaviourState {
+			if (state == Initialise) {
+				return Ongoing;
+			}
+			return rand() % 2 ? Success : Failure;
+		});
+		tree.End();
+	tree.End();
+
+	const int partySize = 10000;
+	std::vector<BehaviourAgentState>	party(partySize);
+	std::vector<BehaviourState>			results(partySize, Ongoing);
+	for (int i = 0; i < partySize; ++i) {
+		party[i].agentID = i;
+		party[i].blackboard[distanceSlot] = (float)(rand() % 250);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	int ticks		= 0;
+	int stillGoing	= partySize;
+	while (stillGoing > 0) {
+		stillGoing = 0;
+		for (int i = 0; i < partySize; ++i) {
+			if (results[i] == Ongoing) {
+				results[i] = tree.Tick(party[i], 1.0f);
+				stillGoing += results[i] == Ongoing;
+			}
+		}
+		ticks++;
+	}
+	std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+
+	int successes = 0;
+	for (BehaviourState s : results) {
+		successes += s == Success;
+	}
+	std::cout << partySize << " adventurers, " << ticks << " ticks in " << time.count() << "ms - "
+		<< successes << " successful adventures\n";
+}
+
 Window* w;
 
 int highScore = -1;
@@ -388,6 +557,8 @@ int main() {
 	//TestNetworking();
 	//TestStateMachine();
 	//TestBehaviourTree();
+	//TestCompiledBehaviourTree();
+	//BenchmarkPathfinding();
 	WindowInitialisation initInfo;
 	initInfo.width = 1280;
 	initInfo.height = 720;
@@ -1,5 +1,6 @@
 #include "NetworkPlayer.h"
 #include "NetworkedGame.h"
+#include "NetworkObject.h"
 
 using namespace NCL;
 using namespace CSC8503;
@@ -7,6 +8,7 @@ using namespace CSC8503;
 NetworkPlayer::NetworkPlayer(NetworkedGame* game, int num)	{
 	this->game = game;
 	playerNum  = num;
+	moveSpeed  = 10.0f;
 }
 
 NetworkPlayer::~NetworkPlayer()	{
@@ -20,4 +22,29 @@ void NetworkPlayer::OnCollisionBegin(GameObject* otherObject) {
 			game->OnPlayerCollision(this, (NetworkPlayer*)otherObject);
 		}
 	}
+}
+
+void NetworkPlayer::ApplyInput(const PlayerInput& input, float dt) {
+	float	yaw		= Maths::DegreesToRadians(input.yaw);
+	Vector3 forward	= Vector3(-sin(yaw), 0.0f, -cos(yaw));
+	Vector3 right	= Vector3(cos(yaw), 0.0f, -sin(yaw));
+
+	Vector3 direction;
+	if (input.buttons & Button_Forward) {
+		direction += forward;
+	}
+	if (input.buttons & Button_Back) {
+		direction -= forward;
+	}
+	if (input.buttons & Button_Left) {
+		direction -= right;
+	}
+	if (input.buttons & Button_Right) {
+		direction += right;
+	}
+	if (Vector::LengthSquared(direction) > 0.0f) {
+		direction = Vector::Normalise(direction);
+	}
+	transform.SetPosition(transform.GetPosition() + (direction * moveSpeed * dt));
+	transform.SetOrientation(Quaternion::EulerAnglesToQuaternion(0.0f, input.yaw, 0.0f));
 }
\ No newline at end of file
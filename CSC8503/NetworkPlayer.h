@@ -5,6 +5,19 @@
 namespace NCL {
 	namespace CSC8503 {
 		class NetworkedGame;
+		struct PlayerInput;
+
+		//What each bit of PlayerInput::buttons means
+		enum PlayerButtons {
+			Button_Forward	= 1 << 0,
+			Button_Back		= 1 << 1,
+			Button_Left		= 1 << 2,
+			Button_Right	= 1 << 3,
+			Button_Fire		= 1 << 4
+		};
+
+		//Inputs are sampled and applied at a fixed rate, so the server and the predicting client agree on what each one does
+		const float InputTimestep = 1.0f / 60.0f;
 
 		class NetworkPlayer : public GameObject {
 		public:
@@ -13,6 +26,14 @@ namespace NCL {
 
 			void OnCollisionBegin(GameObject* otherObject) override;
 
+			/*
+			Moves the player on by one input's worth. This is all that moves a
+			player, on the server and in the client's prediction alike, so it must
+			only depend on the input and where the player already is - replaying
+			the same inputs from the same place has to end up in the same place.
+			*/
+			void ApplyInput(const PlayerInput& input, float dt);
+
 			int GetPlayerNum() const {
 				return playerNum;
 			}
@@ -20,6 +41,7 @@ namespace NCL {
 		protected:
 			NetworkedGame* game;
 			int playerNum;
+			float moveSpeed;
 		};
 	}
 }
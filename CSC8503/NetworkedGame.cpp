@@ -3,6 +3,8 @@
 #include "NetworkObject.h"
 #include "GameServer.h"
 #include "GameClient.h"
+#include "PhysicsObject.h"
+#include "RenderObject.h"
 
 #define COLLISION_MSG 30
 
@@ -16,13 +18,31 @@ struct MessagePacket : public GamePacket {
 	}
 };
 
+//Sent to a client when it connects, so it knows which of the players is its own
+struct PlayerPacket : public GamePacket {
+	int playerID;
+
+	PlayerPacket(int playerID) {
+		type			= Player_Connected;
+		size			= sizeof(int);
+		this->playerID	= playerID;
+	}
+};
+
+const int	MaxPendingInputs	= 64;
+const float	MaxInputBacklog		= 0.25f;	//after a long frame, only catch up on this much input
+
 NetworkedGame::NetworkedGame()	{
-	thisServer = nullptr;
-	thisClient = nullptr;
+	thisServer	= nullptr;
+	thisClient	= nullptr;
+	localPlayer	= nullptr;
 
 	NetworkBase::Initialise();
-	timeToNextPacket  = 0.0f;
-	packetsToSnapshot = 0;
+	timeToNextPacket	= 0.0f;
+	snapshotRate		= 20.0f;
+	firstPendingInput	= 0;
+	inputAccumulator	= 0.0f;
+	replicationClient.GetClock().SetTickRate(snapshotRate);
 }
 
 NetworkedGame::~NetworkedGame()	{
@@ -31,9 +51,11 @@ NetworkedGame::~NetworkedGame()	{
 }
 
 void NetworkedGame::StartAsServer() {
-	thisServer = new GameServer(NetworkBase::GetDefaultPort(), 4);
+	thisServer = new GameServer(NetworkBase::GetDefaultPort(), MaxPlayers);
 
 	thisServer->RegisterPacketHandler(Received_State, this);
+	thisServer->RegisterPacketHandler(Player_Connected, this);
+	thisServer->RegisterPacketHandler(Player_Disconnected, this);
 
 	StartLevel();
 }
@@ -42,15 +64,42 @@ void NetworkedGame::StartAsClient(char a, char b, char c, char d) {
 	thisClient = new GameClient();
 	thisClient->Connect(a, b, c, d, NetworkBase::GetDefaultPort());
 
-	thisClient->RegisterPacketHandler(Delta_State, this);
-	thisClient->RegisterPacketHandler(Full_State, this);
+	thisClient->RegisterPacketHandler(Snapshot_Batch, this);
 	thisClient->RegisterPacketHandler(Player_Connected, this);
 	thisClient->RegisterPacketHandler(Player_Disconnected, this);
 
+	replicationClient.Reset();
+	replicationClient.SetPredictedObject(-1);
+
+	pendingInputs.clear();
+	firstPendingInput	= 0;
+	inputAccumulator	= 0.0f;
+	localPlayer			= nullptr;
+
 	StartLevel();
+
+	if (!thisServer) {
+		for (NetworkObject* o : networkObjects) {
+			if (o) {
+				o->SetInterpolated(true);
+			}
+		}
+	}
 }
 
 void NetworkedGame::UpdateGame(float dt) {
+	if (thisServer) {
+		thisServer->UpdateServer();
+	}
+	if (thisClient) {
+		thisClient->UpdateClient();
+	}
+	//If we're the server too, everything's already where it should be
+	if (thisClient && !thisServer) {
+		UpdatePrediction(dt);
+		replicationClient.UpdateInterpolation(dt, networkObjects);
+	}
+
 	timeToNextPacket -= dt;
 	if (timeToNextPacket < 0) {
 		if (thisServer) {
@@ -59,7 +108,7 @@ void NetworkedGame::UpdateGame(float dt) {
 		else if (thisClient) {
 			UpdateAsClient(dt);
 		}
-		timeToNextPacket += 1.0f / 20.0f; //20hz server/client update
+		timeToNextPacket += 1.0f / snapshotRate;
 	}
 
 	if (!thisServer && Window::GetKeyboard()->KeyPressed(KeyCodes::F9)) {
@@ -73,86 +122,167 @@ void NetworkedGame::UpdateGame(float dt) {
 }
 
 void NetworkedGame::UpdateAsServer(float dt) {
-	packetsToSnapshot--;
-	if (packetsToSnapshot < 0) {
-		BroadcastSnapshot(false);
-		packetsToSnapshot = 5;
-	}
-	else {
-		BroadcastSnapshot(true);
-	}
+	replicationServer.SendSnapshots(*world, networkObjects, *thisServer);
 }
 
 void NetworkedGame::UpdateAsClient(float dt) {
 	ClientPacket newPacket;
+	newPacket.lastID		= replicationClient.GetLatestSnapshot();
+	newPacket.firstInput	= firstPendingInput;
+
+	int inputCount = std::min((int)pendingInputs.size(), MaxClientInputs);
+	std::copy(pendingInputs.begin(), pendingInputs.begin() + inputCount, newPacket.inputs);
+	newPacket.SetInputCount(inputCount);
 
-	if (Window::GetKeyboard()->KeyPressed(KeyCodes::SPACE)) {
-		//fire button pressed!
-		newPacket.buttonstates[0] = 1;
-		newPacket.lastID = 0; //You'll need to work this out somehow...
-	}
 	thisClient->SendPacket(newPacket);
 }
 
-void NetworkedGame::BroadcastSnapshot(bool deltaFrame) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
+/*
+Input is sampled at a fixed rate, and each one is applied to our own player
+straight away, rather than waiting a round trip for the server to do it. Each
+is kept until the server says it's applied it too, both so it can be resent
+if it gets lost, and so it can be replayed when a correction comes in.
+*/
+void NetworkedGame::UpdatePrediction(float dt) {
+	if (!localPlayer) {
+		return;
+	}
+	inputAccumulator = std::min(inputAccumulator + dt, MaxInputBacklog);
+	while (inputAccumulator >= InputTimestep) {
+		inputAccumulator -= InputTimestep;
+
+		if ((int)pendingInputs.size() == MaxPendingInputs) {
+			//The server's not hearing us - it'll have to do without the oldest
+			pendingInputs.erase(pendingInputs.begin());
+			firstPendingInput++;
+		}
+		PlayerInput input = SampleInput();
+		pendingInputs.emplace_back(input);
+		localPlayer->ApplyInput(input, InputTimestep);
+	}
+}
 
-	world->GetObjectIterators(first, last);
+PlayerInput NetworkedGame::SampleInput() const {
+	const Keyboard* keyboard = Window::GetKeyboard();
 
-	for (auto i = first; i != last; ++i) {
-		NetworkObject* o = (*i)->GetNetworkObject();
-		if (!o) {
-			continue;
-		}
-		//TODO - you'll need some way of determining
-		//when a player has sent the server an acknowledgement
-		//and store the lastID somewhere. A map between player
-		//and an int could work, or it could be part of a 
-		//NetworkPlayer struct. 
-		int playerState = 0;
-		GamePacket* newPacket = nullptr;
-		if (o->WritePacket(&newPacket, deltaFrame, playerState)) {
-			thisServer->SendGlobalPacket(*newPacket);
-			delete newPacket;
-		}
+	PlayerInput input;
+	input.yaw = world->GetMainCamera().GetYaw();
+	if (keyboard->KeyDown(KeyCodes::UP)) {
+		input.buttons |= Button_Forward;
 	}
+	if (keyboard->KeyDown(KeyCodes::DOWN)) {
+		input.buttons |= Button_Back;
+	}
+	if (keyboard->KeyDown(KeyCodes::LEFT)) {
+		input.buttons |= Button_Left;
+	}
+	if (keyboard->KeyDown(KeyCodes::RIGHT)) {
+		input.buttons |= Button_Right;
+	}
+	if (keyboard->KeyDown(KeyCodes::SPACE)) {
+		input.buttons |= Button_Fire;
+	}
+	return input;
 }
 
-void NetworkedGame::UpdateMinimumState() {
-	//Periodically remove old data from the server
-	int minID = INT_MAX;
-	int maxID = 0; //we could use this to see if a player is lagging behind?
-
-	for (auto i : stateIDs) {
-		minID = std::min(minID, i.second);
-		maxID = std::max(maxID, i.second);
-	}
-	//every client has acknowledged reaching at least state minID
-	//so we can get rid of any old states!
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	world->GetObjectIterators(first, last);
-
-	for (auto i = first; i != last; ++i) {
-		NetworkObject* o = (*i)->GetNetworkObject();
-		if (!o) {
-			continue;
-		}
-		o->UpdateStateHistory(minID); //clear out old states so they arent taking up memory...
+/*
+The server's state for our player is where it was after applying lastInput,
+which is a round trip behind what we've predicted. So we go back to that state,
+forget the inputs it already includes, and apply the rest again on top. If the
+prediction was right, that puts the player back exactly where it was.
+*/
+void NetworkedGame::Reconcile(const NetworkState& state, int lastInput) {
+	int acknowledged = std::clamp(lastInput - firstPendingInput + 1, 0, (int)pendingInputs.size());
+	pendingInputs.erase(pendingInputs.begin(), pendingInputs.begin() + acknowledged);
+	firstPendingInput += acknowledged;
+
+	localPlayer->GetTransform().SetPosition(state.position);
+	localPlayer->GetTransform().SetOrientation(state.orientation);
+	for (const PlayerInput& input : pendingInputs) {
+		localPlayer->ApplyInput(input, InputTimestep);
 	}
 }
 
-void NetworkedGame::SpawnPlayer() {
+NetworkPlayer* NetworkedGame::SpawnPlayer(int playerNum) {
+	NetworkPlayer* player = new NetworkPlayer(this, playerNum);
+	SphereVolume* volume  = new SphereVolume(0.5f);
+
+	player->SetBoundingVolume((CollisionVolume*)volume);
 
+	player->GetTransform()
+		.SetScale(Vector3(1.0f, 1.0f, 1.0f))
+		.SetPosition(Vector3(-7.5f + (playerNum * 5.0f), 2.0f, 20.0f));
+
+	player->SetRenderObject(new RenderObject(&player->GetTransform(), catMesh, nullptr, basicShader));
+	player->SetPhysicsObject(new PhysicsObject(&player->GetTransform(), player->GetBoundingVolume()));
+
+	//Only ever moved by its inputs (see NetworkPlayer::ApplyInput), so other things can't push it about
+	player->GetPhysicsObject()->SetInverseMass(0.0f);
+	player->GetPhysicsObject()->InitSphereInertia();
+
+	player->SetNetworkObject(new NetworkObject(*player, playerNum));
+
+	world->AddGameObject(player);
+
+	if (playerNum >= (int)networkObjects.size()) {
+		networkObjects.resize(playerNum + 1, nullptr);
+	}
+	networkObjects[playerNum] = player->GetNetworkObject();
+	return player;
 }
 
+//The server and clients all build the same level, so everything gets the same network ID without needing to be told it
 void NetworkedGame::StartLevel() {
-
+	if (!players.empty()) {
+		return;
+	}
+	for (int i = 0; i < MaxPlayers; ++i) {
+		players.emplace_back(SpawnPlayer(i));
+	}
 }
 
 void NetworkedGame::ReceivePacket(int type, GamePacket* payload, int source) {
-	
+	if (type == Snapshot_Batch) {
+		replicationClient.ReadSnapshot(*payload, networkObjects);
+
+		NetworkState	state;
+		int				lastInput;
+		if (localPlayer && replicationClient.PopCorrection(state, lastInput)) {
+			Reconcile(state, lastInput);
+		}
+	}
+	else if (thisServer && source >= 0) {
+		if (type == Received_State) {
+			auto player = serverPlayers.find(source);
+			replicationServer.ReceiveClientPacket(source, *payload, [&](const PlayerInput& input) {
+				if (player != serverPlayers.end()) {
+					player->second->ApplyInput(input, InputTimestep);
+				}
+			});
+		}
+		else if (type == Player_Connected) {
+			replicationServer.AddClient(source);
+			if (source < (int)players.size()) {
+				serverPlayers[source] = players[source];
+				replicationServer.SetClientPlayer(source, players[source]);
+
+				PlayerPacket packet(source);
+				thisServer->SendPacketToPeer(source, packet);
+			}
+		}
+		else if (type == Player_Disconnected) {
+			replicationServer.RemoveClient(source);
+			serverPlayers.erase(source);
+		}
+	}
+	else if (thisClient && type == Player_Connected) {
+		PlayerPacket* packet = payload->As<PlayerPacket>();
+		if (packet && packet->playerID >= 0 && packet->playerID < (int)players.size()) {
+			localPlayer = players[packet->playerID];
+			localPlayer->GetNetworkObject()->SetInterpolated(false);
+			replicationClient.SetPredictedObject(localPlayer->GetNetworkObject()->GetNetworkID());
+		}
+	}
 }
 
 void NetworkedGame::OnPlayerCollision(NetworkPlayer* a, NetworkPlayer* b) {
@@ -1,6 +1,9 @@
 #pragma once
 #include "TutorialGame.h"
 #include "NetworkBase.h"
+#include "ReplicationServer.h"
+#include "ReplicationClient.h"
+#include "NetworkObject.h"
 #include <unordered_map>
 
 namespace NCL {
@@ -9,6 +12,8 @@ namespace NCL {
 		class GameClient;
 		class NetworkPlayer;
 
+		const int MaxPlayers = 4;
+
 		class NetworkedGame : public TutorialGame, public PacketReceiver {
 		public:
 			NetworkedGame();
@@ -19,7 +24,7 @@ namespace NCL {
 
 			void UpdateGame(float dt) override;
 
-			void SpawnPlayer();
+			NetworkPlayer* SpawnPlayer(int playerNum);
 
 			void StartLevel();
 
@@ -31,19 +36,28 @@ namespace NCL {
 			void UpdateAsServer(float dt);
 			void UpdateAsClient(float dt);
 
-			void BroadcastSnapshot(bool deltaFrame);
-			void UpdateMinimumState();
-			std::map<int, int> stateIDs;
+			void UpdatePrediction(float dt);
+			PlayerInput SampleInput() const;
+			void Reconcile(const NetworkState& state, int lastInput);
 
 			GameServer* thisServer;
 			GameClient* thisClient;
 			float timeToNextPacket;
-			int packetsToSnapshot;
+			float snapshotRate;	//must match on the server and clients, as clients turn snapshot IDs back into times
+
+			std::vector<NetworkObject*> networkObjects;	//indexed by network ID
+
+			ReplicationServer	replicationServer;
+			ReplicationClient	replicationClient;	//remote objects are played back a little in the past, see InterpolationClock
 
-			std::vector<NetworkObject*> networkObjects;
+			std::vector<NetworkPlayer*>		players;		//by player number, which is also their network ID
+			std::map<int, NetworkPlayer*>	serverPlayers;	//by peer ID
+			NetworkPlayer*					localPlayer;
 
-			std::map<int, GameObject*> serverPlayers;
-			GameObject* localPlayer;
+			//Our own player is moved as soon as we press anything, and corrected once the server's caught up (see Reconcile)
+			std::vector<PlayerInput>	pendingInputs;		//applied locally, but not yet acknowledged by the server
+			int							firstPendingInput;	//the sequence number of pendingInputs[0]
+			float						inputAccumulator;
 		};
 	}
 }
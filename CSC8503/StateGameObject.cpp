@@ -1,7 +1,4 @@
 #include "StateGameObject.h"
-#include "StateTransition.h"
-#include "StateMachine.h"
-#include "State.h"
 #include "PhysicsObject.h"
 
 using namespace NCL;
@@ -9,38 +6,40 @@ using namespace CSC8503;
 
 StateGameObject::StateGameObject() {
     counter = 0.0f;
-    stateMachine = new StateMachine();
-
-    // Define state A (move left)
-    State* stateA = new State([&](float dt)->void {
-        this->MoveLeft(dt);
-        });
-
-    // Define state B (move right)
-    State* stateB = new State([&](float dt)->void {
-        this->MoveRight(dt);
-        });
-
-    // Add states to the state machine
-    stateMachine->AddState(stateA);
-    stateMachine->AddState(stateB);
-
-    // Define transitions
-    stateMachine->AddTransition(new StateTransition(stateA, stateB, [&]()->bool {
-        return this->counter > 3.0f; // Transition to move right
-        }));
-
-    stateMachine->AddTransition(new StateTransition(stateB, stateA, [&]()->bool {
-        return this->counter < 0.0f; // Transition to move left
-        }));
 }
 
 StateGameObject::~StateGameObject() {
-	delete stateMachine;
+}
+
+const CompiledStateMachine& StateGameObject::GetStateMachine() {
+    static CompiledStateMachine machine = [] {
+        CompiledStateMachine m;
+
+        // Define state A (move left)
+        int stateA = m.AddState("Move Left", [](float dt, StateMachineInstance& instance, void* context) {
+            ((StateGameObject*)context)->MoveLeft(dt);
+            });
+
+        // Define state B (move right)
+        int stateB = m.AddState("Move Right", [](float dt, StateMachineInstance& instance, void* context) {
+            ((StateGameObject*)context)->MoveRight(dt);
+            });
+
+        // Define transitions
+        m.AddTransition(stateA, stateB, [](const StateMachineInstance& instance, void* context)->bool {
+            return ((StateGameObject*)context)->counter > 3.0f; // Transition to move right
+            });
+
+        m.AddTransition(stateB, stateA, [](const StateMachineInstance& instance, void* context)->bool {
+            return ((StateGameObject*)context)->counter < 0.0f; // Transition to move left
+            });
+        return m;
+    }();
+    return machine;
 }
 
 void StateGameObject::Update(float dt) {
-    stateMachine->Update(dt);
+    GetStateMachine().Update(stateInstance, dt, this);
 }
 
 void StateGameObject::MoveLeft(float dt) {
@@ -1,9 +1,9 @@
 #pragma once
 #include "GameObject.h"
+#include "CompiledStateMachine.h"
 
 namespace NCL {
     namespace CSC8503 {
-        class StateMachine;
         class StateGameObject : public GameObject  {
         public:
             StateGameObject();
@@ -15,7 +15,10 @@ namespace NCL {
             void MoveLeft(float dt);
             void MoveRight(float dt);
 
-            StateMachine* stateMachine;
+            //Every StateGameObject shares the one definition, and just keeps its own current state
+            static const CompiledStateMachine& GetStateMachine();
+
+            StateMachineInstance stateInstance;
             float counter;
         };
     }
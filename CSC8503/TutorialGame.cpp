@@ -12,6 +12,9 @@
 #include "State.h"
 #include "PushdownMachine.h"
 #include "PushdownState.h"
+#include "LocalAvoidance.h"
+#include "JobSystem.h"
+#include "AIScheduler.h"
 
 #include <random>
 
@@ -61,10 +64,14 @@ namespace NCL {
 			GameObject* player;
 			bool home;
 
+			Vector3 preferredVelocity;	//where the state machine wants to go - avoidance has the final say
+			int		avoidanceAgent = -1;
+
 		protected:
 			void Wait() {
 				home ? GetRenderObject()->SetColour(Vector4(0, 0, 1, 1)) : GetRenderObject()->SetColour(Vector4(1, 1, 1, 1));
 				GetPhysicsObject()->ClearForces();
+				preferredVelocity = Vector3();
 			}
 
 			void FollowPlayer(float dt) {
@@ -72,8 +79,7 @@ namespace NCL {
 				Vector3 curPos = GetTransform().GetPosition();
 				Vector3 direction = playerPos - curPos;
 				direction = Vector::Normalise(direction);
-				Vector3 movement = direction * 4.0f * dt;
-				GetTransform().SetPosition(curPos + movement);
+				preferredVelocity = direction * 4.0f;
 				GetRenderObject()->SetColour(Vector4(0, 1, 0, 1));
 
 				if (curPos.x >= -2.5f && curPos.x <= 2.5f && curPos.z >= -2.5f && curPos.z <= 2.5f) {
@@ -132,6 +138,9 @@ namespace NCL {
 			}
 
 			GameObject* player;
+
+			Vector3 preferredVelocity;
+			int		avoidanceAgent = -1;
 		protected:
 			void MoveAround(float dt) {
 				Vector3 curPos = this->GetTransform().GetPosition();
@@ -145,8 +154,7 @@ namespace NCL {
 				}
 				Vector3 direction = targetPos - curPos;
 				direction = Vector::Normalise(direction);
-				Vector3 movement = direction * 2.0f * dt;
-				GetTransform().SetPosition(curPos + movement);
+				preferredVelocity = direction * 2.0f;
 			}
 
 			void AttackPlayer(float dt) {
@@ -154,8 +162,7 @@ namespace NCL {
 				Vector3 curPos = GetTransform().GetPosition();
 				Vector3 direction = playerPos - curPos;
 				direction = Vector::Normalise(direction);
-				Vector3 movement = direction * 2.0f * dt;
-				GetTransform().SetPosition(curPos + movement);
+				preferredVelocity = direction * 2.0f;
 			}
 			StateMachine* stateMachine;
 			Vector3 targetPos = Vector3(-60, -1, -1);
@@ -178,6 +185,15 @@ TutorialGame::TutorialGame() : controller(*Window::GetWindow()->GetKeyboard(), *
 
 	physics		= new PhysicsSystem(*world);
 
+	jobs		= new JobSystem();
+	avoidance	= new LocalAvoidance();
+	avoidance->SetJobSystem(jobs);
+
+	aiScheduler = new AIScheduler(jobs);
+	aiScheduler->AddLODBand(50.0f,  0.1f);
+	aiScheduler->AddLODBand(100.0f, 0.25f);
+	aiScheduler->SetTimeBudget(2.0f);
+
 	forceMagnitude	= 10.0f;
 	useGravity		= true;
 	physics->UseGravity(useGravity);
@@ -231,6 +247,9 @@ TutorialGame::~TutorialGame()	{
 	delete basicShader;
 
 	delete physics;
+	delete avoidance;
+	delete aiScheduler;
+	delete jobs;
 	delete renderer;
 	delete world;
 }
@@ -288,17 +307,14 @@ void TutorialGame::UpdateGame(float dt) {
 		}
 	}*/
 
-	if (testStateObject) {
-		testStateObject->Update(dt);
-	}
+	aiScheduler->Update(dt, world->GetMainCamera().GetPosition());
 	score = 0;
 	for (auto kitten : kittens) {
 		if (kitten->home) {
 			score++;
 		}
-		kitten->Update(dt);
 	}
-	trapper->Update(dt);
+	UpdateAvoidance(dt);
 
 	sphereSpawnTimer += dt;
 	if (sphereSpawnTimer >= 5.0f) {
@@ -334,6 +350,7 @@ void TutorialGame::UpdateGame(float dt) {
 	world->UpdateWorld(dt);
 	renderer->Update(dt);
 	physics->Update(dt);
+	world->UpdateTransforms();
 
 	renderer->Render();
 	Debug::UpdateRenderables(dt);
@@ -490,6 +507,9 @@ void TutorialGame::InitCamera() {
 void TutorialGame::InitWorld() {
 	world->ClearAndErase();
 	physics->Clear();
+	avoidance->Clear();
+	aiScheduler->Clear();
+	kittens.clear();
 
 	//BridgeConstraintTest();
 	//InitMixedGridWorld(15, 15, 7.0f, 7.0f);
@@ -646,6 +666,29 @@ GameObject* TutorialGame::AddPlayerToWorld(const Vector3& position) {
 	return player;
 }
 
+/*
+The kittens and the trapper just say which way they'd like to go - this steers
+them around each other, rather than having them walk into each other and
+leaving the physics to push them apart again.
+*/
+void TutorialGame::UpdateAvoidance(float dt) {
+	for (Kitten* k : kittens) {
+		avoidance->SetAgentPosition(k->avoidanceAgent, k->GetTransform().GetPosition());
+		avoidance->SetPreferredVelocity(k->avoidanceAgent, k->preferredVelocity);
+	}
+	avoidance->SetAgentPosition(trapper->avoidanceAgent, trapper->GetTransform().GetPosition());
+	avoidance->SetPreferredVelocity(trapper->avoidanceAgent, trapper->preferredVelocity);
+
+	avoidance->Update(dt);
+
+	for (Kitten* k : kittens) {
+		Transform& t = k->GetTransform();
+		t.SetPosition(t.GetPosition() + avoidance->GetVelocity(k->avoidanceAgent) * dt);
+	}
+	Transform& t = trapper->GetTransform();
+	t.SetPosition(t.GetPosition() + avoidance->GetVelocity(trapper->avoidanceAgent) * dt);
+}
+
 Kitten* TutorialGame::AddKittenToWorld(const Vector3& position) {
 	float meshSize = 0.5f;
 	float inverseMass = 2.0f;
@@ -666,6 +709,11 @@ Kitten* TutorialGame::AddKittenToWorld(const Vector3& position) {
 	kitten->GetPhysicsObject()->SetInverseMass(inverseMass);
 	kitten->GetPhysicsObject()->InitSphereInertia();
 
+	kitten->avoidanceAgent = avoidance->AddAgent(position, meshSize, 4.0f);
+	aiScheduler->AddAgent(&kitten->GetTransform(), [kitten](float dt) {
+		kitten->Update(dt);
+	});
+
 	world->AddGameObject(kitten);
 
 	return kitten;
@@ -692,6 +740,11 @@ Trapper* TutorialGame::AddTrapperToWorld(const Vector3& position) {
 
 	trapper->GetRenderObject()->SetColour(Vector4(1, 0, 0, 1));
 
+	trapper->avoidanceAgent = avoidance->AddAgent(position, 1.0f, 2.0f);
+	aiScheduler->AddAgent(&trapper->GetTransform(), [t = trapper](float dt) {
+		t->Update(dt);
+	});
+
 	world->AddGameObject(trapper);
 
 	return trapper;
@@ -757,6 +810,9 @@ StateGameObject* TutorialGame::AddStateObjectToWorld(const Vector3& position) {
 	apple->GetPhysicsObject()->InitSphereInertia();
 
 	world->AddGameObject(apple);
+	aiScheduler->AddAgent(&apple->GetTransform(), [apple](float dt) {
+		apple->Update(dt);
+	});
 
 	return apple;
 }
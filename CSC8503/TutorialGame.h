@@ -13,6 +13,9 @@ namespace NCL {
 	namespace CSC8503 {
 		class Kitten;
 		class Trapper;
+		class LocalAvoidance;
+		class JobSystem;
+		class AIScheduler;
 		class TutorialGame		{
 		public:
 			TutorialGame();
@@ -60,6 +63,7 @@ namespace NCL {
 			GameObject* AddPlayerToWorld(const Vector3& position);
 			Kitten* AddKittenToWorld(const Vector3& position);
 			Trapper* AddTrapperToWorld(const Vector3& position);
+			void UpdateAvoidance(float dt);
 			GameObject* AddEnemyToWorld(const Vector3& position);
 			GameObject* AddBonusToWorld(const Vector3& position);
 
@@ -70,6 +74,9 @@ namespace NCL {
 #endif
 			PhysicsSystem*		physics;
 			GameWorld*			world;
+			JobSystem*			jobs;
+			LocalAvoidance*		avoidance;
+			AIScheduler*		aiScheduler;	//ticks every agent's state machine
 
 			KeyboardMouseController controller;
 
@@ -103,7 +110,7 @@ namespace NCL {
 			GameObject* objClosest = nullptr;
 
 			StateGameObject* AddStateObjectToWorld(const Vector3& position);
-			StateGameObject* testStateObject;
+			StateGameObject* testStateObject = nullptr;
 
 			GameObject* player;
 			Trapper* trapper;
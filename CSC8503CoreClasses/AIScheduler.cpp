@@ -0,0 +1,151 @@
+#include "AIScheduler.h"
+#include "JobSystem.h"
+#include "Transform.h"
+
+#include <chrono>
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+AIScheduler::AIScheduler(JobSystem* jobs) {
+	jobSystem		= jobs;
+	cursor			= 0;
+	timeBudget		= 2.0f;
+	batchSize		= 256;
+	updatedCount	= 0;
+	deferredCount	= 0;
+	lastUpdateTime	= 0.0f;
+}
+
+AIScheduler::~AIScheduler() {
+}
+
+int AIScheduler::AddAgent(const Transform* transform, AIUpdateFunc update, bool threadSafe) {
+	int id;
+	if (!freeAgents.empty()) {
+		id = freeAgents.back();
+		freeAgents.pop_back();
+	}
+	else {
+		id = (int)agents.size();
+		agents.emplace_back();
+	}
+	Agent& a = agents[id];
+	a.update			= update;
+	a.transform			= transform;
+	a.timeSinceUpdate	= 0.0f;
+	a.threadSafe		= threadSafe;
+	a.active			= true;
+	return id;
+}
+
+void AIScheduler::RemoveAgent(int agent) {
+	if (agent < 0 || agent >= (int)agents.size() || !agents[agent].active) {
+		return;
+	}
+	agents[agent].active = false;
+	agents[agent].update = nullptr;
+	freeAgents.emplace_back(agent);
+}
+
+void AIScheduler::Clear() {
+	agents.clear();
+	freeAgents.clear();
+	cursor = 0;
+}
+
+void AIScheduler::AddLODBand(float distance, float interval) {
+	lodBands.push_back({ distance * distance, interval });
+}
+
+void AIScheduler::ClearLODBands() {
+	lodBands.clear();
+}
+
+float AIScheduler::GetInterval(const Agent& a, const Vector3& cameraPosition) const {
+	if (!a.transform) {
+		return 0.0f;
+	}
+	float distanceSquared	= Vector::LengthSquared(a.transform->GetPosition() - cameraPosition);
+	float interval			= 0.0f;
+	for (const LODBand& b : lodBands) {
+		if (distanceSquared < b.distanceSquared) {
+			break;
+		}
+		interval = b.interval;
+	}
+	return interval;
+}
+
+void AIScheduler::RunAgent(Agent& a) {
+	a.update(a.timeSinceUpdate);
+	a.timeSinceUpdate = 0.0f;
+}
+
+void AIScheduler::Update(float dt, const Vector3& cameraPosition) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	updatedCount	= 0;
+	deferredCount	= 0;
+
+	//Work out who's due, starting from wherever we ran out of time last frame
+	dueAgents.clear();
+	size_t agentCount = agents.size();
+	if (cursor >= agentCount) {
+		cursor = 0;
+	}
+	for (size_t i = 0; i < agentCount; ++i) {
+		size_t index = (cursor + i) % agentCount;
+		Agent& a = agents[index];
+		if (!a.active) {
+			continue;
+		}
+		a.timeSinceUpdate += dt;
+		if (a.timeSinceUpdate >= GetInterval(a, cameraPosition)) {
+			dueAgents.emplace_back((int)index);
+		}
+	}
+
+	size_t batch = std::max(1, batchSize);
+	size_t done = 0;
+	while (done < dueAgents.size()) {
+		size_t end = std::min(dueAgents.size(), done + batch);
+
+		parallelBatch.clear();
+		for (size_t i = done; i < end; ++i) {
+			Agent& a = agents[dueAgents[i]];
+			if (a.threadSafe && jobSystem) {
+				parallelBatch.emplace_back(dueAgents[i]);
+			}
+			else {
+				RunAgent(a);
+			}
+		}
+		if (!parallelBatch.empty()) {
+			jobSystem->ParallelFor(parallelBatch.size(), 16, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					RunAgent(agents[parallelBatch[i]]);
+				}
+			});
+		}
+		done = end;
+
+		std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		if (elapsed.count() >= timeBudget) {
+			break;
+		}
+	}
+	updatedCount	= (int)done;
+	deferredCount	= (int)(dueAgents.size() - done);
+
+	if (deferredCount > 0) {
+		cursor = dueAgents[done];	//the first agent we didn't get to goes first next time
+	}
+	else if (done > 0) {
+		cursor = dueAgents[done - 1] + 1;
+	}
+
+	std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	lastUpdateTime = elapsed.count();
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "Vector.h"
+
+#include <vector>
+#include <functional>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		class JobSystem;
+		class Transform;
+
+		typedef std::function<void(float dt)> AIUpdateFunc;
+
+		/*
+		Ticks every AI agent's state machine / behaviour tree from one place, so the
+		total AI cost per frame can be kept under control, however many agents there
+		are:
+
+		- Agents far from the camera are level-of-detailed down to a few updates a
+		second. They get all of the time that has passed since their last update as
+		their dt, so they still keep up, just in bigger steps.
+
+		- Agents that are due are run in batches, spread over the JobSystem if there
+		is one. Once the frame's time budget has gone, the remaining agents wait
+		until next frame, and next frame picks up where this one stopped, so every
+		agent gets its turn eventually (round-robin). At least one batch always runs
+		to guarantee progress.
+
+		Agents that aren't safe to run in parallel with each other (they touch
+		shared state) can be flagged as such, and are run on the calling thread.
+		Agents can't be added or removed from inside an update func.
+		*/
+		class AIScheduler	{
+		public:
+			AIScheduler(JobSystem* jobs = nullptr);
+			~AIScheduler();
+
+			int  AddAgent(const Transform* transform, AIUpdateFunc update, bool threadSafe = true);
+			void RemoveAgent(int agent);
+			void Clear();
+
+			//Agents further away than distance update every interval seconds - pass them in nearest first
+			void AddLODBand(float distance, float interval);
+			void ClearLODBands();
+
+			void SetTimeBudget(float milliseconds) {
+				timeBudget = milliseconds;
+			}
+			void SetBatchSize(int size) {
+				batchSize = size;
+			}
+
+			void Update(float dt, const Vector3& cameraPosition);
+
+			int GetAgentCount() const {
+				return (int)(agents.size() - freeAgents.size());
+			}
+			int GetUpdatedCount() const {	//in the last Update
+				return updatedCount;
+			}
+			int GetDeferredCount() const {	//due in the last Update, but ran out of time
+				return deferredCount;
+			}
+			float GetLastUpdateTime() const {	//in milliseconds
+				return lastUpdateTime;
+			}
+
+		protected:
+			struct Agent {
+				AIUpdateFunc		update;
+				const Transform*	transform;
+				float				timeSinceUpdate;
+				bool				threadSafe;
+				bool				active;
+			};
+			struct LODBand {
+				float distanceSquared;
+				float interval;
+			};
+
+			float GetInterval(const Agent& a, const Vector3& cameraPosition) const;
+			void  RunAgent(Agent& a);
+
+			std::vector<Agent>		agents;
+			std::vector<int>		freeAgents;
+			std::vector<LODBand>	lodBands;
+
+			std::vector<int>		dueAgents;
+			std::vector<int>		parallelBatch;
+
+			JobSystem*	jobSystem;
+			size_t		cursor;		//where the next frame's round-robin starts from
+			float		timeBudget;
+			int			batchSize;
+
+			int			updatedCount;
+			int			deferredCount;
+			float		lastUpdateTime;
+		};
+	}
+}
@@ -0,0 +1,146 @@
+#include "BitStream.h"
+
+#include <cstring>
+
+using namespace NCL;
+using namespace CSC8503;
+
+BitWriter::BitWriter(void* buffer, size_t sizeInBytes) {
+	data			= (uint8_t*)buffer;
+	capacityBits	= sizeInBytes * 8;
+	Reset();
+}
+
+void BitWriter::Reset() {
+	bitPos		= 0;
+	overflowed	= false;
+}
+
+void BitWriter::WriteBits(uint32_t value, int bitCount) {
+	if (bitCount <= 0) {
+		return;
+	}
+	if (overflowed || bitPos + bitCount > capacityBits) {
+		overflowed = true;
+		return;
+	}
+	if (bitCount < 32) {
+		value &= (1u << bitCount) - 1;
+	}
+	while (bitCount > 0) {
+		size_t	byteIndex	= bitPos / 8;
+		int		bitOffset	= (int)(bitPos % 8);
+		int		bitsHere	= 8 - bitOffset;
+		if (bitsHere > bitCount) {
+			bitsHere = bitCount;
+		}
+		uint8_t mask = (uint8_t)(((1u << bitsHere) - 1) << bitOffset);
+		//clear the bits first, the buffer might have old data in it
+		data[byteIndex] = (uint8_t)((data[byteIndex] & ~mask) | ((value << bitOffset) & mask));
+
+		value		>>= bitsHere;
+		bitCount	-= bitsHere;
+		bitPos		+= bitsHere;
+	}
+}
+
+void BitWriter::WriteFloat(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(float));
+	WriteBits(bits, 32);
+}
+
+void BitWriter::WriteVarint(uint32_t value) {
+	while (value >= 0x80) {
+		WriteBits((value & 0x7F) | 0x80, 8);
+		value >>= 7;
+	}
+	WriteBits(value, 8);
+}
+
+void BitWriter::WriteSignedCompact(int32_t value) {
+	uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+	if (zigzag == 0) {
+		WriteBits(0, 1);
+		return;
+	}
+	int bitCount = 0;
+	while (bitCount < 32 && (zigzag >> bitCount) != 0) {
+		bitCount++;
+	}
+	WriteBits(1, 1);
+	WriteBits(bitCount - 1, 5);
+	WriteBits(zigzag, bitCount);
+}
+
+void BitWriter::WriteStream(const BitWriter& other) {
+	size_t			bitsLeft	= other.GetBitCount();
+	const uint8_t*	source		= other.GetData();
+	while (bitsLeft > 0) {
+		int bits = bitsLeft >= 8 ? 8 : (int)bitsLeft;
+		WriteBits(*source++, bits);
+		bitsLeft -= bits;
+	}
+}
+
+BitReader::BitReader(const void* buffer, size_t sizeInBytes) {
+	data			= (const uint8_t*)buffer;
+	capacityBits	= sizeInBytes * 8;
+	bitPos			= 0;
+	overflowed		= false;
+}
+
+uint32_t BitReader::ReadBits(int bitCount) {
+	if (bitCount <= 0) {
+		return 0;
+	}
+	if (overflowed || bitPos + bitCount > capacityBits) {
+		overflowed = true;
+		return 0;
+	}
+	uint32_t	value		= 0;
+	int			bitsRead	= 0;
+	while (bitsRead < bitCount) {
+		size_t	byteIndex	= bitPos / 8;
+		int		bitOffset	= (int)(bitPos % 8);
+		int		bitsHere	= 8 - bitOffset;
+		if (bitsHere > bitCount - bitsRead) {
+			bitsHere = bitCount - bitsRead;
+		}
+		uint32_t bits = (data[byteIndex] >> bitOffset) & ((1u << bitsHere) - 1);
+		value |= bits << bitsRead;
+
+		bitsRead	+= bitsHere;
+		bitPos		+= bitsHere;
+	}
+	return value;
+}
+
+float BitReader::ReadFloat() {
+	uint32_t bits = ReadBits(32);
+	float value;
+	memcpy(&value, &bits, sizeof(float));
+	return value;
+}
+
+uint32_t BitReader::ReadVarint() {
+	uint32_t value = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		uint32_t byte = ReadBits(8);
+		value |= (byte & 0x7F) << shift;
+		if (!(byte & 0x80) || overflowed) {
+			return value;
+		}
+	}
+	overflowed = true; //too long to be a real varint
+	return 0;
+}
+
+int32_t BitReader::ReadSignedCompact() {
+	if (!ReadBool()) {
+		return 0;
+	}
+	int bitCount	= (int)ReadBits(5) + 1;
+	uint32_t zigzag = ReadBits(bitCount);
+	return (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+}
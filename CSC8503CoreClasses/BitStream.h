@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Writes values into a buffer using only as many bits as they need, rather
+		than whole bytes / ints. Bits are written lowest first, and values can
+		straddle byte boundaries. Writing past the end of the buffer sets the
+		overflow flag and drops the data, rather than writing out of bounds.
+		*/
+		class BitWriter	{
+		public:
+			BitWriter(void* buffer, size_t sizeInBytes);
+
+			void WriteBits(uint32_t value, int bitCount);	//up to 32 bits
+			void WriteBool(bool value) {
+				WriteBits(value ? 1 : 0, 1);
+			}
+			void WriteFloat(float value);
+
+			//7 bits at a time, so small values (object IDs etc) only take a byte
+			void WriteVarint(uint32_t value);
+			//Zig-zag encoded, with a 5 bit length - so 0 is a single bit, and small deltas are small
+			void WriteSignedCompact(int32_t value);
+
+			//Appends everything written to another stream
+			void WriteStream(const BitWriter& other);
+
+			void Reset();
+
+			size_t GetBitCount() const {
+				return bitPos;
+			}
+			size_t GetByteCount() const {
+				return (bitPos + 7) / 8;
+			}
+			size_t GetBitsRemaining() const {
+				return capacityBits - bitPos;
+			}
+			bool IsOverflowed() const {
+				return overflowed;
+			}
+			const uint8_t* GetData() const {
+				return data;
+			}
+
+		protected:
+			uint8_t*	data;
+			size_t		capacityBits;
+			size_t		bitPos;
+			bool		overflowed;
+		};
+
+		/*
+		Reads back what a BitWriter wrote, in the same order. Reading past the end
+		of the data sets the overflow flag and returns zeroes, so a malformed packet
+		can be spotted (and thrown away) after it's been read.
+		*/
+		class BitReader	{
+		public:
+			BitReader(const void* buffer, size_t sizeInBytes);
+
+			uint32_t	ReadBits(int bitCount);
+			bool		ReadBool() {
+				return ReadBits(1) != 0;
+			}
+			float		ReadFloat();
+			uint32_t	ReadVarint();
+			int32_t		ReadSignedCompact();
+
+			size_t GetBitsRemaining() const {
+				return capacityBits - bitPos;
+			}
+			bool IsOverflowed() const {
+				return overflowed;
+			}
+
+		protected:
+			const uint8_t*	data;
+			size_t			capacityBits;
+			size_t			bitPos;
+			bool			overflowed;
+		};
+	}
+}
@@ -0,0 +1,51 @@
+#include "CollisionVolume.h"
+#include "AABBVolume.h"
+#include "OBBVolume.h"
+#include "SphereVolume.h"
+#include "CapsuleVolume.h"
+#include "ObjectPool.h"
+#include <algorithm>
+#include <cstddef>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr size_t maxVolumeSize = std::max({ sizeof(AABBVolume), sizeof(OBBVolume), sizeof(SphereVolume), sizeof(CapsuleVolume) });
+
+	struct VolumeSlot {
+		alignas(std::max_align_t) unsigned char data[maxVolumeSize];
+	};
+
+	ObjectPool<VolumeSlot>& GetVolumePool() {
+		static ObjectPool<VolumeSlot> pool;
+		return pool;
+	}
+}
+
+void* CollisionVolume::operator new(size_t size) {
+	if (size > sizeof(VolumeSlot)) {
+		return ::operator new(size);
+	}
+	return GetVolumePool().Allocate();
+}
+
+/*
+We can't trust a size here, as volumes are deleted via a CollisionVolume pointer,
+and CollisionVolume has no virtual destructor - so check where it came from instead.
+*/
+void CollisionVolume::operator delete(void* p) {
+	if (!p) {
+		return;
+	}
+	if (GetVolumePool().Owns(p)) {
+		GetVolumePool().Free(p);
+	}
+	else {
+		::operator delete(p);
+	}
+}
+
+bool CollisionVolume::ResetPool() {
+	return GetVolumePool().Reset();
+}
@@ -18,6 +18,12 @@ namespace NCL {
 		}
 		~CollisionVolume() {}
 
+		//All of the volume types share one pool, sized for the largest of them
+		static void* operator new(size_t size);
+		static void  operator delete(void* p);
+
+		static bool ResetPool();
+
 		VolumeType type;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "CompiledBehaviourTree.h"
+#include "JobSystem.h"
+
+#include <cassert>
+
+using namespace NCL;
+using namespace CSC8503;
+
+const uint16_t NoParent = 0xFFFF;
+
+CompiledBehaviourTree::CompiledBehaviourTree() {
+}
+
+CompiledBehaviourTree::~CompiledBehaviourTree() {
+}
+
+int CompiledBehaviourTree::AddNode(NodeType type, const std::string& name) {
+	assert(nodes.empty() || !openNodes.empty()); //only one root!
+	assert(nodes.size() < NoParent);
+
+	Node n;
+	n.type			= type;
+	n.parent		= openNodes.empty() ? NoParent : (uint16_t)openNodes.back();
+	n.subtreeEnd	= (uint16_t)(nodes.size() + 1);
+	n.action		= 0;
+
+	nodes.emplace_back(n);
+	names.emplace_back(name);
+	return (int)nodes.size() - 1;
+}
+
+void CompiledBehaviourTree::BeginSequence(const std::string& name) {
+	openNodes.emplace_back(AddNode(SequenceNode, name));
+}
+
+void CompiledBehaviourTree::BeginSelector(const std::string& name) {
+	openNodes.emplace_back(AddNode(SelectorNode, name));
+}
+
+void CompiledBehaviourTree::AddAction(const std::string& name, CompiledBehaviourFunc func) {
+	int node = AddNode(ActionNode, name);
+	nodes[node].action = (uint16_t)actions.size();
+	actions.emplace_back(func);
+}
+
+void CompiledBehaviourTree::End() {
+	assert(!openNodes.empty());
+	nodes[openNodes.back()].subtreeEnd = (uint16_t)nodes.size();
+	openNodes.pop_back();
+}
+
+/*
+No recursion - we go down to the first action under the current node, run it,
+and then walk back up through its parents until one of them wants to try
+another child (a sequence after a success, a selector after a failure), or we
+fall off the top of the tree.
+*/
+BehaviourState CompiledBehaviourTree::Tick(BehaviourAgentState& agent, float dt, void* context) const {
+	if (nodes.empty()) {
+		return Failure;
+	}
+	const Node* tree = nodes.data();
+
+	int				current;
+	BehaviourState	state;
+	if (agent.runningNode >= 0) {
+		current = agent.runningNode;
+		state	= Ongoing;
+	}
+	else {
+		current = 0;
+		state	= Initialise;
+	}
+
+	while (true) {
+		while (tree[current].type != ActionNode) {
+			if (tree[current].subtreeEnd == current + 1) {
+				break; //a composite with no children
+			}
+			current++;
+		}
+		BehaviourState result;
+		if (tree[current].type == ActionNode) {
+			result = actions[tree[current].action](dt, state, agent, context);
+		}
+		else {
+			result = tree[current].type == SequenceNode ? Success : Failure;
+		}
+
+		if (result == Ongoing || result == Initialise) {
+			agent.runningNode = current;
+			return Ongoing;
+		}
+
+		int next = -1;
+		while (tree[current].parent != NoParent) {
+			const Node& parent = tree[tree[current].parent];
+			bool tryNext = parent.type == SequenceNode ? result == Success : result == Failure;
+			if (tryNext && tree[current].subtreeEnd < parent.subtreeEnd) {
+				next = tree[current].subtreeEnd;
+				break;
+			}
+			current = tree[current].parent; //this composite is finished, with the same result
+		}
+		if (next < 0) {
+			agent.runningNode = -1;
+			return result;
+		}
+		current = next;
+		state	= Initialise;
+	}
+}
+
+void CompiledBehaviourTree::TickAll(BehaviourAgentState* agents, size_t count, float dt, void* context, JobSystem* jobs) const {
+	if (jobs) {
+		jobs->ParallelFor(count, 256, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				Tick(agents[i], dt, context);
+			}
+		});
+		return;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		Tick(agents[i], dt, context);
+	}
+}
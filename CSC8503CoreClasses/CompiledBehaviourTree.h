@@ -0,0 +1,93 @@
+#pragma once
+#include "BehaviourNode.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace NCL {
+	namespace CSC8503 {
+		class JobSystem;
+
+		const int BehaviourBlackboardSize = 6;
+
+		/*
+		Everything a single agent needs to run a CompiledBehaviourTree - which node
+		it's part way through, and a few values for its actions to keep between
+		ticks (timers, targets etc). 32 bytes, so a crowd's worth packs tightly.
+		*/
+		struct BehaviourAgentState {
+			int32_t		runningNode	= -1;	//-1 - start from the root next tick
+			uint32_t	agentID		= 0;	//for actions to find the rest of the agent's data
+			float		blackboard[BehaviourBlackboardSize] = {};
+		};
+
+		typedef BehaviourState(*CompiledBehaviourFunc)(float dt, BehaviourState state, BehaviourAgentState& agent, void* context);
+
+		/*
+		A behaviour tree flattened out into a single array of nodes, in depth-first
+		order - a node's children come straight after it, and each node knows where
+		its subtree ends, so moving to the next sibling is a single jump. Actions are
+		plain function pointers rather than virtual nodes, and the tree itself holds
+		no per-agent state, so one copy can be shared by every agent of a type.
+
+		Selectors, sequences and actions behave just as BehaviourSelector etc do, but
+		an agent with an Ongoing action resumes straight from that action next tick,
+		instead of walking back down from the root.
+
+		Build it up with BeginSequence / BeginSelector / AddAction / End, then tick
+		as many agents as you like through it.
+		*/
+		class CompiledBehaviourTree	{
+		public:
+			CompiledBehaviourTree();
+			~CompiledBehaviourTree();
+
+			void BeginSequence(const std::string& name);
+			void BeginSelector(const std::string& name);
+			void AddAction(const std::string& name, CompiledBehaviourFunc func);
+			void End();
+
+			bool IsComplete() const {
+				return !nodes.empty() && openNodes.empty();
+			}
+
+			BehaviourState Tick(BehaviourAgentState& agent, float dt, void* context = nullptr) const;
+
+			//Ticks a whole group of agents - in parallel if given a JobSystem, so only if the actions are safe to run that way!
+			void TickAll(BehaviourAgentState* agents, size_t count, float dt, void* context = nullptr, JobSystem* jobs = nullptr) const;
+
+			void Reset(BehaviourAgentState& agent) const {
+				agent.runningNode = -1;
+			}
+
+			const std::string& GetNodeName(int node) const {
+				return names[node];
+			}
+			size_t GetNodeCount() const {
+				return nodes.size();
+			}
+
+		protected:
+			enum NodeType : uint8_t {
+				SequenceNode,
+				SelectorNode,
+				ActionNode
+			};
+			struct Node {
+				NodeType	type;
+				uint16_t	parent;
+				uint16_t	subtreeEnd;	//one past the last node in this subtree
+				uint16_t	action;
+			};
+
+			int AddNode(NodeType type, const std::string& name);
+
+			std::vector<Node>					nodes;
+			std::vector<CompiledBehaviourFunc>	actions;
+			std::vector<std::string>			names;	//only for debugging, never touched by Tick
+
+			std::vector<int>	openNodes;	//composites still being built
+		};
+	}
+}
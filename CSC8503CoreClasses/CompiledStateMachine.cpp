@@ -0,0 +1,97 @@
+#include "CompiledStateMachine.h"
+#include "JobSystem.h"
+
+#include <cassert>
+
+using namespace NCL;
+using namespace CSC8503;
+
+CompiledStateMachine::CompiledStateMachine() {
+	polledStarts.emplace_back(0);
+	eventStarts.emplace_back(0);
+}
+
+CompiledStateMachine::~CompiledStateMachine() {
+}
+
+int CompiledStateMachine::AddState(const std::string& name, CompiledStateFunc func) {
+	assert(states.size() < 0xFFFF);
+	states.emplace_back(func);
+	names.emplace_back(name);
+	polledStarts.emplace_back(polledStarts.back());
+	eventStarts.emplace_back(eventStarts.back());
+	return (int)states.size() - 1;
+}
+
+//Keeps the list grouped by source state - only happens while building, so it doesn't need to be fast
+void CompiledStateMachine::InsertTransition(std::vector<Transition>& list, std::vector<uint32_t>& starts, int source, const Transition& t) {
+	assert(source >= 0 && source < (int)states.size());
+	list.insert(list.begin() + starts[source + 1], t);
+	for (size_t i = source + 1; i < starts.size(); ++i) {
+		starts[i]++;
+	}
+}
+
+void CompiledStateMachine::AddTransition(int source, int destination, CompiledTransitionFunc condition) {
+	Transition t;
+	t.destination	= (uint16_t)destination;
+	t.condition		= condition;
+	InsertTransition(polledTransitions, polledStarts, source, t);
+}
+
+void CompiledStateMachine::AddEventTransition(int source, int destination, int eventID) {
+	Transition t;
+	t.destination	= (uint16_t)destination;
+	t.eventID		= eventID;
+	InsertTransition(eventTransitions, eventStarts, source, t);
+}
+
+void CompiledStateMachine::ChangeState(StateMachineInstance& instance, uint16_t newState) const {
+	instance.previousState	= instance.currentState;
+	instance.currentState	= newState;
+}
+
+void CompiledStateMachine::Update(StateMachineInstance& instance, float dt, void* context) const {
+	if (states.empty()) {
+		return;
+	}
+	uint16_t state = instance.currentState;
+	if (states[state]) {
+		states[state](dt, instance, context);
+	}
+	if (instance.currentState != state) {
+		return; //the state sent itself an event
+	}
+	//StateMachine lets the last transition that passes win, so searching backwards keeps them agreeing
+	for (uint32_t i = polledStarts[state + 1]; i > polledStarts[state]; --i) {
+		if (polledTransitions[i - 1].condition(instance, context)) {
+			ChangeState(instance, polledTransitions[i - 1].destination);
+			return;
+		}
+	}
+}
+
+bool CompiledStateMachine::SendEvent(StateMachineInstance& instance, int eventID) const {
+	uint16_t state = instance.currentState;
+	for (uint32_t i = eventStarts[state]; i < eventStarts[state + 1]; ++i) {
+		if (eventTransitions[i].eventID == eventID) {
+			ChangeState(instance, eventTransitions[i].destination);
+			return true;
+		}
+	}
+	return false;
+}
+
+void CompiledStateMachine::UpdateAll(StateMachineInstance* instances, size_t count, float dt, void* context, JobSystem* jobs) const {
+	if (jobs) {
+		jobs->ParallelFor(count, 256, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				Update(instances[i], dt, context);
+			}
+		});
+		return;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		Update(instances[i], dt, context);
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace NCL {
+	namespace CSC8503 {
+		class JobSystem;
+
+		/*
+		All an agent needs to run a CompiledStateMachine - which state it's in, and
+		an ID for the state functions to find the rest of the agent with.
+		*/
+		struct StateMachineInstance {
+			uint16_t currentState	= 0;
+			uint16_t previousState	= 0;
+			uint32_t agentID		= 0;
+		};
+
+		typedef void(*CompiledStateFunc)(float dt, StateMachineInstance& instance, void* context);
+		typedef bool(*CompiledTransitionFunc)(const StateMachineInstance& instance, void* context);
+
+		/*
+		A StateMachine flattened into tables - states are small integers, and each
+		state's transitions sit together in one array, so an Update is a function
+		call for the state and a short scan through its own transitions only. The
+		definition holds nothing per-agent, so one copy serves every agent of a
+		type, each with just a StateMachineInstance.
+
+		Transitions come in two kinds:
+		- Polled ones have a condition that's checked every Update, like the
+		  StateTransition class. If more than one passes, the last one added is
+		  taken, just as StateMachine would - they're checked newest first, so the
+		  ones before it aren't even called.
+		- Event ones are never polled at all - they're taken when SendEvent is called
+		  with their event while the agent is in their source state. Use these for
+		  anything that has a clear moment it happens (been hit, heard a noise etc).
+
+		The first state added is the one new instances start in.
+		*/
+		class CompiledStateMachine	{
+		public:
+			CompiledStateMachine();
+			~CompiledStateMachine();
+
+			int  AddState(const std::string& name, CompiledStateFunc func);
+			void AddTransition(int source, int destination, CompiledTransitionFunc condition);
+			void AddEventTransition(int source, int destination, int eventID);
+
+			void Update(StateMachineInstance& instance, float dt, void* context = nullptr) const;
+
+			//Updates a whole group of instances - in parallel if given a JobSystem, so only if the state functions are safe to run that way!
+			void UpdateAll(StateMachineInstance* instances, size_t count, float dt, void* context = nullptr, JobSystem* jobs = nullptr) const;
+
+			//Returns whether the current state had a transition for this event
+			bool SendEvent(StateMachineInstance& instance, int eventID) const;
+
+			const std::string& GetStateName(int state) const {
+				return names[state];
+			}
+			int GetStateCount() const {
+				return (int)states.size();
+			}
+
+		protected:
+			struct Transition {
+				uint16_t destination;
+				union {
+					CompiledTransitionFunc	condition;
+					int						eventID;
+				};
+			};
+
+			void ChangeState(StateMachineInstance& instance, uint16_t newState) const;
+			void InsertTransition(std::vector<Transition>& list, std::vector<uint32_t>& starts, int source, const Transition& t);
+
+			std::vector<CompiledStateFunc>	states;
+			std::vector<std::string>		names;	//only for debugging
+
+			//Each state's transitions are [starts[state], starts[state + 1])
+			std::vector<Transition>	polledTransitions;
+			std::vector<uint32_t>	polledStarts;
+			std::vector<Transition>	eventTransitions;
+			std::vector<uint32_t>	eventStarts;
+		};
+	}
+}
@@ -0,0 +1,292 @@
+#include "ENetTransport.h"
+#include "NetworkBase.h"
+#include "./enet/enet.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <chrono>
+
+using namespace NCL;
+using namespace CSC8503;
+
+/*
+ENet allocates an ENetPacket and a buffer for its data for every packet it
+receives, and frees them both again as soon as we've handled it. Rather than
+going to the heap each time, anything small enough comes out of free lists of
+fixed size blocks instead. ENet doesn't say how big something was when freeing
+it, so each block starts with a header saying which list it belongs on. The
+lists are per thread, so they don't need locking - a block freed on a different
+thread to the one that allocated it just ends up on that thread's list. Nothing
+else can get at a thread's lists, so each thread has to give its blocks back to
+the heap before it finishes: the I/O thread does so as it stops (which it does
+on every Connect, too), and the game thread as each transport is destroyed, and
+when ENet is shut down.
+*/
+namespace {
+	const size_t	BlockSizes[]	= { 64, 256, 1536 };
+	const int		BlockLists		= 3;
+	const size_t	HeaderSize		= alignof(std::max_align_t);
+
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+	thread_local FreeBlock* freeBlocks[BlockLists] = { nullptr, nullptr, nullptr };
+
+	void* ENET_CALLBACK AllocateBlock(size_t size) {
+		int list = 0;
+		while (list < BlockLists && size > BlockSizes[list]) {
+			list++;
+		}
+		char* block;
+		if (list < BlockLists && freeBlocks[list]) {
+			block				= (char*)freeBlocks[list];
+			freeBlocks[list]	= freeBlocks[list]->next;
+		}
+		else {
+			block = (char*)malloc(HeaderSize + (list < BlockLists ? BlockSizes[list] : size));
+			if (!block) {
+				return nullptr;
+			}
+		}
+		*(int*)block = list;
+		return block + HeaderSize;
+	}
+
+	void ENET_CALLBACK ReleaseBlock(void* memory) {
+		if (!memory) {
+			return;
+		}
+		char*	block	= (char*)memory - HeaderSize;
+		int		list	= *(int*)block;
+		if (list == BlockLists) {
+			free(block); //too big to have come from a list
+			return;
+		}
+		FreeBlock* f		= (FreeBlock*)block;
+		f->next				= freeBlocks[list];
+		freeBlocks[list]	= f;
+	}
+
+	//Gives everything on this thread's free lists back to the heap
+	void ReleaseFreeBlocks() {
+		for (int list = 0; list < BlockLists; ++list) {
+			while (freeBlocks[list]) {
+				FreeBlock* f		= freeBlocks[list];
+				freeBlocks[list]	= f->next;
+				free(f);
+			}
+		}
+	}
+}
+const int NetworkQueueSize	= 1024;
+const int IOWaitTime		= 1;	//milliseconds the I/O thread sleeps waiting for packets
+
+ENetTransport::ENetTransport(int port, int maxPeers) : outgoing(NetworkQueueSize), incoming(NetworkQueueSize), handled(NetworkQueueSize) {
+	netPeer			= nullptr;
+	ioRunning		= false;
+	hasPendingEvent	= false;
+
+	if (port < 0) {
+		netHandle = enet_host_create(nullptr, maxPeers, 1, 0, 0);
+	}
+	else {
+		ENetAddress address;
+		address.host = ENET_HOST_ANY;
+		address.port = port;
+
+		netHandle = enet_host_create(&address, maxPeers, 1, 0, 0);
+	}
+	StartIOThread();
+}
+
+ENetTransport::~ENetTransport() {
+	StopIOThread();
+
+	//Nobody is going to handle whatever had arrived in the meantime
+	NetworkEvent e;
+	while (incoming.Pop(e)) {
+		enet_packet_destroy((ENetPacket*)e.handle);
+	}
+	if (hasPendingEvent) {
+		enet_packet_destroy((ENetPacket*)pendingEvent.handle);
+	}
+	if (netHandle) {
+		enet_host_destroy(netHandle);
+	}
+	ReleaseFreeBlocks();
+}
+
+void ENetTransport::Initialise() {
+	ENetCallbacks callbacks = { AllocateBlock, ReleaseBlock, nullptr };
+	enet_initialize_with_callbacks(ENET_VERSION, &callbacks);
+}
+
+void ENetTransport::Destroy() {
+	enet_deinitialize();
+	ReleaseFreeBlocks();
+}
+
+bool ENetTransport::Connect(uint32_t address, int port) {
+	if (!netHandle) {
+		return false;
+	}
+	ENetAddress enetAddress;
+	enetAddress.host = address;
+	enetAddress.port = port;
+
+	//ENet can only be used from one thread at a time
+	StopIOThread();
+	netPeer = enet_host_connect(netHandle, &enetAddress, 2, 0);
+	StartIOThread();
+
+	return netPeer != nullptr;
+}
+
+void ENetTransport::StartIOThread() {
+	if (ioThread.joinable() || !netHandle) {
+		return;
+	}
+	ioRunning	= true;
+	ioThread	= std::thread(&ENetTransport::IOThread, this);
+}
+
+void ENetTransport::StopIOThread() {
+	if (!ioThread.joinable()) {
+		return;
+	}
+	ioRunning = false;
+	ioThread.join();
+	//Anything in incoming stays there for PopEvent - Connect restarts the thread straight away
+}
+
+void ENetTransport::IOThread() {
+	ENetEvent event;
+	while (true) {
+		bool stopping = !ioRunning.load(std::memory_order_acquire);
+
+		SendQueuedPackets();
+
+		ENetPacket* packet;
+		while (handled.Pop(packet)) {
+			enet_packet_destroy(packet);
+		}
+		if (stopping) {
+			enet_host_flush(netHandle);
+			ReleaseFreeBlocks();
+			return;
+		}
+		/*
+		If the game thread isn't keeping up, stop taking events from ENet until
+		it has made room, rather than dropping any - a lost connect or
+		disconnect would leave the game with the wrong idea of who's there.
+		ENet holds on to anything that arrives in the meantime.
+		*/
+		if (hasPendingEvent) {
+			if (!incoming.Push(pendingEvent)) {
+				enet_host_flush(netHandle);
+				std::this_thread::sleep_for(std::chrono::milliseconds(IOWaitTime));
+				continue;
+			}
+			hasPendingEvent = false;
+		}
+		int result = enet_host_service(netHandle, &event, IOWaitTime);
+		while (result > 0) {
+			NetworkEvent e;
+			e.peerID = event.peer ? (int)event.peer->incomingPeerID : -1;
+			if (event.type == ENET_EVENT_TYPE_CONNECT) {
+				e.type = Event_Connected;
+			}
+			else if (event.type == ENET_EVENT_TYPE_DISCONNECT) {
+				e.type = Event_Disconnected;
+			}
+			else if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+				e.type		= Event_Received;
+				e.data		= (char*)event.packet->data;
+				e.size		= event.packet->dataLength;
+				e.handle	= event.packet;
+			}
+			if (!incoming.Push(e)) {
+				pendingEvent	= e;
+				hasPendingEvent	= true;
+				break;
+			}
+			result = enet_host_check_events(netHandle, &event);
+		}
+	}
+}
+
+void ENetTransport::SendQueuedPackets() {
+	OutgoingPacket p;
+	while (outgoing.Pop(p)) {
+		ENetPacket* packet = enet_packet_create(p.data, p.size, ENET_PACKET_FLAG_NO_ALLOCATE);
+		if (!packet) {
+			FreeBuffer(p.data, p.size);
+			continue;
+		}
+		packet->freeCallback	= FreePacketBuffer;
+		packet->userData		= this;
+
+		if (p.peerID < 0) {
+			enet_host_broadcast(netHandle, 0, packet);
+		}
+		else if (p.peerID >= (int)netHandle->peerCount || enet_peer_send(&netHandle->peers[p.peerID], 0, packet) < 0) {
+			enet_packet_destroy(packet); //never queued, so ENet won't free it for us
+		}
+	}
+}
+
+bool ENetTransport::Send(int peerID, const GamePacket& packet) {
+	size_t size = packet.GetTotalSize();
+	char* data;
+	if (size > sizeof(PacketBuffer)) {
+		data = new char[size];
+	}
+	else {
+		std::lock_guard<std::mutex> lock(bufferMutex);
+		data = (char*)sendBuffers.Allocate();
+	}
+	memcpy(data, &packet, size);
+
+	OutgoingPacket p;
+	p.peerID	= peerID;
+	p.size		= (int)size;
+	p.data		= data;
+
+	if (!ioThread.joinable() || !outgoing.Push(p)) {
+		FreeBuffer(data, size);
+		return false;
+	}
+	return true;
+}
+
+bool ENetTransport::PopEvent(NetworkEvent& e) {
+	return incoming.Pop(e);
+}
+
+void ENetTransport::ReleaseEvent(const NetworkEvent& e) {
+	ENetPacket* packet = (ENetPacket*)e.handle;
+	if (!packet) {
+		return;
+	}
+	if (!ioThread.joinable()) {
+		enet_packet_destroy(packet); //nothing else is using ENet
+		return;
+	}
+	//Only the I/O thread may touch ENet, so wait for it to make room
+	while (!handled.Push(packet)) {
+		std::this_thread::yield();
+	}
+}
+
+void ENetTransport::FreeBuffer(char* data, size_t size) {
+	if (size > sizeof(PacketBuffer)) {
+		delete[] data;
+		return;
+	}
+	std::lock_guard<std::mutex> lock(bufferMutex);
+	sendBuffers.Free(data);
+}
+
+void ENetTransport::FreePacketBuffer(ENetPacket* packet) {
+	((ENetTransport*)packet->userData)->FreeBuffer((char*)packet->data, packet->dataLength);
+}
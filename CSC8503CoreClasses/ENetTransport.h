@@ -0,0 +1,93 @@
+#pragma once
+#include "NetworkTransport.h"
+#include "ObjectPool.h"
+#include "SPSCQueue.h"
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+struct _ENetHost;
+struct _ENetPeer;
+struct _ENetPacket;
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Sends packets over UDP, using ENet.
+
+		ENet is serviced on its own I/O thread, so packets are received (and acks
+		sent) as soon as they arrive, rather than whenever the game thread next gets
+		round to it - a slow frame no longer holds up the network. While it's
+		running, the I/O thread is the only thing that touches ENet; the game thread
+		only ever talks to it through lock-free queues:
+
+		outgoing	game -> I/O		packets to send, already copied into a pooled buffer
+		incoming	I/O -> game		connects, disconnects and received packets
+		handled		game -> I/O		received packets the game is done with, to be destroyed
+
+		Nothing is ever dropped when a queue fills up: the I/O thread stops taking
+		events from ENet until incoming has room, and ReleaseEvent waits for room
+		in handled.
+
+		Outgoing packets are given to ENet with ENET_PACKET_FLAG_NO_ALLOCATE, so it
+		uses our buffer rather than allocating and copying into one of its own. The
+		buffer goes back in the pool once ENet is finished with it.
+		*/
+		class ENetTransport : public NetworkTransport	{
+		public:
+			//Servers listen on port for up to maxPeers clients - clients should pass a port of -1
+			ENetTransport(int port, int maxPeers);
+			~ENetTransport();
+
+			static void Initialise();
+			static void Destroy();
+
+			bool IsValid() const {
+				return netHandle != nullptr;
+			}
+
+			bool Connect(uint32_t address, int port) override;
+			bool Send(int peerID, const GamePacket& packet) override;
+			bool PopEvent(NetworkEvent& e) override;
+			void ReleaseEvent(const NetworkEvent& e) override;
+
+		protected:
+			struct OutgoingPacket {
+				int		peerID;	//-1 sends to every connected peer
+				int		size;
+				char*	data;
+			};
+
+			void StartIOThread();
+			void StopIOThread();	//anything still queued is sent first
+
+			void IOThread();
+			void SendQueuedPackets();
+			void FreeBuffer(char* data, size_t size);
+			static void FreePacketBuffer(_ENetPacket* packet);
+
+			static const int MaxPooledPacketSize = 1400;
+			struct PacketBuffer {
+				char data[MaxPooledPacketSize];
+			};
+			typedef ObjectPool<PacketBuffer, 64> PacketBufferPool;
+
+			_ENetHost*	netHandle;
+			_ENetPeer*	netPeer;	//for clients, the server
+
+			std::thread			ioThread;
+			std::atomic<bool>	ioRunning;
+
+			NetworkEvent		pendingEvent;		//taken from ENet, but incoming was full
+			bool				hasPendingEvent;
+
+			SPSCQueue<OutgoingPacket>	outgoing;
+			SPSCQueue<NetworkEvent>		incoming;
+			SPSCQueue<_ENetPacket*>		handled;
+
+			std::mutex			bufferMutex;	//buffers are taken on the game thread, and given back on the I/O thread
+			PacketBufferPool	sendBuffers;
+		};
+	}
+}
@@ -0,0 +1,144 @@
+#include "EntityRegistry.h"
+#include "GameObject.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+EntityRegistry::EntityRegistry()	{
+}
+
+EntityRegistry::~EntityRegistry()	{
+}
+
+ComponentMask EntityRegistry::GetComponentMask(const GameObject& o) {
+	ComponentMask mask = TransformComponent;
+	if (o.GetBoundingVolume()) {
+		mask |= VolumeComponent;
+	}
+	if (o.GetPhysicsObject()) {
+		mask |= PhysicsComponent;
+	}
+	if (o.GetRenderObject()) {
+		mask |= RenderComponent;
+	}
+	if (o.GetNetworkObject()) {
+		mask |= NetworkComponent;
+	}
+	return mask;
+}
+
+void EntityRegistry::Add(GameObject* o) {
+	if (o->registry) {
+		o->registry->Remove(o);
+	}
+	o->registry = this;
+	Insert(o, GetArchetype(GetComponentMask(*o)));
+}
+
+void EntityRegistry::Remove(GameObject* o) {
+	if (o->registry != this) {
+		return;
+	}
+	Erase(o);
+	o->registry = nullptr;
+}
+
+void EntityRegistry::Refresh(GameObject* o) {
+	if (o->registry != this) {
+		return;
+	}
+	//The object might have just swapped one component for another of the same
+	//type, so we always re-insert to pick up the new pointers
+	Erase(o);
+	Insert(o, GetArchetype(GetComponentMask(*o)));
+}
+
+void EntityRegistry::Clear() {
+	for (Archetype& a : archetypes) {
+		for (GameObject* o : a.objects) {
+			o->registry		= nullptr;
+			o->archetypeID	= -1;
+			o->archetypeRow	= -1;
+		}
+	}
+	archetypes.clear();
+	archetypeLookup.clear();
+}
+
+void EntityRegistry::OperateOnArchetypes(ComponentMask required, ArchetypeFunc f) {
+	for (Archetype& a : archetypes) {
+		if (a.Has(required) && a.Size() > 0) {
+			f(a);
+		}
+	}
+}
+
+int EntityRegistry::GetArchetype(ComponentMask mask) {
+	auto i = archetypeLookup.find(mask);
+	if (i != archetypeLookup.end()) {
+		return i->second;
+	}
+	int id = (int)archetypes.size();
+	archetypes.emplace_back();
+	archetypes.back().mask = mask;
+	archetypeLookup.insert(std::make_pair(mask, id));
+	return id;
+}
+
+void EntityRegistry::Insert(GameObject* o, int archetypeID) {
+	Archetype& a = archetypes[archetypeID];
+
+	o->archetypeID	= archetypeID;
+	o->archetypeRow	= (int)a.objects.size();
+
+	a.objects.emplace_back(o);
+	a.transforms.emplace_back(&o->GetTransform());
+	if (a.mask & VolumeComponent) {
+		a.volumes.emplace_back(o->GetBoundingVolume());
+	}
+	if (a.mask & PhysicsComponent) {
+		a.physics.emplace_back(o->GetPhysicsObject());
+	}
+	if (a.mask & RenderComponent) {
+		a.renders.emplace_back(o->GetRenderObject());
+	}
+	if (a.mask & NetworkComponent) {
+		a.networks.emplace_back(o->GetNetworkObject());
+	}
+}
+
+template<class T>
+static void SwapAndPop(std::vector<T>& column, int row) {
+	column[row] = column.back();
+	column.pop_back();
+}
+
+void EntityRegistry::Erase(GameObject* o) {
+	if (o->archetypeID < 0) {
+		return;
+	}
+	Archetype& a	= archetypes[o->archetypeID];
+	int row			= o->archetypeRow;
+
+	//Keep the columns packed by moving the last entity into the hole
+	GameObject* moved = a.objects.back();
+
+	SwapAndPop(a.objects, row);
+	SwapAndPop(a.transforms, row);
+	if (a.mask & VolumeComponent) {
+		SwapAndPop(a.volumes, row);
+	}
+	if (a.mask & PhysicsComponent) {
+		SwapAndPop(a.physics, row);
+	}
+	if (a.mask & RenderComponent) {
+		SwapAndPop(a.renders, row);
+	}
+	if (a.mask & NetworkComponent) {
+		SwapAndPop(a.networks, row);
+	}
+	moved->archetypeRow = row;
+
+	o->archetypeID	= -1;
+	o->archetypeRow	= -1;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+namespace NCL {
+	class CollisionVolume;
+
+	namespace CSC8503 {
+		class GameObject;
+		class Transform;
+		class PhysicsObject;
+		class RenderObject;
+		class NetworkObject;
+
+		enum ComponentFlags : uint32_t {
+			TransformComponent	= 1 << 0,
+			VolumeComponent		= 1 << 1,
+			PhysicsComponent	= 1 << 2,
+			RenderComponent		= 1 << 3,
+			NetworkComponent	= 1 << 4,
+		};
+		typedef uint32_t ComponentMask;
+
+		/*
+		Every GameObject with the same set of components lives in the same archetype.
+		Each archetype keeps its components in packed arrays, so a system that wants
+		(say) everything with a PhysicsObject can walk straight down those arrays,
+		rather than going through every object in the world and null-checking it.
+
+		Only the columns in the archetype's mask are filled in - the rest stay empty.
+		*/
+		struct Archetype {
+			ComponentMask mask = 0;
+
+			std::vector<GameObject*>			objects;
+			std::vector<Transform*>				transforms;
+			std::vector<const CollisionVolume*>	volumes;
+			std::vector<PhysicsObject*>			physics;
+			std::vector<RenderObject*>			renders;
+			std::vector<NetworkObject*>			networks;
+
+			size_t Size() const {
+				return objects.size();
+			}
+
+			bool Has(ComponentMask m) const {
+				return (mask & m) == m;
+			}
+		};
+
+		typedef std::function<void(Archetype&)> ArchetypeFunc;
+
+		class EntityRegistry	{
+		public:
+			EntityRegistry();
+			~EntityRegistry();
+
+			void Add(GameObject* o);
+			void Remove(GameObject* o);
+			void Refresh(GameObject* o);	//call when an object's components have changed
+			void Clear();
+
+			//Calls f on every non-empty archetype that has at least the required components
+			void OperateOnArchetypes(ComponentMask required, ArchetypeFunc f);
+
+			size_t GetArchetypeCount() const {
+				return archetypes.size();
+			}
+
+			static ComponentMask GetComponentMask(const GameObject& o);
+
+		protected:
+			int		GetArchetype(ComponentMask mask);
+			void	Insert(GameObject* o, int archetypeID);
+			void	Erase(GameObject* o);
+
+			std::vector<Archetype>			archetypes;
+			std::map<ComponentMask, int>	archetypeLookup;
+		};
+	}
+}
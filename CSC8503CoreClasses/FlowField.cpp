@@ -0,0 +1,303 @@
+#include "FlowField.h"
+
+#include <cfloat>
+
+using namespace NCL;
+using namespace CSC8503;
+
+const int oppositeDirection[4] = { 1, 0, 3, 2 }; //above <-> below, left <-> right
+
+FlowField::FlowField(NavigationGrid& grid) : grid(grid) {
+	front				= 0;
+	pendingGoal			= -1;
+	building			= false;
+	directionProgress	= 0;
+	repairedCount		= 0;
+
+	listenerID = grid.AddChangeListener([this](const std::vector<int>& nodes) {
+		changedNodes.insert(changedNodes.end(), nodes.begin(), nodes.end());
+	});
+}
+
+FlowField::~FlowField() {
+	grid.RemoveChangeListener(listenerID);
+}
+
+void FlowField::SetGoal(const Vector3& goal) {
+	int goalIndex = grid.GetNodeIndex(goal);
+	if (goalIndex < 0 || goalIndex == pendingGoal) {
+		return;
+	}
+	pendingGoal = goalIndex;
+	if (!building) {
+		StartBuild(goalIndex);
+	}
+}
+
+void FlowField::StartBuild(int goalIndex) {
+	Field& back = fields[1 - front];
+
+	back.cost.assign(grid.GetNodeCount(), FLT_MAX);
+	back.parent.assign(grid.GetNodeCount(), -1);
+	back.direction.assign(grid.GetNodeCount(), -1);
+	back.goalIndex = goalIndex;
+
+	openList = OpenList();
+	back.cost[goalIndex] = 0.0f;
+	openList.push({ 0.0f, goalIndex });
+
+	building			= true;
+	directionProgress	= 0;
+}
+
+void FlowField::Update(int nodeBudget) {
+	if (!changedNodes.empty()) {
+		if (fields[front].goalIndex >= 0) {
+			Repair(fields[front]);
+		}
+		if (building) {
+			StartBuild(pendingGoal);
+		}
+		changedNodes.clear();
+	}
+	if (!building) {
+		return;
+	}
+	Field& back = fields[1 - front];
+
+	int processed = 0;
+	Integrate(back, openList, nodeBudget, processed, nullptr);
+	if (!openList.empty()) {
+		return;
+	}
+
+	//The direction field - each node points at whichever neighbour is cheapest to go via
+	int nodeCount = grid.GetNodeCount();
+	while (directionProgress < nodeCount && (nodeBudget < 0 || processed < nodeBudget)) {
+		UpdateDirection(back, directionProgress++);
+		processed++;
+	}
+	if (directionProgress < nodeCount) {
+		return;
+	}
+
+	front		= 1 - front;
+	building	= false;
+	if (pendingGoal != fields[front].goalIndex) { //the goal moved while we were busy
+		StartBuild(pendingGoal);
+	}
+}
+
+/*
+The integration field - this searches backwards from the goal, so for each
+neighbour we want the cost of stepping from it onto the current node, which
+is stored on the neighbour, not on us. Any node whose cost goes down is added
+to touched, if we're keeping track.
+*/
+void FlowField::Integrate(Field& f, OpenList& open, int nodeBudget, int& processed, std::vector<int>* touched) {
+	while (!open.empty() && (nodeBudget < 0 || processed < nodeBudget)) {
+		OpenEntry top = open.top();
+		open.pop();
+		processed++;
+
+		int current = top.second;
+		if (top.first > f.cost[current]) {
+			continue; //a stale entry, we've already found a cheaper route
+		}
+		for (int i = 0; i < 4; ++i) {
+			int n = GetLink(current, i);
+			if (n < 0) {
+				continue;
+			}
+			float cost = f.cost[current] + grid.GetNode(n).costs[oppositeDirection[i]];
+			if (cost < f.cost[n]) {
+				f.cost[n]	= cost;
+				f.parent[n]	= current;
+				open.push({ cost, n });
+				if (touched) {
+					touched->emplace_back(n);
+				}
+			}
+		}
+	}
+}
+
+/*
+When nodes change type, the links to and from them (and their costs) change,
+so some of the costs in the field might now be too low (a route has been
+blocked), or too high (a new route has opened up). Rather than starting again,
+we can repair just the part of the field they affect:
+
+Raise - any node whose cost came across a link that's changed, or doesn't exist
+any more, loses its cost, and so does every node whose cost came from it, and
+so on. Following parents, rather than directions, means this only ever drops
+the nodes that really did depend on the change.
+
+Lower - each node that lost its cost, or had a link change, is seeded from
+whichever of its neighbours still has one, and then the Dijkstra search runs
+outwards from those seeds, just as it does when building, until nothing else
+gets cheaper. Only nodes whose cost changed, or whose links did, and their
+neighbours, then need their directions working out again.
+*/
+void FlowField::Repair(Field& f) {
+	std::vector<int> suspects;
+	int neighbours[4];
+	for (int node : changedNodes) {
+		suspects.emplace_back(node);
+		int count = GetNeighbours(node, neighbours);
+		suspects.insert(suspects.end(), neighbours, neighbours + count);
+	}
+
+	std::vector<int> raised;
+	std::vector<int> raiseStack;
+	for (int node : suspects) {
+		if (node == f.goalIndex || f.cost[node] == FLT_MAX) {
+			continue;
+		}
+		int parent = f.parent[node];
+		bool supported = false;
+		for (int i = 0; i < 4 && parent >= 0 && !supported; ++i) {
+			if (GetLink(node, i) == parent) {
+				supported = f.cost[parent] != FLT_MAX && f.cost[node] == f.cost[parent] + grid.GetNode(node).costs[i];
+			}
+		}
+		if (supported) {
+			continue;
+		}
+		raiseStack.emplace_back(node);
+		while (!raiseStack.empty()) {
+			int r = raiseStack.back();
+			raiseStack.pop_back();
+			if (f.cost[r] == FLT_MAX) {
+				continue;
+			}
+			f.cost[r]	= FLT_MAX;
+			f.parent[r]	= -1;
+			raised.emplace_back(r);
+
+			int count = GetNeighbours(r, neighbours);
+			for (int j = 0; j < count; ++j) {
+				if (f.parent[neighbours[j]] == r) {
+					raiseStack.emplace_back(neighbours[j]);
+				}
+			}
+		}
+	}
+
+	OpenList open;
+	std::vector<int> touched;
+	auto Seed = [&](int node) {
+		if (node == f.goalIndex) {
+			return;
+		}
+		for (int i = 0; i < 4; ++i) {
+			int n = GetLink(node, i);
+			if (n < 0 || f.cost[n] == FLT_MAX) {
+				continue;
+			}
+			float cost = f.cost[n] + grid.GetNode(node).costs[i];
+			if (cost < f.cost[node]) {
+				f.cost[node]	= cost;
+				f.parent[node]	= n;
+			}
+		}
+		if (f.cost[node] != FLT_MAX) {
+			open.push({ f.cost[node], node });
+			touched.emplace_back(node);
+		}
+	};
+	for (int node : raised) {
+		Seed(node);
+	}
+	for (int node : suspects) {
+		Seed(node);
+	}
+	int processed = 0;
+	Integrate(f, open, -1, processed, &touched);
+
+	touched.insert(touched.end(), raised.begin(), raised.end());
+	touched.insert(touched.end(), suspects.begin(), suspects.end());
+	for (int node : touched) {
+		UpdateDirection(f, node);
+		int count = GetNeighbours(node, neighbours);
+		for (int j = 0; j < count; ++j) {
+			UpdateDirection(f, neighbours[j]);
+		}
+	}
+	repairedCount = (int)raised.size() + processed;
+}
+
+void FlowField::UpdateDirection(Field& f, int node) const {
+	f.direction[node] = -1;
+	if (f.cost[node] == FLT_MAX || node == f.goalIndex) {
+		return;
+	}
+	const GridNode& n = grid.GetNode(node);
+	const GridNode* firstNode = &grid.GetNode(0);
+	float bestCost = FLT_MAX;
+	for (int i = 0; i < 4; ++i) {
+		if (!n.connected[i]) {
+			continue;
+		}
+		float cost = n.costs[i] + f.cost[n.connected[i] - firstNode];
+		if (cost < bestCost) {
+			bestCost = cost;
+			f.direction[node] = (char)i;
+		}
+	}
+}
+
+//The node we can step to in the given direction, as long as it can step back to us too, or -1
+int FlowField::GetLink(int node, int direction) const {
+	const GridNode& n = grid.GetNode(node);
+	const GridNode* neighbour = n.connected[direction];
+	if (!neighbour || neighbour->connected[oppositeDirection[direction]] != &n) {
+		return -1;
+	}
+	return (int)(neighbour - &grid.GetNode(0));
+}
+
+//Every node next to this one, whether they're linked or not - links to walls are removed
+int FlowField::GetNeighbours(int node, int* outNodes) const {
+	int width	= grid.GetGridWidth();
+	int x		= node % width;
+	int y		= node / width;
+	int count	= 0;
+	if (y > 0)							{ outNodes[count++] = node - width; }
+	if (y < grid.GetGridHeight() - 1)	{ outNodes[count++] = node + width; }
+	if (x > 0)							{ outNodes[count++] = node - 1; }
+	if (x < width - 1)					{ outNodes[count++] = node + 1; }
+	return count;
+}
+
+bool FlowField::GetDirection(const Vector3& position, Vector3& outDirection) const {
+	const Field& f = fields[front];
+	int index = grid.GetNodeIndex(position);
+	if (f.goalIndex < 0 || index < 0 || f.direction.empty()) {
+		return false;
+	}
+	if (index == f.goalIndex) {
+		outDirection = grid.GetNode(index).position - position;
+		outDirection.y = 0.0f;
+		if (Vector::LengthSquared(outDirection) > 0.0f) {
+			outDirection = Vector::Normalise(outDirection);
+		}
+		return true;
+	}
+	int dir = f.direction[index];
+	if (dir < 0) {
+		return false;
+	}
+	const GridNode& node = grid.GetNode(index);
+	outDirection = Vector::Normalise(node.connected[dir]->position - node.position);
+	return true;
+}
+
+float FlowField::GetCostToGoal(const Vector3& position) const {
+	const Field& f = fields[front];
+	int index = grid.GetNodeIndex(position);
+	if (f.goalIndex < 0 || index < 0 || f.cost.empty()) {
+		return FLT_MAX;
+	}
+	return f.cost[index];
+}
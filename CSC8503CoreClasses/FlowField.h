@@ -0,0 +1,85 @@
+#pragma once
+#include "NavigationGrid.h"
+
+#include <vector>
+#include <queue>
+#include <functional>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		When lots of agents are all heading for the same place, rather than each
+		searching for its own path, we can work out the cost to the goal from every
+		node at once (a Dijkstra search outwards from the goal - the 'integration
+		field'), and then point each node at its cheapest neighbour (the 'direction
+		field'). Any number of agents can then just look up which way to go.
+
+		The fields are double buffered - when the goal moves to a new node, the new
+		fields are built in the back buffer, a limited number of nodes per Update,
+		while agents keep steering with the old ones. Once it's finished, the buffers
+		are swapped. If the goal moves again while a build is running, that build
+		still finishes, and the newest goal is built next.
+
+		When nodes change type (blockers being added or removed, say), the field
+		hears about it through the grid's change listeners, and the next Update
+		repairs just the part of it those nodes affect, rather than building it all
+		again - see Repair. A build that was already running has to start again,
+		as some of what it had done may be out of date.
+		*/
+		class FlowField	{
+		public:
+			FlowField(NavigationGrid& grid);
+			~FlowField();
+
+			void SetGoal(const Vector3& goal);
+
+			//Repairs any grid changes, then carries on building, processing at most nodeBudget nodes (or all of them if < 0)
+			void Update(int nodeBudget = -1);
+
+			bool GetDirection(const Vector3& position, Vector3& outDirection) const;
+			float GetCostToGoal(const Vector3& position) const; //FLT_MAX if the goal can't be reached
+
+			bool IsReady() const {
+				return fields[front].goalIndex >= 0;
+			}
+			bool IsBuilding() const {
+				return building;
+			}
+			int GetRepairedCount() const { //how many nodes the last repair had to look at
+				return repairedCount;
+			}
+
+		protected:
+			typedef std::pair<float, int> OpenEntry;
+			typedef std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> OpenList;
+
+			struct Field {
+				std::vector<float>	cost;
+				std::vector<int>	parent;		//the node whose cost ours was worked out from
+				std::vector<char>	direction;	//index into GridNode::connected, or -1
+				int					goalIndex = -1;
+			};
+
+			void StartBuild(int goalIndex);
+			void Repair(Field& f);
+			void Integrate(Field& f, OpenList& open, int nodeBudget, int& processed, std::vector<int>* touched);
+			void UpdateDirection(Field& f, int node) const;
+			int  GetLink(int node, int direction) const;
+			int  GetNeighbours(int node, int* outNodes) const;
+
+			NavigationGrid&		grid;
+			int					listenerID;
+			std::vector<int>	changedNodes;	//saved up until the next Update
+			int					repairedCount;
+
+			Field	fields[2];
+			int		front;
+
+			int		pendingGoal;	//where the goal is now, which might not be what's being built
+			bool	building;
+			int		directionProgress;	//once the open list is empty, how far through the direction pass we are
+
+			OpenList openList;
+		};
+	}
+}
@@ -1,53 +1,40 @@
 #include "GameClient.h"
-#include "./enet/enet.h"
+#include "ENetTransport.h"
 using namespace NCL;
 using namespace CSC8503;
 
 GameClient::GameClient()	{
-	netHandle = enet_host_create(nullptr, 1, 1, 0, 0);
+	transport = new ENetTransport(-1, 1);
+}
+
+GameClient::GameClient(NetworkTransport* transport) {
+	this->transport = transport;
 }
 
 GameClient::~GameClient()	{
-	enet_host_destroy(netHandle);
 }
 
 bool GameClient::Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int portNum) {
-    ENetAddress address;
-    address.port = portNum;
-
-    address.host = (d << 24) | (c << 16) | (b << 8) | (a);
+    uint32_t address = (d << 24) | (c << 16) | (b << 8) | (a);
 
-    netPeer = enet_host_connect(netHandle, &address, 2, 0);
-
-    return netPeer != nullptr;
+    return transport->Connect(address, portNum);
 }
 
+//Everything the transport has received since last time gets handled here, on the game thread
 void GameClient::UpdateClient() {
-    if (netHandle == nullptr) {
-        return;
-    }
-
-    // Handle all incoming packets
-    ENetEvent event;
-
-    while (enet_host_service(netHandle, &event, 0) > 0) {
-        if (event.type == ENET_EVENT_TYPE_CONNECT) {
+    NetworkEvent event;
+    while (transport->PopEvent(event)) {
+        if (event.type == Event_Connected) {
             std::cout << "Connected to server!" << std::endl;
         }
-        else if (event.type == ENET_EVENT_TYPE_RECEIVE) {
-            std::cout << "Client: Packet received..." << std::endl;
-
-            GamePacket* packet = (GamePacket*)event.packet->data;
-            ProcessPacket(packet);            
+        else if (event.type == Event_Received) {
+            ProcessPacket(event);
         }
-        enet_packet_destroy(event.packet);
+        transport->ReleaseEvent(event);
     }
 }
 
+//Our only peer is the server, so 'every peer' is just the server
 void GameClient::SendPacket(GamePacket&  payload) {
-    ENetPacket* dataPacket = enet_packet_create(&payload,
-        payload.GetTotalSize(),
-        0);
-
-    enet_peer_send(netPeer, 0, dataPacket);
+    transport->Send(-1, payload);
 }
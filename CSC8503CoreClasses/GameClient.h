@@ -10,6 +10,8 @@ namespace NCL {
 		class GameClient : public NetworkBase {
 		public:
 			GameClient();
+			//Runs over the given transport instead of ENet, and takes ownership of it
+			GameClient(NetworkTransport* transport);
 			~GameClient();
 
 			bool Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int portNum);
@@ -17,8 +19,6 @@ namespace NCL {
 			void SendPacket(GamePacket&  payload);
 
 			void UpdateClient();
-		protected:	
-			_ENetPeer*	netPeer;
 		};
 	}
 }
@@ -14,15 +14,34 @@ GameObject::GameObject(const std::string& objectName)	{
 	physicsObject	= nullptr;
 	renderObject	= nullptr;
 	networkObject	= nullptr;
+	registry		= nullptr;
+	archetypeID		= -1;
+	archetypeRow	= -1;
 }
 
 GameObject::~GameObject()	{
+	if (registry) {
+		registry->Remove(this);
+	}
 	delete boundingVolume;
 	delete physicsObject;
 	delete renderObject;
 	delete networkObject;
 }
 
+void* GameObject::operator new(size_t size) {
+	return GetPool().AllocateSized(size);
+}
+
+void GameObject::operator delete(void* p, size_t size) {
+	GetPool().FreeSized(p, size);
+}
+
+ObjectPool<GameObject>& GameObject::GetPool() {
+	static ObjectPool<GameObject> pool;
+	return pool;
+}
+
 bool GameObject::GetBroadphaseAABB(Vector3&outSize) const {
 	if (!boundingVolume) {
 		return false;
@@ -1,6 +1,8 @@
 #pragma once
 #include "Transform.h"
 #include "CollisionVolume.h"
+#include "ObjectPool.h"
+#include "EntityRegistry.h"
 
 using std::vector;
 
@@ -12,10 +14,16 @@ namespace NCL::CSC8503 {
 	class GameObject	{
 	public:
 		GameObject(const std::string& name = "");
-		~GameObject();
+		virtual ~GameObject();
+
+		static void* operator new(size_t size);
+		static void  operator delete(void* p, size_t size);
+
+		static ObjectPool<GameObject>& GetPool();
 
 		void SetBoundingVolume(CollisionVolume* vol) {
 			boundingVolume = vol;
+			ComponentsChanged();
 		}
 
 		const CollisionVolume* GetBoundingVolume() const {
@@ -44,10 +52,17 @@ namespace NCL::CSC8503 {
 
 		void SetRenderObject(RenderObject* newObject) {
 			renderObject = newObject;
+			ComponentsChanged();
 		}
 
 		void SetPhysicsObject(PhysicsObject* newObject) {
 			physicsObject = newObject;
+			ComponentsChanged();
+		}
+
+		void SetNetworkObject(NetworkObject* newObject) {
+			networkObject = newObject;
+			ComponentsChanged();
 		}
 
 		const std::string& GetName() const {
@@ -75,6 +90,14 @@ namespace NCL::CSC8503 {
 		}
 
 	protected:
+		friend class EntityRegistry;
+
+		void ComponentsChanged() {
+			if (registry) {
+				registry->Refresh(this);
+			}
+		}
+
 		Transform			transform;
 
 		CollisionVolume*	boundingVolume;
@@ -87,6 +110,10 @@ namespace NCL::CSC8503 {
 		std::string	name;
 
 		Vector3 broadphaseAABB;
+
+		EntityRegistry*	registry;
+		int				archetypeID;
+		int				archetypeRow;
 	};
 }
 
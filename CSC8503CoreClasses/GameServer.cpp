@@ -1,6 +1,6 @@
 #include "GameServer.h"
 #include "GameWorld.h"
-#include "./enet/enet.h"
+#include "ENetTransport.h"
 using namespace NCL;
 using namespace CSC8503;
 
@@ -8,32 +8,38 @@ GameServer::GameServer(int onPort, int maxClients)	{
 	port		= onPort;
 	clientMax	= maxClients;
 	clientCount = 0;
-	netHandle	= nullptr;
 	Initialise();
 }
 
+GameServer::GameServer(NetworkTransport* transport, int maxClients) {
+	port			= -1;
+	clientMax		= maxClients;
+	clientCount		= 0;
+	this->transport	= transport;
+}
+
 GameServer::~GameServer()	{
 	Shutdown();
 }
 
 void GameServer::Shutdown() {
 	SendGlobalPacket(BasicNetworkMessages::Shutdown);
-	enet_host_destroy(netHandle);
-	netHandle = nullptr;
+	delete transport; //anything still queued gets sent first
+	transport = nullptr;
 }
 
 bool GameServer::Initialise() {
-	ENetAddress address;
-	address.host = ENET_HOST_ANY;
-	address.port = port;
-
-	netHandle = enet_host_create(&address, clientMax, 1, 0, 0);
+	if (transport) {
+		return true;
+	}
+	ENetTransport* enet = new ENetTransport(port, clientMax);
 
-	if (!netHandle) {
+	if (!enet->IsValid()) {
 		std::cout << __FUNCTION__ << " failed to create network handle!" << std::endl;
+		delete enet;
 		return false;
 	}
-
+	transport = enet;
 	return true;
 }
 
@@ -44,30 +50,40 @@ bool GameServer::SendGlobalPacket(int msgID) {
 }
 
 bool GameServer::SendGlobalPacket(GamePacket& packet) {
-	ENetPacket* dataPacket = enet_packet_create(&packet, packet.GetTotalSize(), 0);
-	enet_host_broadcast(netHandle, 0, dataPacket);
-	return true;
+	return transport && transport->Send(-1, packet);
 }
 
+bool GameServer::SendPacketToPeer(int peerID, GamePacket& packet) {
+	if (!transport || peerID < 0 || peerID >= clientMax) {
+		return false;
+	}
+	return transport->Send(peerID, packet);
+}
+
+//Everything the transport has received since last time gets handled here, on the game thread
 void GameServer::UpdateServer() {
-	if (!netHandle) { return; }
-	ENetEvent event;
-	while (enet_host_service(netHandle, &event, 0) > 0) {
+	if (!transport) {
+		return;
+	}
+	NetworkEvent event;
+	while (transport->PopEvent(event)) {
 		int type = event.type;
-		ENetPeer* p = event.peer;
-		int peer = p->incomingPeerID;
+		int peer = event.peerID;
 
-		if (type == ENetEventType::ENET_EVENT_TYPE_CONNECT) {
+		if (type == Event_Connected) {
 			std::cout << "Server: New client connected" << std::endl;
+			GamePacket packet(Player_Connected);
+			ProcessPacket(&packet, peer);
 		}
-		else if (type == ENetEventType::ENET_EVENT_TYPE_DISCONNECT) {
+		else if (type == Event_Disconnected) {
 			std::cout << "Server: A client has disconnected" << std::endl;
+			GamePacket packet(Player_Disconnected);
+			ProcessPacket(&packet, peer);
 		}
-		else if (type == ENetEventType::ENET_EVENT_TYPE_RECEIVE) {
-			GamePacket* packet = (GamePacket*)event.packet->data;
-			ProcessPacket(packet, peer);
+		else if (type == Event_Received) {
+			ProcessPacket(event, peer);
 		}
-		enet_packet_destroy(event.packet);
+		transport->ReleaseEvent(event);
 	}
 }
 
@@ -7,6 +7,8 @@ namespace NCL {
 		class GameServer : public NetworkBase {
 		public:
 			GameServer(int onPort, int maxClients);
+			//Runs over the given transport instead of ENet, and takes ownership of it
+			GameServer(NetworkTransport* transport, int maxClients);
 			~GameServer();
 
 			bool Initialise();
@@ -16,6 +18,7 @@ namespace NCL {
 
 			bool SendGlobalPacket(int msgID);
 			bool SendGlobalPacket(GamePacket& packet);
+			bool SendPacketToPeer(int peerID, GamePacket& packet);
 
 			virtual void UpdateServer();
 
@@ -1,9 +1,14 @@
 #include "GameWorld.h"
 #include "GameObject.h"
+#include "PhysicsObject.h"
+#include "RenderObject.h"
+#include "NetworkObject.h"
 #include "Constraint.h"
 #include "CollisionDetection.h"
 #include "Camera.h"
 
+#include <cassert>
+
 
 using namespace NCL;
 using namespace NCL::CSC8503;
@@ -19,6 +24,7 @@ GameWorld::~GameWorld()	{
 }
 
 void GameWorld::Clear() {
+	entities.Clear();
 	gameObjects.clear();
 	constraints.clear();
 	worldIDCounter		= 0;
@@ -26,6 +32,7 @@ void GameWorld::Clear() {
 }
 
 void GameWorld::ClearAndErase() {
+	entities.Clear();
 	for (auto& i : gameObjects) {
 		delete i;
 	}
@@ -33,16 +40,29 @@ void GameWorld::ClearAndErase() {
 		delete i;
 	}
 	Clear();
+	//Everything the world owned is gone, so the object pools can be
+	//rewound in one go, ready to hand out contiguous slots to the next level.
+	//A pool only rewinds once nothing allocated from it is still alive, so if
+	//one refuses, something outside the world is still holding on to an object
+	bool poolsReset = GameObject::GetPool().Reset();
+	poolsReset &= PhysicsObject::GetPool().Reset();
+	poolsReset &= RenderObject::GetPool().Reset();
+	poolsReset &= NetworkObject::GetPool().Reset();
+	poolsReset &= CollisionVolume::ResetPool();
+	assert(poolsReset);
+	(void)poolsReset;
 }
 
 void GameWorld::AddGameObject(GameObject* o) {
 	gameObjects.emplace_back(o);
+	entities.Add(o);
 	o->SetWorldID(worldIDCounter++);
 	worldStateCounter++;
 }
 
 void GameWorld::RemoveGameObject(GameObject* o, bool andDelete) {
 	gameObjects.erase(std::remove(gameObjects.begin(), gameObjects.end(), o), gameObjects.end());
+	entities.Remove(o);
 	if (andDelete) {
 		delete o;
 	}
@@ -78,6 +98,14 @@ void GameWorld::UpdateWorld(float dt) {
 	}
 }
 
+void GameWorld::UpdateTransforms() {
+	entities.OperateOnArchetypes(TransformComponent,
+		[](Archetype& a) {
+			Transform::UpdateMatrices(a.transforms.data(), a.Size());
+		}
+	);
+}
+
 bool GameWorld::Raycast(Ray& r, RayCollision& closestCollision, bool closestObject, GameObject* ignoreThis) const {
 	//The simplest raycast just goes through each object and sees if there's a collision
 	RayCollision collision;
@@ -4,6 +4,7 @@
 #include "Ray.h"
 #include "CollisionDetection.h"
 #include "QuadTree.h"
+#include "EntityRegistry.h"
 namespace NCL {
 		class Camera;
 		using Maths::Ray;
@@ -44,8 +45,16 @@ namespace NCL {
 
 			virtual void UpdateWorld(float dt);
 
+			//Rebuilds the matrices of any transforms that have changed since the last call
+			void UpdateTransforms();
+
 			void OperateOnContents(GameObjectFunc f);
 
+			//Only visits the archetypes that have all of the required components
+			void OperateOnArchetypes(ComponentMask required, ArchetypeFunc f) {
+				entities.OperateOnArchetypes(required, f);
+			}
+
 			void GetObjectIterators(
 				GameObjectIterator& first,
 				GameObjectIterator& last) const;
@@ -62,6 +71,8 @@ namespace NCL {
 			std::vector<GameObject*> gameObjects;
 			std::vector<Constraint*> constraints;
 
+			EntityRegistry entities;
+
 			PerspectiveCamera mainCamera;
 
 			bool shuffleConstraints;
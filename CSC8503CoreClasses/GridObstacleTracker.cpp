@@ -0,0 +1,116 @@
+#include "GridObstacleTracker.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "PhysicsObject.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+GridObstacleTracker::GridObstacleTracker(GameWorld& world, NavigationGrid& grid, float minHeight, float maxHeight, PathfindingService* pathfinder)
+	: world(world), grid(grid) {
+	this->minHeight		= minHeight;
+	this->maxHeight		= maxHeight;
+	this->pathfinder	= pathfinder;
+	updateCount		= 0;
+}
+
+GridObstacleTracker::~GridObstacleTracker() {
+	Clear();
+}
+
+void GridObstacleTracker::Clear() {
+	for (auto& t : tracked) {
+		edits.push_back({ t.second.rect, false });
+	}
+	tracked.clear();
+	ApplyEdits();
+}
+
+void GridObstacleTracker::SetBlockers(const GridRect& r, bool add) {
+	for (int y = r.minY; y <= r.maxY; ++y) {
+		for (int x = r.minX; x <= r.maxX; ++x) {
+			if (add) {
+				grid.AddBlocker(x, y);
+			}
+			else {
+				grid.RemoveBlocker(x, y);
+			}
+		}
+	}
+}
+
+/*
+The blockers that change during an Update are saved up and then handed to the
+grid as one batch of edits, so each changed cluster, JPS+ row and so on is only
+redone once. If there's a PathfindingService searching the grid, its workers
+are paused for just long enough to make them.
+*/
+void GridObstacleTracker::ApplyEdits() {
+	if (edits.empty()) {
+		return;
+	}
+	if (pathfinder) {
+		pathfinder->Pause();
+	}
+	grid.BeginEdit();
+	for (const BlockerEdit& e : edits) {
+		SetBlockers(e.rect, e.add);
+	}
+	grid.EndEdit();
+	if (pathfinder) {
+		pathfinder->Resume();
+	}
+	edits.clear();
+}
+
+void GridObstacleTracker::Update() {
+	updateCount++;
+
+	world.OperateOnArchetypes(TransformComponent | VolumeComponent | PhysicsComponent, [&](Archetype& a) {
+		for (size_t i = 0; i < a.Size(); ++i) {
+			GameObject* o = a.objects[i];
+			if (!o->IsActive() || a.physics[i]->GetInverseMass() != 0.0f) {
+				continue;
+			}
+			Vector3 halfSize;
+			if (!o->GetBroadphaseAABB(halfSize)) {
+				continue;
+			}
+			Vector3 position	= a.transforms[i]->GetPosition();
+			Vector3 boxMin		= position - halfSize;
+			Vector3 boxMax		= position + halfSize;
+
+			GridRect rect;
+			bool blocks = boxMax.y >= minHeight && boxMin.y <= maxHeight &&
+				grid.GetNodeRect(boxMin, boxMax, rect);
+
+			auto t = tracked.find(o);
+			if (t != tracked.end()) {
+				const GridRect& old = t->second.rect;
+				if (blocks && old.minX == rect.minX && old.minY == rect.minY &&
+					old.maxX == rect.maxX && old.maxY == rect.maxY) {
+					t->second.lastSeen = updateCount;
+					continue;
+				}
+				edits.push_back({ old, false });
+				tracked.erase(t);
+			}
+			if (blocks) {
+				edits.push_back({ rect, true });
+				tracked[o] = { rect, updateCount };
+			}
+		}
+	});
+
+	//Anything we didn't see this time has been removed from the world (or stopped being static)
+	for (auto t = tracked.begin(); t != tracked.end(); ) {
+		if (t->second.lastSeen != updateCount) {
+			edits.push_back({ t->second.rect, false });
+			t = tracked.erase(t);
+		}
+		else {
+			++t;
+		}
+	}
+	ApplyEdits();
+}
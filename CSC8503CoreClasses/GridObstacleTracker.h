@@ -0,0 +1,63 @@
+#pragma once
+#include "NavigationGrid.h"
+#include "PathfindingService.h"
+
+#include <map>
+
+namespace NCL {
+	namespace CSC8503 {
+		class GameWorld;
+		class GameObject;
+
+		/*
+		Keeps a NavigationGrid's blockers in step with the static physics objects in
+		a GameWorld (those with an inverse mass of 0). Each Update, any object whose
+		broadphase box covers a different set of nodes than it did last time has its
+		old blockers taken away and new ones added, so moving a crate (or removing
+		it) only touches the nodes around it, rather than reloading the whole grid.
+
+		Only objects overlapping the height band above the grid count, so the floor
+		(and anything up in the rafters) doesn't block anything.
+
+		If a PathfindingService is searching the same grid, pass it in too - its
+		workers get paused while the grid is being changed (so it has to outlive
+		the tracker).
+		*/
+		class GridObstacleTracker	{
+		public:
+			GridObstacleTracker(GameWorld& world, NavigationGrid& grid, float minHeight = 0.5f, float maxHeight = 2.0f, PathfindingService* pathfinder = nullptr);
+			~GridObstacleTracker();
+
+			void Update();
+			void Clear();
+
+			size_t GetTrackedCount() const {
+				return tracked.size();
+			}
+
+		protected:
+			void SetBlockers(const GridRect& r, bool add);
+			void ApplyEdits();
+
+			GameWorld&		world;
+			NavigationGrid& grid;
+			float			minHeight;
+			float			maxHeight;
+
+			PathfindingService* pathfinder;
+
+			struct TrackedObject {
+				GridRect	rect;
+				int			lastSeen;
+			};
+			std::map<const GameObject*, TrackedObject> tracked;
+			int updateCount;
+
+			struct BlockerEdit {
+				GridRect	rect;
+				bool		add;
+			};
+			std::vector<BlockerEdit> edits;	//saved up until the end of each Update
+		};
+	}
+}
@@ -0,0 +1,243 @@
+#include "GridReplanner.h"
+
+#include <cfloat>
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+const int oppositeDirection[4] = { 1, 0, 3, 2 }; //above <-> below, left <-> right
+
+GridReplanner::GridReplanner(NavigationGrid& grid) : grid(grid) {
+	startNode		= -1;
+	lastStartNode	= -1;
+	goalNode		= -1;
+	keyModifier		= 0.0f;
+	expandedCount	= 0;
+
+	listenerID = grid.AddChangeListener([this](const std::vector<int>& nodes) {
+		changedNodes.insert(changedNodes.end(), nodes.begin(), nodes.end());
+	});
+}
+
+GridReplanner::~GridReplanner() {
+	grid.RemoveChangeListener(listenerID);
+}
+
+float GridReplanner::Heuristic(int a, int b) const {
+	int width = grid.GetGridWidth();
+	return (float)(abs((a % width) - (b % width)) + abs((a / width) - (b / width)));
+}
+
+GridReplanner::Key GridReplanner::CalculateKey(int node) const {
+	float best = std::min(g[node], rhs[node]);
+	if (best == FLT_MAX) {
+		return { FLT_MAX, FLT_MAX };
+	}
+	return { best + Heuristic(startNode, node) + keyModifier, best };
+}
+
+/*
+Successors are the nodes we can step onto, predecessors are the nodes that can
+step onto us - as a node can be linked to a wall without the wall linking back,
+these aren't always the same thing.
+*/
+int GridReplanner::GetNeighbours(int node, bool predecessors, int* outNodes, float* outCosts) const {
+	const GridNode* firstNode	= &grid.GetNode(0);
+	const GridNode& n			= grid.GetNode(node);
+	int count = 0;
+	for (int i = 0; i < 4; ++i) {
+		const GridNode* other = n.connected[i];
+		if (predecessors) {
+			other = nullptr;
+			int x = node % grid.GetGridWidth();
+			int y = node / grid.GetGridWidth();
+			int nx = x + (i == 2 ? -1 : i == 3 ? 1 : 0);
+			int ny = y + (i == 0 ? -1 : i == 1 ? 1 : 0);
+			if (nx >= 0 && nx < grid.GetGridWidth() && ny >= 0 && ny < grid.GetGridHeight()) {
+				const GridNode& candidate = grid.GetNode((ny * grid.GetGridWidth()) + nx);
+				if (candidate.connected[oppositeDirection[i]] == &n) {
+					other			= &candidate;
+					outCosts[count] = (float)candidate.costs[oppositeDirection[i]];
+				}
+			}
+		}
+		else if (other) {
+			outCosts[count] = (float)n.costs[i];
+		}
+		if (other) {
+			outNodes[count++] = (int)(other - firstNode);
+		}
+	}
+	return count;
+}
+
+void GridReplanner::UpdateNode(int node) {
+	if (node != goalNode) {
+		int		neighbours[4];
+		float	costs[4];
+		int count = GetNeighbours(node, false, neighbours, costs);
+
+		float best = FLT_MAX;
+		for (int i = 0; i < count; ++i) {
+			if (g[neighbours[i]] != FLT_MAX) {
+				best = std::min(best, costs[i] + g[neighbours[i]]);
+			}
+		}
+		rhs[node] = best;
+	}
+	if (inOpen[node]) {
+		openList.erase({ openKeys[node], node });
+		inOpen[node] = false;
+	}
+	if (g[node] != rhs[node]) {
+		openKeys[node]	= CalculateKey(node);
+		inOpen[node]	= true;
+		openList.insert({ openKeys[node], node });
+	}
+}
+
+void GridReplanner::ComputeShortestPath() {
+	expandedCount = 0;
+
+	int		neighbours[4];
+	float	costs[4];
+
+	while (!openList.empty() &&
+		(openList.begin()->first < CalculateKey(startNode) || rhs[startNode] != g[startNode])) {
+		Key oldKey	= openList.begin()->first;
+		int node	= openList.begin()->second;
+		Key newKey	= CalculateKey(node);
+		expandedCount++;
+
+		if (oldKey < newKey) { //the agent has moved since this was queued up
+			openList.erase(openList.begin());
+			openKeys[node] = newKey;
+			openList.insert({ newKey, node });
+			continue;
+		}
+		openList.erase(openList.begin());
+		inOpen[node] = false;
+
+		if (g[node] > rhs[node]) {
+			g[node] = rhs[node];
+		}
+		else {
+			g[node] = FLT_MAX;
+			UpdateNode(node);
+		}
+		int count = GetNeighbours(node, true, neighbours, costs);
+		for (int i = 0; i < count; ++i) {
+			UpdateNode(neighbours[i]);
+		}
+	}
+}
+
+bool GridReplanner::SetGoal(const Vector3& from, const Vector3& to) {
+	startNode	= grid.GetNodeIndex(from);
+	goalNode	= grid.GetNodeIndex(to);
+	if (startNode < 0 || goalNode < 0) {
+		goalNode = -1;
+		return false;
+	}
+	lastStartNode	= startNode;
+	keyModifier		= 0.0f;
+
+	size_t nodeCount = grid.GetNodeCount();
+	g.assign(nodeCount, FLT_MAX);
+	rhs.assign(nodeCount, FLT_MAX);
+	openKeys.assign(nodeCount, { 0.0f, 0.0f });
+	inOpen.assign(nodeCount, false);
+	openList.clear();
+	changedNodes.clear();
+
+	rhs[goalNode]		= 0.0f;
+	openKeys[goalNode]	= { Heuristic(startNode, goalNode), 0.0f };
+	inOpen[goalNode]	= true;
+	openList.insert({ openKeys[goalNode], goalNode });
+
+	ComputeShortestPath();
+	return g[startNode] != FLT_MAX;
+}
+
+void GridReplanner::UpdateStart(const Vector3& position) {
+	int node = grid.GetNodeIndex(position);
+	if (node >= 0) {
+		startNode = node;
+	}
+}
+
+bool GridReplanner::Replan() {
+	if (goalNode < 0) {
+		return false;
+	}
+	if (changedNodes.empty() && startNode == lastStartNode) {
+		return g[startNode] != FLT_MAX;
+	}
+	keyModifier		+= Heuristic(lastStartNode, startNode);
+	lastStartNode	= startNode;
+
+	/*
+	A changed node alters its own links, and the links from its neighbours onto
+	it, so all of them need their rhs values checking
+	*/
+	int		neighbours[4];
+	float	costs[4];
+	for (int node : changedNodes) {
+		UpdateNode(node);
+		int count = GetNeighbours(node, true, neighbours, costs);
+		for (int i = 0; i < count; ++i) {
+			UpdateNode(neighbours[i]);
+		}
+		int x = node % grid.GetGridWidth();
+		int y = node / grid.GetGridWidth();
+		if (x > 0)							{ UpdateNode(node - 1); }
+		if (x < grid.GetGridWidth() - 1)	{ UpdateNode(node + 1); }
+		if (y > 0)							{ UpdateNode(node - grid.GetGridWidth()); }
+		if (y < grid.GetGridHeight() - 1)	{ UpdateNode(node + grid.GetGridWidth()); }
+	}
+	changedNodes.clear();
+
+	ComputeShortestPath();
+	return g[startNode] != FLT_MAX;
+}
+
+bool GridReplanner::GetPath(NavigationPath& outPath) const {
+	if (goalNode < 0 || g[startNode] == FLT_MAX) {
+		return false;
+	}
+	std::vector<int> nodes;
+	nodes.emplace_back(startNode);
+
+	int		neighbours[4];
+	float	costs[4];
+	int current = startNode;
+	//just follow the cheapest successor each step - the limit guards against zero cost loops
+	while (current != goalNode && (int)nodes.size() <= grid.GetNodeCount()) {
+		int count	= GetNeighbours(current, false, neighbours, costs);
+		int best	= -1;
+		float bestCost = FLT_MAX;
+		for (int i = 0; i < count; ++i) {
+			if (g[neighbours[i]] == FLT_MAX) {
+				continue;
+			}
+			float cost = costs[i] + g[neighbours[i]];
+			if (cost < bestCost) {
+				bestCost	= cost;
+				best		= neighbours[i];
+			}
+		}
+		if (best < 0) {
+			return false;
+		}
+		current = best;
+		nodes.emplace_back(current);
+	}
+	if (current != goalNode) {
+		return false;
+	}
+	for (auto i = nodes.rbegin(); i != nodes.rend(); ++i) {
+		outPath.PushWaypoint(grid.GetNode(*i).position);
+	}
+	return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "NavigationGrid.h"
+
+#include <set>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		D* Lite - an incremental planner for a single agent, over a NavigationGrid
+		that can change underneath it. The search runs backwards from the goal, so
+		that as the agent moves the costs it has already worked out stay valid, and
+		when nodes change type only the part of the search they affect is repaired,
+		rather than the whole path being planned again from scratch.
+
+		It hears about changes through the grid's change listeners - they're saved
+		up, and dealt with on the next call to Replan.
+
+		The heuristic counts steps, so node costs are assumed to be at least 1 (as
+		they are for floor nodes).
+		*/
+		class GridReplanner	{
+		public:
+			GridReplanner(NavigationGrid& grid);
+			~GridReplanner();
+
+			bool SetGoal(const Vector3& from, const Vector3& to);
+
+			//Call as the agent moves along the path
+			void UpdateStart(const Vector3& position);
+
+			//Repairs the search after any grid changes, returns whether there's still a path
+			bool Replan();
+
+			bool GetPath(NavigationPath& outPath) const;
+
+			bool HasPendingChanges() const {
+				return !changedNodes.empty();
+			}
+			int GetExpandedCount() const { //how many nodes the last plan / replan had to look at
+				return expandedCount;
+			}
+
+		protected:
+			typedef std::pair<float, float> Key;
+
+			Key		CalculateKey(int node) const;
+			float	Heuristic(int a, int b) const;
+			void	UpdateNode(int node);
+			void	ComputeShortestPath();
+			int		GetNeighbours(int node, bool predecessors, int* outNodes, float* outCosts) const;
+
+			NavigationGrid& grid;
+			int listenerID;
+
+			int startNode;
+			int lastStartNode;
+			int goalNode;
+			float keyModifier;	//km - how far the heuristic has drifted as the agent moves
+
+			std::vector<float>		g;
+			std::vector<float>		rhs;
+			std::vector<Key>		openKeys;
+			std::vector<bool>		inOpen;
+			std::set<std::pair<Key, int>> openList;
+
+			std::vector<int>	changedNodes;
+			int					expandedCount;
+		};
+	}
+}
@@ -0,0 +1,567 @@
+#include "HierarchicalNavigationGrid.h"
+
+#include <queue>
+#include <cfloat>
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+const int ABOVE_NODE	= 0;	//matches the order of GridNode::connected
+const int BELOW_NODE	= 1;
+const int LEFT_NODE		= 2;
+const int RIGHT_NODE	= 3;
+
+const int MAX_SINGLE_ENTRANCE = 6; //any longer and an opening gets an entrance at each end
+
+HierarchicalNavigationGrid::HierarchicalNavigationGrid(NavigationGrid& grid, int clusterSize) : grid(grid) {
+	CreateClusters(clusterSize);
+	BuildAll();
+
+	listenerID = grid.AddChangeListener([this](const std::vector<int>& changedNodes) {
+		OnNodesChanged(changedNodes);
+	});
+}
+
+/*
+Loads the entrances and their links from compiled navigation data, which saves
+all of the searches needed to link up each cluster. If the data is missing, was
+made for a different sized grid, or doesn't make sense, we just build it all
+again, with clusters of clusterSize.
+*/
+HierarchicalNavigationGrid::HierarchicalNavigationGrid(NavigationGrid& grid, const NavigationDataFile& file, int clusterSize) : grid(grid) {
+	if (!LoadNavData(file)) {
+		CreateClusters(clusterSize);
+		BuildAll();
+	}
+	listenerID = grid.AddChangeListener([this](const std::vector<int>& changedNodes) {
+		OnNodesChanged(changedNodes);
+	});
+}
+
+void HierarchicalNavigationGrid::CreateClusters(int clusterSize) {
+	this->clusterSize = std::max(2, clusterSize);
+
+	int width	= grid.GetGridWidth();
+	int height	= grid.GetGridHeight();
+
+	clustersWide = (width  + this->clusterSize - 1) / this->clusterSize;
+	clustersHigh = (height + this->clusterSize - 1) / this->clusterSize;
+
+	int clusterCount = clustersWide * clustersHigh;
+
+	clusters.clear();
+	borders.clear();
+	nodes.clear();
+	freeNodes.clear();
+
+	clusters.resize(clusterCount);
+	borders.resize(clusterCount * 2);
+
+	for (int cy = 0; cy < clustersHigh; ++cy) {
+		for (int cx = 0; cx < clustersWide; ++cx) {
+			int id = (cy * clustersWide) + cx;
+			Cluster& c = clusters[id];
+
+			c.rect.minX = cx * this->clusterSize;
+			c.rect.minY = cy * this->clusterSize;
+			c.rect.maxX = std::min(c.rect.minX + this->clusterSize, width)  - 1;
+			c.rect.maxY = std::min(c.rect.minY + this->clusterSize, height) - 1;
+
+			c.borders[ABOVE_NODE]	= cy > 0				? clusterCount + id - clustersWide	: -1;
+			c.borders[BELOW_NODE]	= cy < clustersHigh - 1	? clusterCount + id					: -1;
+			c.borders[LEFT_NODE]	= cx > 0				? id - 1							: -1;
+			c.borders[RIGHT_NODE]	= cx < clustersWide - 1	? id								: -1;
+
+			borders[id].clusterA = -1;
+			borders[clusterCount + id].clusterA = -1;
+
+			if (cx < clustersWide - 1) {
+				borders[id].clusterA = id;
+				borders[id].clusterB = id + 1;
+			}
+			if (cy < clustersHigh - 1) {
+				borders[clusterCount + id].clusterA = id;
+				borders[clusterCount + id].clusterB = id + clustersWide;
+			}
+		}
+	}
+}
+
+void HierarchicalNavigationGrid::BuildAll() {
+	for (int i = 0; i < (int)borders.size(); ++i) {
+		if (borders[i].clusterA >= 0) {
+			BuildBorder(i);
+		}
+	}
+	for (int i = 0; i < (int)clusters.size(); ++i) {
+		BuildIntraEdges(i, buildScratch);
+	}
+}
+
+bool HierarchicalNavigationGrid::LoadNavData(const NavigationDataFile& file) {
+	size_t chunkSize = 0;
+	const char* chunk = file.GetChunk(NavDataHierarchy, chunkSize);
+	if (!chunk || chunkSize < sizeof(NavDataHierarchyHeader)) {
+		return false;
+	}
+	const NavDataHierarchyHeader* header = (const NavDataHierarchyHeader*)chunk;
+	if (header->clusterSize < 2 || header->borderNodeCount < 0 || header->nodeCount < 0 || header->edgeCount < 0) {
+		return false;
+	}
+	CreateClusters(header->clusterSize);
+	if (clustersWide != header->clustersWide || clustersHigh != header->clustersHigh ||
+		header->borderCount != (int)borders.size()) {
+		return false;
+	}
+	//Each part is taken off what's left of the chunk in turn, so no total can overflow
+	size_t remaining = chunkSize - sizeof(NavDataHierarchyHeader);
+	auto Take = [&](size_t count, size_t size) {
+		if (remaining / size < count) {
+			return false;
+		}
+		remaining -= count * size;
+		return true;
+	};
+	if (!Take(header->borderCount, sizeof(NavDataBorder)) ||
+		!Take(header->borderNodeCount, sizeof(int32_t)) ||
+		!Take(header->nodeCount, sizeof(NavDataAbstractNode)) ||
+		!Take(header->edgeCount, sizeof(NavDataAbstractEdge))) {
+		return false;
+	}
+	const NavDataBorder*		fileBorders	= (const NavDataBorder*)(chunk + sizeof(NavDataHierarchyHeader));
+	const int32_t*				borderNodes	= (const int32_t*)(fileBorders + header->borderCount);
+	const NavDataAbstractNode*	fileNodes	= (const NavDataAbstractNode*)(borderNodes + header->borderNodeCount);
+	const NavDataAbstractEdge*	fileEdges	= (const NavDataAbstractEdge*)(fileNodes + header->nodeCount);
+
+	for (int i = 0; i < header->borderCount; ++i) {
+		const NavDataBorder& b = fileBorders[i];
+		if (b.firstNode < 0 || b.nodeCount < 0 || (int64_t)b.firstNode + b.nodeCount > header->borderNodeCount) {
+			return false;
+		}
+		for (int j = b.firstNode; j < b.firstNode + b.nodeCount; ++j) {
+			if (borderNodes[j] < 0 || borderNodes[j] >= header->nodeCount) {
+				return false;
+			}
+		}
+		borders[i].nodes.assign(borderNodes + b.firstNode, borderNodes + b.firstNode + b.nodeCount);
+	}
+	nodes.resize(header->nodeCount);
+	for (int i = 0; i < header->nodeCount; ++i) {
+		const NavDataAbstractNode& n = fileNodes[i];
+		if (n.firstEdge < 0 || n.edgeCount < 0 || (int64_t)n.firstEdge + n.edgeCount > header->edgeCount ||
+			n.gridIndex < 0 || n.gridIndex >= grid.GetNodeCount() ||
+			n.cluster < 0 || n.cluster >= (int)clusters.size()) {
+			return false;
+		}
+		nodes[i].gridIndex	= n.gridIndex;
+		nodes[i].cluster	= n.cluster;
+		nodes[i].alive		= true;
+		nodes[i].edges.resize(n.edgeCount);
+		for (int j = 0; j < n.edgeCount; ++j) {
+			const NavDataAbstractEdge& e = fileEdges[n.firstEdge + j];
+			if (e.to < 0 || e.to >= header->nodeCount) {
+				return false;
+			}
+			nodes[i].edges[j] = { e.to, e.cost, e.inter != 0 };
+		}
+	}
+	return true;
+}
+
+void HierarchicalNavigationGrid::WriteNavData(NavigationDataWriter& writer) const {
+	//Dead nodes are left out, so the rest need renumbering
+	std::vector<int32_t> newIDs(nodes.size(), -1);
+	int32_t liveCount	= 0;
+	int32_t edgeCount	= 0;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (nodes[i].alive) {
+			newIDs[i] = liveCount++;
+			edgeCount += (int32_t)nodes[i].edges.size();
+		}
+	}
+	std::vector<NavDataBorder>	fileBorders(borders.size());
+	std::vector<int32_t>		borderNodes;
+	for (size_t i = 0; i < borders.size(); ++i) {
+		fileBorders[i].clusterA		= borders[i].clusterA;
+		fileBorders[i].clusterB		= borders[i].clusterA >= 0 ? borders[i].clusterB : -1;
+		fileBorders[i].firstNode	= (int32_t)borderNodes.size();
+		fileBorders[i].nodeCount	= (int32_t)borders[i].nodes.size();
+		for (int n : borders[i].nodes) {
+			borderNodes.emplace_back(newIDs[n]);
+		}
+	}
+	std::vector<NavDataAbstractNode> fileNodes;
+	std::vector<NavDataAbstractEdge> fileEdges;
+	for (const AbstractNode& n : nodes) {
+		if (!n.alive) {
+			continue;
+		}
+		fileNodes.push_back({ n.gridIndex, n.cluster, (int32_t)fileEdges.size(), (int32_t)n.edges.size() });
+		for (const AbstractEdge& e : n.edges) {
+			fileEdges.push_back({ newIDs[e.to], e.cost, e.inter ? 1 : 0, 0 });
+		}
+	}
+
+	NavDataHierarchyHeader header;
+	header.clusterSize		= clusterSize;
+	header.clustersWide		= clustersWide;
+	header.clustersHigh		= clustersHigh;
+	header.borderCount		= (int32_t)fileBorders.size();
+	header.borderNodeCount	= (int32_t)borderNodes.size();
+	header.nodeCount		= liveCount;
+	header.edgeCount		= edgeCount;
+	header.reserved			= 0;
+
+	std::vector<char>& chunk = writer.AddChunk(NavDataHierarchy);
+	NavigationDataWriter::Write(chunk, header);
+	NavigationDataWriter::Write(chunk, fileBorders.data(), fileBorders.size());
+	NavigationDataWriter::Write(chunk, borderNodes.data(), borderNodes.size());
+	NavigationDataWriter::Write(chunk, fileNodes.data(), fileNodes.size());
+	NavigationDataWriter::Write(chunk, fileEdges.data(), fileEdges.size());
+}
+
+HierarchicalNavigationGrid::~HierarchicalNavigationGrid() {
+	grid.RemoveChangeListener(listenerID);
+}
+
+/*
+Walks along the edge between the two clusters, looking for runs of nodes that
+can be walked across. Each run gets an entrance in its middle, or one at each
+end if it's a wide opening.
+*/
+void HierarchicalNavigationGrid::BuildBorder(int borderID) {
+	Border& b = borders[borderID];
+
+	const GridRect& rect = clusters[b.clusterA].rect;
+	bool vertical	= borderID < (int)clusters.size(); //right borders run up and down
+	int width		= grid.GetGridWidth();
+
+	int length	= vertical ? (rect.maxY - rect.minY + 1) : (rect.maxX - rect.minX + 1);
+	int runStart = -1;
+
+	for (int i = 0; i <= length; ++i) {
+		bool open = false;
+		if (i < length) {
+			int a = vertical	? ((rect.minY + i) * width) + rect.maxX
+								: (rect.maxY * width) + rect.minX + i;
+			int n = vertical ? a + 1 : a + width;
+
+			open =	grid.GetNode(a).connected[vertical ? RIGHT_NODE : BELOW_NODE] &&
+					grid.GetNode(n).connected[vertical ? LEFT_NODE : ABOVE_NODE];
+		}
+		if (open && runStart < 0) {
+			runStart = i;
+		}
+		else if (!open && runStart >= 0) {
+			int runEnd		= i - 1;
+			int step		= vertical ? width : 1;
+			int across		= vertical ? 1 : width;
+			int first		= vertical	? ((rect.minY + runStart) * width) + rect.maxX
+										: (rect.maxY * width) + rect.minX + runStart;
+
+			if (runEnd - runStart + 1 < MAX_SINGLE_ENTRANCE) {
+				int mid = first + (((runEnd - runStart) / 2) * step);
+				AddEntrance(b, mid, mid + across, vertical);
+			}
+			else {
+				int last = first + ((runEnd - runStart) * step);
+				AddEntrance(b, first, first + across, vertical);
+				AddEntrance(b, last, last + across, vertical);
+			}
+			runStart = -1;
+		}
+	}
+}
+
+void HierarchicalNavigationGrid::ClearBorder(int borderID) {
+	for (int n : borders[borderID].nodes) {
+		nodes[n].alive = false;
+		nodes[n].edges.clear();
+		freeNodes.emplace_back(n);
+	}
+	borders[borderID].nodes.clear();
+}
+
+void HierarchicalNavigationGrid::AddEntrance(Border& b, int gridA, int gridB, bool vertical) {
+	int a = AddNode(gridA, b.clusterA);
+	int n = AddNode(gridB, b.clusterB);
+
+	float costAB = (float)grid.GetNode(gridA).costs[vertical ? RIGHT_NODE : BELOW_NODE];
+	float costBA = (float)grid.GetNode(gridB).costs[vertical ? LEFT_NODE : ABOVE_NODE];
+
+	nodes[a].edges.push_back({ n, costAB, true });
+	nodes[n].edges.push_back({ a, costBA, true });
+
+	b.nodes.emplace_back(a);
+	b.nodes.emplace_back(n);
+}
+
+int HierarchicalNavigationGrid::AddNode(int gridIndex, int cluster) {
+	int id;
+	if (!freeNodes.empty()) {
+		id = freeNodes.back();
+		freeNodes.pop_back();
+	}
+	else {
+		id = (int)nodes.size();
+		nodes.emplace_back();
+	}
+	AbstractNode& n = nodes[id];
+	n.gridIndex	= gridIndex;
+	n.cluster	= cluster;
+	n.alive		= true;
+	n.edges.clear();
+	return id;
+}
+
+void HierarchicalNavigationGrid::GatherClusterNodes(int clusterID, std::vector<int>& out) const {
+	out.clear();
+	for (int i = 0; i < 4; ++i) {
+		int b = clusters[clusterID].borders[i];
+		if (b < 0) {
+			continue;
+		}
+		for (int n : borders[b].nodes) {
+			if (nodes[n].cluster == clusterID) {
+				out.emplace_back(n);
+			}
+		}
+	}
+}
+
+void HierarchicalNavigationGrid::BuildIntraEdges(int clusterID, GridSearchScratch& s) {
+	std::vector<int> clusterNodes;
+	GatherClusterNodes(clusterID, clusterNodes);
+
+	for (int n : clusterNodes) {
+		std::vector<AbstractEdge>& edges = nodes[n].edges;
+		edges.erase(std::remove_if(edges.begin(), edges.end(), [](const AbstractEdge& e) { return !e.inter; }), edges.end());
+	}
+	for (int from : clusterNodes) {
+		for (int to : clusterNodes) {
+			if (from == to) {
+				continue;
+			}
+			int fromIndex	= nodes[from].gridIndex;
+			int toIndex		= nodes[to].gridIndex;
+
+			if (fromIndex == toIndex) { //a corner node shared by two borders
+				nodes[from].edges.push_back({ to, 0.0f, false });
+			}
+			else if (ClusterPath(clusterID, fromIndex, toIndex, s, nullptr)) {
+				nodes[from].edges.push_back({ to, s.g[toIndex], false });
+			}
+		}
+	}
+}
+
+/*
+Searches between two grid nodes without leaving the given cluster. If outCells
+is set, the route is appended to it, not including the start node.
+*/
+bool HierarchicalNavigationGrid::ClusterPath(int clusterID, int startIndex, int endIndex, GridSearchScratch& s, std::vector<int>* outCells) const {
+	if (!grid.SearchNodes(startIndex, endIndex, clusters[clusterID].rect, s)) {
+		return false;
+	}
+	if (outCells) {
+		size_t first = outCells->size();
+		for (int n = endIndex; n != startIndex; n = s.parent[n]) {
+			outCells->emplace_back(n);
+		}
+		std::reverse(outCells->begin() + first, outCells->end());
+	}
+	return true;
+}
+
+float HierarchicalNavigationGrid::AbstractHeuristic(int gridIndex, int goalIndex) const {
+	int width = grid.GetGridWidth();
+	return (float)(abs((gridIndex % width) - (goalIndex % width)) + abs((gridIndex / width) - (goalIndex / width)));
+}
+
+int HierarchicalNavigationGrid::GetClusterForIndex(int gridIndex) const {
+	int x = gridIndex % grid.GetGridWidth();
+	int y = gridIndex / grid.GetGridWidth();
+	return ((y / clusterSize) * clustersWide) + (x / clusterSize);
+}
+
+bool HierarchicalNavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
+	return FindPath(from, to, outPath, scratch);
+}
+
+bool HierarchicalNavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, HierarchicalSearchScratch& s) const {
+	int startIndex	= grid.GetNodeIndex(from);
+	int endIndex	= grid.GetNodeIndex(to);
+
+	if (startIndex < 0 || endIndex < 0) {
+		return false; //outside of map region!
+	}
+	int startCluster	= GetClusterForIndex(startIndex);
+	int endCluster		= GetClusterForIndex(endIndex);
+
+	s.gridPath.clear();
+	s.gridPath.emplace_back(startIndex);
+
+	bool found = false;
+	if (startCluster == endCluster) { //might not need the abstract graph at all...
+		found = ClusterPath(startCluster, startIndex, endIndex, s.grid, &s.gridPath);
+	}
+
+	if (!found) {
+		/*
+		The start and end are treated as two extra abstract nodes, linked to the
+		entrances of their clusters - these links are only worked out per query, so
+		the abstract graph itself is never modified by a search.
+		*/
+		const int startNode	= (int)nodes.size();
+		const int endNode	= startNode + 1;
+
+		s.g.assign(nodes.size() + 2, FLT_MAX);
+		s.parent.assign(nodes.size() + 2, -1);
+		s.closed.assign(nodes.size() + 2, false);
+		s.endCosts.assign(nodes.size(), -1.0f);
+
+		std::vector<int> clusterNodes;
+		GatherClusterNodes(endCluster, clusterNodes);
+		for (int n : clusterNodes) {
+			if (ClusterPath(endCluster, nodes[n].gridIndex, endIndex, s.grid, nullptr)) {
+				s.endCosts[n] = s.grid.g[endIndex];
+			}
+		}
+
+		std::vector<AbstractEdge> startEdges;
+		GatherClusterNodes(startCluster, clusterNodes);
+		for (int n : clusterNodes) {
+			if (ClusterPath(startCluster, startIndex, nodes[n].gridIndex, s.grid, nullptr)) {
+				startEdges.push_back({ n, s.grid.g[nodes[n].gridIndex], false });
+			}
+		}
+
+		typedef std::pair<float, int> OpenEntry;
+		std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openList;
+
+		s.g[startNode] = 0.0f;
+		openList.push({ 0.0f, startNode });
+
+		while (!openList.empty()) {
+			int current = openList.top().second;
+			openList.pop();
+
+			if (s.closed[current]) {
+				continue; //a stale entry, we've already found a better route to it
+			}
+			s.closed[current] = true;
+
+			if (current == endNode) {
+				break;
+			}
+			auto Relax = [&](int n, float cost) {
+				float g = s.g[current] + cost;
+				if (s.closed[n] || g >= s.g[n]) {
+					return;
+				}
+				s.g[n]		= g;
+				s.parent[n]	= current;
+				openList.push({ g + (n == endNode ? 0.0f : AbstractHeuristic(nodes[n].gridIndex, endIndex)), n });
+			};
+
+			if (current == startNode) {
+				for (const AbstractEdge& e : startEdges) {
+					Relax(e.to, e.cost);
+				}
+				continue;
+			}
+			for (const AbstractEdge& e : nodes[current].edges) {
+				Relax(e.to, e.cost);
+			}
+			if (s.endCosts[current] >= 0.0f) {
+				Relax(endNode, s.endCosts[current]);
+			}
+		}
+
+		if (!s.closed[endNode]) {
+			return false;
+		}
+
+		s.abstractPath.clear();
+		for (int n = s.parent[endNode]; n != startNode; n = s.parent[n]) {
+			s.abstractPath.emplace_back(nodes[n].gridIndex);
+		}
+		std::reverse(s.abstractPath.begin(), s.abstractPath.end());
+		s.abstractPath.emplace_back(endIndex);
+
+		//Now to refine each abstract step back into grid nodes
+		int previous = startIndex;
+		for (int next : s.abstractPath) {
+			if (next == previous) {
+				continue;
+			}
+			int cluster = GetClusterForIndex(previous);
+			if (cluster != GetClusterForIndex(next)) {
+				s.gridPath.emplace_back(next);	//an entrance, which is always a single step
+			}
+			else if (!ClusterPath(cluster, previous, next, s.grid, &s.gridPath)) {
+				return false;
+			}
+			previous = next;
+		}
+	}
+
+	for (auto i = s.gridPath.rbegin(); i != s.gridPath.rend(); ++i) {
+		outPath.PushWaypoint(grid.GetNode(*i).position);
+	}
+	return true;
+}
+
+void HierarchicalNavigationGrid::SetNodeType(int x, int y, int type) {
+	if (x < 0 || x > grid.GetGridWidth() - 1 ||
+		y < 0 || y > grid.GetGridHeight() - 1) {
+		return;
+	}
+	grid.SetNodeType(x, y, type); //we'll hear about it through our listener
+}
+
+//However many nodes in a cluster changed, it only gets rebuilt the once
+void HierarchicalNavigationGrid::OnNodesChanged(const std::vector<int>& changedNodes) {
+	int width = grid.GetGridWidth();
+
+	std::vector<int> changedClusters;
+	for (int node : changedNodes) {
+		int clusterX = (node % width) / clusterSize;
+		int clusterY = (node / width) / clusterSize;
+		changedClusters.emplace_back((clusterY * clustersWide) + clusterX);
+	}
+	std::sort(changedClusters.begin(), changedClusters.end());
+	changedClusters.erase(std::unique(changedClusters.begin(), changedClusters.end()), changedClusters.end());
+
+	for (int c : changedClusters) {
+		RebuildCluster(c % clustersWide, c / clustersWide);
+	}
+}
+
+/*
+Throws away the entrances on all four sides of a cluster and finds them again,
+then relinks the abstract nodes in it, and in the neighbours sharing those sides.
+*/
+void HierarchicalNavigationGrid::RebuildCluster(int clusterX, int clusterY) {
+	if (clusterX < 0 || clusterX > clustersWide - 1 ||
+		clusterY < 0 || clusterY > clustersHigh - 1) {
+		return;
+	}
+	int id = (clusterY * clustersWide) + clusterX;
+
+	for (int i = 0; i < 4; ++i) {
+		int b = clusters[id].borders[i];
+		if (b >= 0) {
+			ClearBorder(b);
+			BuildBorder(b);
+		}
+	}
+	BuildIntraEdges(id, buildScratch);
+	for (int i = 0; i < 4; ++i) {
+		int b = clusters[id].borders[i];
+		if (b >= 0) {
+			BuildIntraEdges(borders[b].clusterA == id ? borders[b].clusterB : borders[b].clusterA, buildScratch);
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "NavigationGrid.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		struct HierarchicalSearchScratch {
+			GridSearchScratch		grid;	//for the searches inside a single cluster
+
+			std::vector<float>		g;
+			std::vector<int>		parent;
+			std::vector<bool>		closed;
+			std::vector<float>		endCosts;	//cost from each abstract node in the goal's cluster to the goal
+			std::vector<int>		abstractPath;
+			std::vector<int>		gridPath;
+		};
+
+		/*
+		HPA* - rather than searching every node of a large grid, the grid is split up
+		into square clusters, and wherever two neighbouring clusters can be walked
+		between we place an 'entrance' - a pair of abstract nodes, one on each side.
+		The abstract nodes within a cluster are linked together by the cost of the
+		best route between them that stays inside that cluster.
+
+		A query then searches this much smaller abstract graph, and only refines the
+		steps it actually takes back into grid nodes, with each refinement being a
+		small search limited to just one cluster.
+
+		Paths aren't quite optimal, but are generally very close. When a node's type
+		changes (whether through us, or straight through the grid), only the clusters
+		touching it need their entrances rebuilt.
+		*/
+		class HierarchicalNavigationGrid : public NavigationMap	{
+		public:
+			HierarchicalNavigationGrid(NavigationGrid& grid, int clusterSize = 16);
+			//clusterSize is only used if the file has no usable cluster data
+			HierarchicalNavigationGrid(NavigationGrid& grid, const NavigationDataFile& file, int clusterSize = 16);
+			~HierarchicalNavigationGrid();
+
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, HierarchicalSearchScratch& scratch) const;
+
+			void SetNodeType(int x, int y, int type);
+
+			void RebuildCluster(int clusterX, int clusterY);
+
+			void WriteNavData(NavigationDataWriter& writer) const;
+
+			int GetAbstractNodeCount() const {
+				return (int)(nodes.size() - freeNodes.size());
+			}
+
+		protected:
+			void OnNodesChanged(const std::vector<int>& changedNodes);
+
+			struct AbstractEdge {
+				int		to;
+				float	cost;
+				bool	inter;	//crosses to a neighbouring cluster
+			};
+
+			struct AbstractNode {
+				int		gridIndex;
+				int		cluster;
+				bool	alive;
+				std::vector<AbstractEdge> edges;
+			};
+
+			/*
+			Every pair of neighbouring clusters shares a border, which owns all of the
+			abstract nodes for the entrances along it. A grid node on a cluster's corner
+			can end up with an abstract node from two borders - that's fine, they just
+			get linked together with a zero cost intra-cluster edge.
+			*/
+			struct Border {
+				int clusterA;	//left or above
+				int clusterB;	//right or below
+				std::vector<int> nodes;
+			};
+
+			struct Cluster {
+				GridRect rect;
+				int borders[4];	//above, below, left, right - -1 at the edge of the map
+			};
+
+			void	CreateClusters(int clusterSize);
+			void	BuildAll();
+			bool	LoadNavData(const NavigationDataFile& file);
+
+			void	BuildBorder(int borderID);
+			void	ClearBorder(int borderID);
+			void	AddEntrance(Border& b, int gridA, int gridB, bool vertical);
+			int		AddNode(int gridIndex, int cluster);
+
+			void	BuildIntraEdges(int clusterID, GridSearchScratch& scratch);
+			void	GatherClusterNodes(int clusterID, std::vector<int>& out) const;
+
+			bool	ClusterPath(int clusterID, int startIndex, int endIndex, GridSearchScratch& scratch, std::vector<int>* outCells) const;
+			float	AbstractHeuristic(int gridIndex, int goalIndex) const;
+
+			int		GetClusterForIndex(int gridIndex) const;
+
+			NavigationGrid&	grid;
+			int				clusterSize;
+			int				clustersWide;
+			int				clustersHigh;
+
+			std::vector<Cluster>		clusters;
+			std::vector<Border>			borders;	//right borders first, then bottom borders
+			std::vector<AbstractNode>	nodes;
+			std::vector<int>			freeNodes;
+
+			int							listenerID;
+
+			GridSearchScratch			buildScratch;
+			HierarchicalSearchScratch	scratch;
+		};
+	}
+}
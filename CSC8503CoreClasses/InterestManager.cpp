@@ -0,0 +1,152 @@
+#include "InterestManager.h"
+#include "SnapshotHistory.h"
+#include "NetworkObject.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace NCL;
+using namespace CSC8503;
+
+//Even objects at the very edge of the relevant area still slowly build up priority
+const float MinimumDistanceScale = 0.1f;
+
+InterestManager::InterestManager(float cellSize, float relevantDistance) {
+	const NetworkQuantisation& q = NetworkObject::GetQuantisation();
+
+	this->cellSize			= cellSize;
+	this->relevantDistance	= relevantDistance;
+	gridMinX	= q.worldMin.x;
+	gridMinZ	= q.worldMin.z;
+	gridWidth	= std::max(1, (int)std::ceil((q.worldMax.x - q.worldMin.x) / cellSize));
+	gridDepth	= std::max(1, (int)std::ceil((q.worldMax.z - q.worldMin.z) / cellSize));
+}
+
+InterestManager::~InterestManager() {
+}
+
+void InterestManager::SetObjectPriority(int networkID, float priority) {
+	if (networkID < 0) {
+		return;
+	}
+	if (networkID >= (int)priorities.size()) {
+		priorities.resize(networkID + 1, 1.0f);
+	}
+	priorities[networkID] = priority;
+}
+
+void InterestManager::SetAlwaysRelevant(int networkID, bool state) {
+	if (networkID < 0) {
+		return;
+	}
+	if (networkID >= (int)alwaysRelevant.size()) {
+		alwaysRelevant.resize(networkID + 1, 0);
+	}
+	alwaysRelevant[networkID] = state;
+}
+
+int InterestManager::GetCellIndex(float x, float z) const {
+	int cellX = std::clamp((int)std::floor((x - gridMinX) / cellSize), 0, gridWidth - 1);
+	int cellZ = std::clamp((int)std::floor((z - gridMinZ) / cellSize), 0, gridDepth - 1);
+	return (cellZ * gridWidth) + cellX;
+}
+
+void InterestManager::Update(const WorldSnapshot& world) {
+	int objectCount = (int)world.hasState.size();
+
+	objectPositions.resize(objectCount);
+	objectStateIDs.resize(objectCount);
+	objectCells.resize(objectCount);
+	alwaysRelevantObjects.clear();
+	cellStarts.assign((gridWidth * gridDepth) + 1, 0);
+
+	//Count how many objects are in each cell, turn that into where each cell's
+	//objects start, then fill the cells in
+	for (int i = 0; i < objectCount; ++i) {
+		objectCells[i] = -1;
+		if (!world.hasState[i]) {
+			continue;
+		}
+		objectStateIDs[i] = world.states[i].stateID;
+		if (i < (int)alwaysRelevant.size() && alwaysRelevant[i]) {
+			alwaysRelevantObjects.emplace_back(i);
+			continue;
+		}
+		objectPositions[i]	= world.states[i].position;
+		objectCells[i]		= GetCellIndex(objectPositions[i].x, objectPositions[i].z);
+		cellStarts[objectCells[i] + 1]++;
+	}
+	for (size_t i = 1; i < cellStarts.size(); ++i) {
+		cellStarts[i] += cellStarts[i - 1];
+	}
+	cellFill.assign(cellStarts.begin(), cellStarts.end() - 1);
+	cellObjects.resize(cellStarts.back());
+	for (int i = 0; i < objectCount; ++i) {
+		if (objectCells[i] >= 0) {
+			cellObjects[cellFill[objectCells[i]]++] = i;
+		}
+	}
+}
+
+void InterestManager::AddPriority(std::vector<float>& accumulators, std::vector<int>& ordered, int networkID, float scale) {
+	if (networkID >= (int)accumulators.size()) {
+		accumulators.resize(networkID + 1, 0.0f);
+	}
+	float priority = networkID < (int)priorities.size() ? priorities[networkID] : 1.0f;
+	accumulators[networkID] += priority * scale;
+	ordered.emplace_back(networkID);
+}
+
+bool InterestManager::IsKnown(const WorldSnapshot* known, int networkID) const {
+	const NetworkState* state = known ? known->GetState(networkID) : nullptr;
+	return state && state->stateID == objectStateIDs[networkID];
+}
+
+void InterestManager::Prioritise(const Vector3* viewpoint, std::vector<float>& accumulators, std::vector<int>& ordered, const WorldSnapshot* known) {
+	ordered.clear();
+
+	for (int i : alwaysRelevantObjects) {
+		if (!IsKnown(known, i)) {
+			AddPriority(accumulators, ordered, i, 1.0f);
+		}
+	}
+	if (!viewpoint) {
+		for (int i : cellObjects) {
+			if (!IsKnown(known, i)) {
+				AddPriority(accumulators, ordered, i, 1.0f);
+			}
+		}
+	}
+	else {
+		int minCell = GetCellIndex(viewpoint->x - relevantDistance, viewpoint->z - relevantDistance);
+		int maxCell = GetCellIndex(viewpoint->x + relevantDistance, viewpoint->z + relevantDistance);
+
+		float distanceSquared = relevantDistance * relevantDistance;
+
+		for (int z = minCell / gridWidth; z <= maxCell / gridWidth; ++z) {
+			for (int x = minCell % gridWidth; x <= maxCell % gridWidth; ++x) {
+				int cell = (z * gridWidth) + x;
+				for (int j = cellStarts[cell]; j < cellStarts[cell + 1]; ++j) {
+					int		i		= cellObjects[j];
+					if (IsKnown(known, i)) {
+						continue;
+					}
+					//On the XZ plane, like the grid - height doesn't make something less relevant
+					float	offsetX	= objectPositions[i].x - viewpoint->x;
+					float	offsetZ	= objectPositions[i].z - viewpoint->z;
+					float	d		= (offsetX * offsetX) + (offsetZ * offsetZ);
+					if (d > distanceSquared) {
+						continue;
+					}
+					float scale = std::max(MinimumDistanceScale, 1.0f - (std::sqrt(d) / relevantDistance));
+					AddPriority(accumulators, ordered, i, scale);
+				}
+			}
+		}
+	}
+	std::sort(ordered.begin(), ordered.end(),
+		[&](int a, int b) {
+			return accumulators[a] > accumulators[b];
+		}
+	);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "Vector.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		struct WorldSnapshot;
+
+		/*
+		Decides which objects each client gets told about, and in what order.
+
+		Networked objects are bucketed into a uniform grid over the XZ plane each
+		tick (the grid covers the NetworkQuantisation world bounds, as nothing can
+		be sent from outside them anyway). An object is relevant to a client if it's
+		within relevantDistance of that client's viewpoint across the XZ plane, as
+		height is ignored - only the cells that overlap that circle are looked at,
+		so the cost depends on how crowded the area around the client is, not on
+		the size of the map. Objects can also be
+		marked as always relevant (players, say), and clients without a viewpoint
+		yet just see everything.
+
+		Each client keeps a priority accumulator per object. Every tick an object
+		is relevant its priority is added on, scaled by how close it is, and the
+		objects are sent highest first until the client's byte budget for the tick
+		runs out. Sending an object resets its accumulator, so distant objects still
+		get their turn eventually, just less often than the ones right next to the
+		client.
+		*/
+		class InterestManager	{
+		public:
+			InterestManager(float cellSize = 32.0f, float relevantDistance = 128.0f);
+			~InterestManager();
+
+			void SetRelevantDistance(float distance) {
+				relevantDistance = distance;
+			}
+			float GetRelevantDistance() const {
+				return relevantDistance;
+			}
+
+			void SetObjectPriority(int networkID, float priority);
+			void SetAlwaysRelevant(int networkID, bool state);
+
+			//Rebuilds the grid from this tick's object states
+			void Update(const WorldSnapshot& world);
+
+			/*
+			Adds each relevant object's priority onto the client's accumulators, and
+			fills ordered with them, highest accumulated priority first. viewpoint can
+			be nullptr, if the client has nothing in the world yet.
+
+			If known is set, objects it already has this tick's state for (going by
+			stateID) are skipped entirely - they've nothing to send, so there's no
+			point building up priority or sorting them.
+			*/
+			void Prioritise(const Vector3* viewpoint, std::vector<float>& accumulators, std::vector<int>& ordered, const WorldSnapshot* known = nullptr);
+
+			//Call once the client has been sent an object (or is already up to date with it)
+			static void ResetPriority(std::vector<float>& accumulators, int networkID) {
+				if (networkID < (int)accumulators.size()) {
+					accumulators[networkID] = 0.0f;
+				}
+			}
+
+		protected:
+			int GetCellIndex(float x, float z) const;
+			void AddPriority(std::vector<float>& accumulators, std::vector<int>& ordered, int networkID, float scale);
+			bool IsKnown(const WorldSnapshot* known, int networkID) const;
+
+			float cellSize;
+			float relevantDistance;
+			float gridMinX;
+			float gridMinZ;
+			int	  gridWidth;
+			int	  gridDepth;
+
+			std::vector<float>		priorities;		//indexed by network ID, 1 if never set
+			std::vector<uint8_t>	alwaysRelevant;
+
+			//The grid, stored as each cell's range into cellObjects
+			std::vector<int>		cellStarts;
+			std::vector<int>		cellObjects;
+			std::vector<int>		cellFill;
+			std::vector<int>		objectCells;		//indexed by network ID, -1 if not in the grid
+			std::vector<Vector3>	objectPositions;
+			std::vector<int>		objectStateIDs;
+			std::vector<int>		alwaysRelevantObjects;
+		};
+	}
+}
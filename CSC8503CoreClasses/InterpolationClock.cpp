@@ -0,0 +1,70 @@
+#include "InterpolationClock.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+const double BufferTicks		= 2.0;	//one to interpolate across, and one spare in case a snapshot goes missing
+const double JitterScale		= 2.0;
+const double MaxDelayTicks		= 10.0;
+const double OffsetSmoothing	= 0.1;
+const double JitterSmoothing	= 1.0 / 16.0;
+const double CatchUpRate		= 0.1;	//how much faster (or slower) to play per tick we're out by...
+const double MaxTimeScale		= 0.1;	//...up to 10%, which isn't noticeable
+const double SnapTicks			= 4.0;	//beyond this, don't bother drifting
+
+InterpolationClock::InterpolationClock(float tickRate) {
+	this->tickRate = tickRate;
+	Reset();
+}
+
+InterpolationClock::~InterpolationClock() {
+}
+
+void InterpolationClock::Reset() {
+	running		= false;
+	localTime	= 0.0;
+	offset		= 0.0;
+	jitter		= 0.0;
+	renderTick	= 0.0;
+}
+
+void InterpolationClock::OnSnapshotReceived(int snapshotID) {
+	double sample = snapshotID - (localTime * tickRate);
+	if (!running) {
+		running		= true;
+		offset		= sample;
+		renderTick	= GetTargetTick();
+		return;
+	}
+	double deviation = sample - offset;
+	offset += deviation * OffsetSmoothing;
+	jitter += (std::abs(deviation) - jitter) * JitterSmoothing;
+}
+
+float InterpolationClock::Update(float dt) {
+	if (!running) {
+		return 0.0f;
+	}
+	localTime += dt;
+
+	double error = GetTargetTick() - renderTick;
+	if (std::abs(error) > SnapTicks) {
+		renderTick += error;
+	}
+	else {
+		double scale = 1.0 + std::clamp(error * CatchUpRate, -MaxTimeScale, MaxTimeScale);
+		renderTick += dt * tickRate * scale;
+	}
+	return (float)renderTick;
+}
+
+float InterpolationClock::GetDelay() const {
+	return (float)std::min(BufferTicks + (jitter * JitterScale), MaxDelayTicks);
+}
+
+double InterpolationClock::GetTargetTick() const {
+	return (localTime * tickRate) + offset - GetDelay();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Works out which server tick a client should be showing remote objects at.
+
+		Snapshots only arrive a few times a second, so rather than snapping objects
+		to each one as it arrives, the client plays them back a little in the past,
+		and interpolates between the two snapshots either side of that time (see
+		NetworkObject::UpdateInterpolation). How far in the past is the jitter
+		buffer - it has to be at least a tick, so there's a newer snapshot to move
+		towards, plus enough to cover a lost snapshot, plus however much the
+		arrival times have been wobbling about by.
+
+		Snapshot IDs are server ticks, so each arrival tells us roughly what tick
+		the server is on right now. The offset between that and our own clock is
+		smoothed, as is the jitter (the average distance of each arrival from where
+		the smoothed offset said it would be, like RTP's jitter estimate). Rather
+		than jumping whenever the target time moves, playback is sped up or slowed
+		down slightly to drift towards it, so objects never jump backwards - unless
+		it's too far out, such as after a long stall, when it just snaps.
+		*/
+		class InterpolationClock	{
+		public:
+			InterpolationClock(float tickRate = 20.0f);
+			~InterpolationClock();
+
+			void Reset();
+
+			//Should match the rate the server sends snapshots at
+			void SetTickRate(float rate) {
+				tickRate = rate;
+			}
+			float GetTickRate() const {
+				return tickRate;
+			}
+
+			//Call once per snapshot, as soon as any of it arrives
+			void OnSnapshotReceived(int snapshotID);
+
+			//Moves the clock on by dt seconds, returning the tick to render at
+			float Update(float dt);
+
+			float GetRenderTick() const {
+				return (float)renderTick;
+			}
+			//How far behind the newest snapshot we're aiming to render, in ticks
+			float GetDelay() const;
+			float GetJitter() const {
+				return (float)jitter;
+			}
+			bool IsRunning() const {
+				return running;
+			}
+
+		protected:
+			double GetTargetTick() const;
+
+			float	tickRate;
+			bool	running;
+
+			double	localTime;	//seconds since the first snapshot
+			double	offset;		//smoothed server tick minus local tick
+			double	jitter;		//in ticks
+			double	renderTick;
+		};
+	}
+}
@@ -0,0 +1,117 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+JobSystem::JobSystem(int workerCount) {
+	job				= nullptr;
+	jobCount		= 0;
+	jobGrain		= 1;
+	jobChunks		= 0;
+	chunksDone		= 0;
+	activeWorkers	= 0;
+	generation		= 0;
+	quit			= false;
+	nextChunk		= 0;
+
+	if (workerCount < 0) {
+		workerCount = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+	}
+	for (int i = 0; i < workerCount; ++i) {
+		workers.emplace_back(&JobSystem::WorkerThread, this);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		quit = true;
+	}
+	jobReady.notify_all();
+	for (std::thread& t : workers) {
+		t.join();
+	}
+}
+
+size_t JobSystem::RunChunks(const RangeFunc& func, size_t count, size_t grainSize, size_t chunkCount) {
+	size_t done = 0;
+	while (true) {
+		size_t chunk = nextChunk.fetch_add(1);
+		if (chunk >= chunkCount) {
+			break;
+		}
+		size_t begin = chunk * grainSize;
+		func(begin, std::min(count, begin + grainSize));
+		done++;
+	}
+	return done;
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grainSize, const RangeFunc& func) {
+	if (count == 0) {
+		return;
+	}
+	grainSize = std::max((size_t)1, grainSize);
+	size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+	if (workers.empty() || chunkCount == 1) {
+		func(0, count);
+		return;
+	}
+	std::lock_guard<std::mutex> callLock(callMutex);
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		job			= &func;
+		jobCount	= count;
+		jobGrain	= grainSize;
+		jobChunks	= chunkCount;
+		chunksDone	= 0;
+		nextChunk	= 0;
+		generation++;
+	}
+	jobReady.notify_all();
+
+	size_t done = RunChunks(func, count, grainSize, chunkCount);
+
+	std::unique_lock<std::mutex> lock(jobMutex);
+	chunksDone += done;
+	//wait for any worker still inside the job too, as they hold a pointer to func
+	jobDone.wait(lock, [&] {
+		return chunksDone == jobChunks && activeWorkers == 0;
+	});
+	job = nullptr;
+}
+
+void JobSystem::WorkerThread() {
+	int seenGeneration = 0;
+	std::unique_lock<std::mutex> lock(jobMutex);
+	while (true) {
+		jobReady.wait(lock, [&] {
+			return quit || generation != seenGeneration;
+		});
+		if (quit) {
+			return;
+		}
+		seenGeneration = generation;
+		if (!job) { //woke up too late, the caller has already finished this one
+			continue;
+		}
+		const RangeFunc* func	= job;
+		size_t count			= jobCount;
+		size_t grainSize		= jobGrain;
+		size_t chunkCount		= jobChunks;
+		activeWorkers++;
+
+		lock.unlock();
+		size_t done = RunChunks(*func, count, grainSize, chunkCount);
+		lock.lock();
+
+		chunksDone += done;
+		activeWorkers--;
+		if (chunksDone == jobChunks && activeWorkers == 0) {
+			jobDone.notify_all();
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+namespace NCL {
+	namespace CSC8503 {
+		typedef std::function<void(size_t begin, size_t end)> RangeFunc;
+
+		/*
+		A small pool of long-lived worker threads, for splitting per-frame loops
+		(steering, AI updates etc) across cores without paying to start threads
+		every frame.
+
+		ParallelFor cuts [0, count) into chunks of grainSize, and hands them out to
+		the workers - the calling thread helps out too, and doesn't return until
+		every chunk is done, so the function can safely capture locals by reference.
+		Chunks may run in any order, on any thread, so they mustn't write to
+		anything another chunk touches.
+		*/
+		class JobSystem	{
+		public:
+			JobSystem(int workerCount = -1);	//-1 leaves one core for the calling thread
+			~JobSystem();
+
+			void ParallelFor(size_t count, size_t grainSize, const RangeFunc& func);
+
+			int GetWorkerCount() const {
+				return (int)workers.size();
+			}
+
+		protected:
+			void	WorkerThread();
+			size_t	RunChunks(const RangeFunc& func, size_t count, size_t grainSize, size_t chunkCount);
+
+			std::vector<std::thread>	workers;
+
+			std::mutex					callMutex;	//one ParallelFor at a time
+			std::mutex					jobMutex;
+			std::condition_variable		jobReady;
+			std::condition_variable		jobDone;
+
+			const RangeFunc*	job;
+			size_t				jobCount;
+			size_t				jobGrain;
+			size_t				jobChunks;
+			size_t				chunksDone;
+			int					activeWorkers;
+			int					generation;
+			bool				quit;
+
+			std::atomic<size_t>	nextChunk;
+		};
+	}
+}
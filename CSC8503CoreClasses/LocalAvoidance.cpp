@@ -0,0 +1,370 @@
+#include "LocalAvoidance.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace NCL;
+using namespace CSC8503;
+
+const float ORCA_EPSILON = 0.00001f;
+
+static float Det(const Vector2& a, const Vector2& b) {
+	return (a.x * b.y) - (a.y * b.x);
+}
+
+LocalAvoidance::LocalAvoidance(float neighbourDistance, float timeHorizon, int maxNeighbours) {
+	this->neighbourDistance = neighbourDistance;
+	this->timeHorizon		= timeHorizon;
+	this->maxNeighbours		= maxNeighbours;
+	bucketMask	= 0;
+	jobSystem	= nullptr;
+}
+
+LocalAvoidance::~LocalAvoidance() {
+}
+
+int LocalAvoidance::AddAgent(const Vector3& position, float radius, float maxSpeed) {
+	int id;
+	if (!freeAgents.empty()) {
+		id = freeAgents.back();
+		freeAgents.pop_back();
+	}
+	else {
+		id = (int)agents.size();
+		agents.emplace_back();
+	}
+	Agent& a = agents[id];
+	a.position			= Vector2(position.x, position.z);
+	a.velocity			= Vector2();
+	a.preferredVelocity = Vector2();
+	a.newVelocity		= Vector2();
+	a.preferredY		= 0.0f;
+	a.radius			= radius;
+	a.maxSpeed			= maxSpeed;
+	a.active			= true;
+	return id;
+}
+
+void LocalAvoidance::RemoveAgent(int agent) {
+	if (agent < 0 || agent >= (int)agents.size() || !agents[agent].active) {
+		return;
+	}
+	agents[agent].active = false;
+	freeAgents.emplace_back(agent);
+}
+
+void LocalAvoidance::Clear() {
+	agents.clear();
+	freeAgents.clear();
+}
+
+void LocalAvoidance::SetAgentPosition(int agent, const Vector3& position) {
+	agents[agent].position = Vector2(position.x, position.z);
+}
+
+void LocalAvoidance::SetAgentState(int agent, const Vector3& position, const Vector3& velocity) {
+	agents[agent].position = Vector2(position.x, position.z);
+	agents[agent].velocity = Vector2(velocity.x, velocity.z);
+}
+
+void LocalAvoidance::SetPreferredVelocity(int agent, const Vector3& velocity) {
+	agents[agent].preferredVelocity = Vector2(velocity.x, velocity.z);
+	agents[agent].preferredY		= velocity.y;
+}
+
+Vector3 LocalAvoidance::GetVelocity(int agent) const {
+	const Agent& a = agents[agent];
+	return Vector3(a.newVelocity.x, a.preferredY, a.newVelocity.y);
+}
+
+/*
+Cells are neighbourDistance wide, so everything close enough to matter is in
+the 3x3 block of cells around an agent. Rather than a fixed size grid the
+cells are hashed into a table twice the size of the crowd, so the agents can
+be spread over any size of world.
+*/
+int LocalAvoidance::GetCellBucket(int cellX, int cellZ) const {
+	unsigned int h = ((unsigned int)cellX * 73856093u) ^ ((unsigned int)cellZ * 19349663u);
+	return (int)(h & (unsigned int)bucketMask);
+}
+
+void LocalAvoidance::BuildNeighbourGrid() {
+	int bucketCount = 16;
+	while (bucketCount < (int)agents.size() * 2) {
+		bucketCount *= 2;
+	}
+	bucketMask = bucketCount - 1;
+
+	bucketStart.assign(bucketCount + 1, 0);
+	bucketAgents.resize(agents.size());
+
+	std::vector<int> agentBucket(agents.size(), -1);
+	for (size_t i = 0; i < agents.size(); ++i) {
+		if (!agents[i].active) {
+			continue;
+		}
+		int cellX = (int)std::floor(agents[i].position.x / neighbourDistance);
+		int cellZ = (int)std::floor(agents[i].position.y / neighbourDistance);
+		agentBucket[i] = GetCellBucket(cellX, cellZ);
+		bucketStart[agentBucket[i] + 1]++;
+	}
+	for (int i = 0; i < bucketCount; ++i) {
+		bucketStart[i + 1] += bucketStart[i];
+	}
+	std::vector<int> fill(bucketStart.begin(), bucketStart.end() - 1);
+	for (size_t i = 0; i < agents.size(); ++i) {
+		if (agentBucket[i] >= 0) {
+			bucketAgents[fill[agentBucket[i]]++] = (int)i;
+		}
+	}
+}
+
+//Keeps the closest maxNeighbours agents within range, nearest first
+void LocalAvoidance::FindNeighbours(int agent, SolveScratch& scratch) const {
+	scratch.neighbours.clear();
+	const Agent& a = agents[agent];
+
+	int cellX = (int)std::floor(a.position.x / neighbourDistance);
+	int cellZ = (int)std::floor(a.position.y / neighbourDistance);
+	float rangeSq = neighbourDistance * neighbourDistance;
+
+	int visited[9];
+	int visitedCount = 0;
+	for (int z = -1; z <= 1; ++z) {
+		for (int x = -1; x <= 1; ++x) {
+			int bucket = GetCellBucket(cellX + x, cellZ + z);
+			if (std::find(visited, visited + visitedCount, bucket) != visited + visitedCount) {
+				continue; //two cells hashed to the same bucket
+			}
+			visited[visitedCount++] = bucket;
+
+			for (int i = bucketStart[bucket]; i < bucketStart[bucket + 1]; ++i) {
+				int other = bucketAgents[i];
+				if (other == agent) {
+					continue;
+				}
+				float distSq = Vector::LengthSquared(agents[other].position - a.position);
+				if (distSq >= rangeSq) {
+					continue;
+				}
+				if ((int)scratch.neighbours.size() == maxNeighbours) {
+					if (distSq >= scratch.neighbours.back().first) {
+						continue;
+					}
+					scratch.neighbours.pop_back();
+				}
+				auto pos = std::upper_bound(scratch.neighbours.begin(), scratch.neighbours.end(), std::make_pair(distSq, other));
+				scratch.neighbours.insert(pos, { distSq, other });
+			}
+		}
+	}
+}
+
+void LocalAvoidance::SolveAgent(int agent, float dt, SolveScratch& scratch) {
+	Agent& a = agents[agent];
+	FindNeighbours(agent, scratch);
+
+	scratch.lines.clear();
+	float invTimeHorizon = 1.0f / timeHorizon;
+
+	for (const auto& n : scratch.neighbours) {
+		const Agent& other = agents[n.second];
+
+		Vector2 relativePosition	= other.position - a.position;
+		Vector2 relativeVelocity	= a.velocity - other.velocity;
+		float distSq				= n.first;
+		float combinedRadius		= a.radius + other.radius;
+		float combinedRadiusSq		= combinedRadius * combinedRadius;
+
+		Line	line;
+		Vector2 u;
+
+		if (distSq > combinedRadiusSq) {
+			//No collision yet - w is from the centre of the cut-off circle to the relative velocity
+			Vector2 w			= relativeVelocity - relativePosition * invTimeHorizon;
+			float wLengthSq		= Vector::LengthSquared(w);
+			float dotProduct1	= Vector::Dot(w, relativePosition);
+
+			if (dotProduct1 < 0.0f && dotProduct1 * dotProduct1 > combinedRadiusSq * wLengthSq) {
+				//project onto the cut-off circle
+				float wLength	= std::sqrt(wLengthSq);
+				Vector2 unitW	= w / wLength;
+				line.direction	= Vector2(unitW.y, -unitW.x);
+				u = unitW * ((combinedRadius * invTimeHorizon) - wLength);
+			}
+			else {
+				//project onto whichever leg of the cone is closest
+				float leg = std::sqrt(distSq - combinedRadiusSq);
+				if (Det(relativePosition, w) > 0.0f) {
+					line.direction = Vector2(relativePosition.x * leg - relativePosition.y * combinedRadius,
+						relativePosition.x * combinedRadius + relativePosition.y * leg) / distSq;
+				}
+				else {
+					line.direction = -Vector2(relativePosition.x * leg + relativePosition.y * combinedRadius,
+						-relativePosition.x * combinedRadius + relativePosition.y * leg) / distSq;
+				}
+				float dotProduct2 = Vector::Dot(relativeVelocity, line.direction);
+				u = (line.direction * dotProduct2) - relativeVelocity;
+			}
+		}
+		else {
+			//Already overlapping - get apart within this one timestep
+			float invTimeStep	= 1.0f / dt;
+			Vector2 w			= relativeVelocity - relativePosition * invTimeStep;
+			float wLength		= Vector::Length(w);
+			Vector2 unitW		= wLength > ORCA_EPSILON ? w / wLength : Vector2(1, 0);
+			line.direction		= Vector2(unitW.y, -unitW.x);
+			u = unitW * ((combinedRadius * invTimeStep) - wLength);
+		}
+		line.point = a.velocity + u * 0.5f;
+		scratch.lines.emplace_back(line);
+	}
+
+	Vector2 result;
+	size_t lineFail = LinearProgram2(scratch.lines, a.maxSpeed, a.preferredVelocity, false, result);
+	if (lineFail < scratch.lines.size()) {
+		LinearProgram3(scratch.lines, lineFail, a.maxSpeed, result, scratch.projectedLines);
+	}
+	a.newVelocity = result;
+}
+
+/*
+Finds the best point along line lineNo, inside the speed limit circle and on the
+valid side of all of the lines before it.
+*/
+bool LocalAvoidance::LinearProgram1(const std::vector<Line>& lines, size_t lineNo, float radius, const Vector2& optVelocity, bool directionOpt, Vector2& result) {
+	const Line& line	= lines[lineNo];
+	float dotProduct	= Vector::Dot(line.point, line.direction);
+	float discriminant	= (dotProduct * dotProduct) + (radius * radius) - Vector::LengthSquared(line.point);
+
+	if (discriminant < 0.0f) {
+		return false; //the speed limit circle misses this line entirely
+	}
+	float sqrtDiscriminant	= std::sqrt(discriminant);
+	float tLeft				= -dotProduct - sqrtDiscriminant;
+	float tRight			= -dotProduct + sqrtDiscriminant;
+
+	for (size_t i = 0; i < lineNo; ++i) {
+		float denominator	= Det(line.direction, lines[i].direction);
+		float numerator		= Det(lines[i].direction, line.point - lines[i].point);
+
+		if (std::fabs(denominator) <= ORCA_EPSILON) { //parallel lines
+			if (numerator < 0.0f) {
+				return false;
+			}
+			continue;
+		}
+		float t = numerator / denominator;
+		if (denominator >= 0.0f) {
+			tRight = std::min(tRight, t);
+		}
+		else {
+			tLeft = std::max(tLeft, t);
+		}
+		if (tLeft > tRight) {
+			return false;
+		}
+	}
+
+	if (directionOpt) {
+		result = line.point + line.direction * (Vector::Dot(optVelocity, line.direction) > 0.0f ? tRight : tLeft);
+	}
+	else {
+		float t = Vector::Dot(line.direction, optVelocity - line.point);
+		t = std::clamp(t, tLeft, tRight);
+		result = line.point + line.direction * t;
+	}
+	return true;
+}
+
+//Returns the number of the line it failed on, or lines.size() if it succeeded
+size_t LocalAvoidance::LinearProgram2(const std::vector<Line>& lines, float radius, const Vector2& optVelocity, bool directionOpt, Vector2& result) {
+	if (directionOpt) {
+		result = optVelocity * radius;
+	}
+	else if (Vector::LengthSquared(optVelocity) > radius * radius) {
+		result = Vector::Normalise(optVelocity) * radius;
+	}
+	else {
+		result = optVelocity;
+	}
+
+	for (size_t i = 0; i < lines.size(); ++i) {
+		if (Det(lines[i].direction, lines[i].point - result) > 0.0f) {
+			//result is on the wrong side of this line, so the best answer must be on it
+			Vector2 tempResult = result;
+			if (!LinearProgram1(lines, i, radius, optVelocity, directionOpt, result)) {
+				result = tempResult;
+				return i;
+			}
+		}
+	}
+	return lines.size();
+}
+
+/*
+No velocity satisfies every constraint (the crowd is too dense), so instead find
+the velocity that breaks them by the smallest amount.
+*/
+void LocalAvoidance::LinearProgram3(const std::vector<Line>& lines, size_t beginLine, float radius, Vector2& result, std::vector<Line>& projectedLines) {
+	float distance = 0.0f;
+
+	for (size_t i = beginLine; i < lines.size(); ++i) {
+		if (Det(lines[i].direction, lines[i].point - result) <= distance) {
+			continue;
+		}
+		projectedLines.clear();
+
+		for (size_t j = 0; j < i; ++j) {
+			Line line;
+			float determinant = Det(lines[i].direction, lines[j].direction);
+
+			if (std::fabs(determinant) <= ORCA_EPSILON) {
+				if (Vector::Dot(lines[i].direction, lines[j].direction) > 0.0f) {
+					continue; //same direction
+				}
+				line.point = (lines[i].point + lines[j].point) * 0.5f;
+			}
+			else {
+				line.point = lines[i].point + lines[i].direction *
+					(Det(lines[j].direction, lines[i].point - lines[j].point) / determinant);
+			}
+			line.direction = Vector::Normalise(lines[j].direction - lines[i].direction);
+			projectedLines.emplace_back(line);
+		}
+
+		Vector2 tempResult = result;
+		if (LinearProgram2(projectedLines, radius, Vector2(-lines[i].direction.y, lines[i].direction.x), true, result) < projectedLines.size()) {
+			//shouldn't happen, it's only floating point error if it does
+			result = tempResult;
+		}
+		distance = Det(lines[i].direction, lines[i].point - result);
+	}
+}
+
+void LocalAvoidance::Update(float dt) {
+	if (agents.empty() || dt <= 0.0f) {
+		return;
+	}
+	BuildNeighbourGrid();
+
+	auto solveRange = [&](size_t begin, size_t end) {
+		SolveScratch scratch;
+		for (size_t i = begin; i < end; ++i) {
+			if (agents[i].active) {
+				SolveAgent((int)i, dt, scratch);
+			}
+		}
+	};
+	if (jobSystem) {
+		jobSystem->ParallelFor(agents.size(), 64, solveRange);
+	}
+	else {
+		solveRange(0, agents.size());
+	}
+	//only once every agent has been solved, as they all read each other's velocity
+	for (Agent& a : agents) {
+		a.velocity = a.newVelocity;
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "Vector.h"
+
+#include <vector>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		class JobSystem;
+
+		/*
+		Local avoidance for crowds of agents, using Optimal Reciprocal Collision
+		Avoidance (ORCA). Each frame the game tells us where every agent is, how it's
+		moving, and the velocity it would *like* to have (straight at its target,
+		say). For every pair of nearby agents we work out a half-plane of velocities
+		that keeps them apart for the next timeHorizon seconds - each agent taking
+		half the responsibility - and then pick the velocity inside all of those
+		half-planes closest to the preferred one, via a small 2D linear program.
+
+		Agents then steer around each other before they touch, rather than walking
+		into each other and leaving the physics system to push them apart again.
+
+		Avoidance is done on the XZ plane - the y part of the preferred velocity is
+		passed through untouched. Neighbours are found with a uniform grid, rebuilt
+		each Update, and if there's a JobSystem the agents are solved in parallel
+		(each agent only writes its own new velocity).
+		*/
+		class LocalAvoidance	{
+		public:
+			LocalAvoidance(float neighbourDistance = 5.0f, float timeHorizon = 2.0f, int maxNeighbours = 10);
+			~LocalAvoidance();
+
+			void SetJobSystem(JobSystem* jobs) {
+				jobSystem = jobs;
+			}
+
+			int  AddAgent(const Vector3& position, float radius, float maxSpeed);
+			void RemoveAgent(int agent);
+			void Clear();
+
+			/*
+			Agents that move exactly as we tell them only need their position updating,
+			those that get pushed around by physics should pass in their real velocity
+			*/
+			void SetAgentPosition(int agent, const Vector3& position);
+			void SetAgentState(int agent, const Vector3& position, const Vector3& velocity);
+			void SetPreferredVelocity(int agent, const Vector3& velocity);
+
+			void Update(float dt);
+
+			//The velocity the agent should move with this frame
+			Vector3 GetVelocity(int agent) const;
+
+			size_t GetAgentCount() const {
+				return agents.size() - freeAgents.size();
+			}
+
+		protected:
+			struct Agent {
+				Vector2 position;
+				Vector2 velocity;
+				Vector2 preferredVelocity;
+				Vector2 newVelocity;
+				float	preferredY;
+				float	radius;
+				float	maxSpeed;
+				bool	active;
+			};
+			struct Line {
+				Vector2 point;
+				Vector2 direction;
+			};
+			struct SolveScratch {
+				std::vector<Line>	lines;
+				std::vector<Line>	projectedLines;
+				std::vector<std::pair<float, int>> neighbours;
+			};
+
+			void	BuildNeighbourGrid();
+			int		GetCellBucket(int cellX, int cellZ) const;
+			void	FindNeighbours(int agent, SolveScratch& scratch) const;
+			void	SolveAgent(int agent, float dt, SolveScratch& scratch);
+
+			static bool		LinearProgram1(const std::vector<Line>& lines, size_t lineNo, float radius, const Vector2& optVelocity, bool directionOpt, Vector2& result);
+			static size_t	LinearProgram2(const std::vector<Line>& lines, float radius, const Vector2& optVelocity, bool directionOpt, Vector2& result);
+			static void		LinearProgram3(const std::vector<Line>& lines, size_t beginLine, float radius, Vector2& result, std::vector<Line>& projectedLines);
+
+			std::vector<Agent>	agents;
+			std::vector<int>	freeAgents;
+
+			//neighbour grid - the agents in each hash bucket, packed together
+			std::vector<int>	bucketStart;
+			std::vector<int>	bucketAgents;
+			int					bucketMask;
+
+			float neighbourDistance;
+			float timeHorizon;
+			int   maxNeighbours;
+
+			JobSystem* jobSystem;
+		};
+	}
+}
@@ -0,0 +1,174 @@
+#include "LoopbackTransport.h"
+#include "NetworkBase.h"
+
+#include <cstring>
+
+using namespace NCL;
+using namespace CSC8503;
+
+LoopbackNetwork::LoopbackNetwork(int maxClients) : clients(maxClients, nullptr), stats(maxClients), lossRoll(0.0f, 1.0f) {
+	server		= nullptr;
+	latency		= Clock::duration::zero();
+	packetLoss	= 0.0f;
+}
+
+LoopbackNetwork::~LoopbackNetwork() {
+}
+
+void LoopbackNetwork::SetLatency(float seconds) {
+	std::lock_guard<std::mutex> guard(lock);
+	latency = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(seconds));
+}
+
+void LoopbackNetwork::SetPacketLoss(float chance) {
+	std::lock_guard<std::mutex> guard(lock);
+	packetLoss = chance;
+}
+
+LoopbackNetwork::PeerStats LoopbackNetwork::GetStats(int peerID) const {
+	std::lock_guard<std::mutex> guard(lock);
+	return (peerID >= 0 && peerID < (int)stats.size()) ? stats[peerID] : PeerStats();
+}
+
+int LoopbackNetwork::GetClientCount() const {
+	std::lock_guard<std::mutex> guard(lock);
+	int count = 0;
+	for (LoopbackTransport* c : clients) {
+		count += c ? 1 : 0;
+	}
+	return count;
+}
+
+bool LoopbackNetwork::Listen(LoopbackTransport* t) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (server) {
+		return false;
+	}
+	server = t;
+	return true;
+}
+
+int LoopbackNetwork::Connect(LoopbackTransport* t) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (!server) {
+		return -1;
+	}
+	for (int i = 0; i < (int)clients.size(); ++i) {
+		if (!clients[i]) {
+			clients[i]	= t;
+			stats[i]	= PeerStats();
+			Post(server, Event_Connected, i);
+			Post(t, Event_Connected, -1);
+			return i;
+		}
+	}
+	return -1;
+}
+
+void LoopbackNetwork::Disconnect(LoopbackTransport* t) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (t == server) {
+		server = nullptr;
+		for (LoopbackTransport*& c : clients) {
+			if (c) {
+				Post(c, Event_Disconnected, -1);	//the client forgets its peerID once it sees this
+				c = nullptr;
+			}
+		}
+	}
+	else if (t->peerID >= 0 && t->peerID < (int)clients.size() && clients[t->peerID] == t) {
+		clients[t->peerID] = nullptr;
+		if (server) {
+			Post(server, Event_Disconnected, t->peerID);
+		}
+	}
+}
+
+bool LoopbackNetwork::Send(LoopbackTransport* from, int peerID, const GamePacket& packet) {
+	std::lock_guard<std::mutex> guard(lock);
+	size_t size = packet.GetTotalSize();
+
+	if (from != server) {
+		if (!server || from->peerID < 0 || clients[from->peerID] != from) {
+			return false;
+		}
+		stats[from->peerID].bytesFromClient += size;
+		stats[from->peerID].packetsFromClient++;
+		if (lossRoll(random) >= packetLoss) {
+			Post(server, Event_Received, from->peerID, &packet);
+		}
+		return true;
+	}
+	for (int i = 0; i < (int)clients.size(); ++i) {
+		if (!clients[i] || (peerID >= 0 && peerID != i)) {
+			continue;
+		}
+		stats[i].bytesToClient += size;
+		stats[i].packetsToClient++;
+		if (lossRoll(random) >= packetLoss) {
+			Post(clients[i], Event_Received, -1, &packet);
+		}
+	}
+	return true;
+}
+
+//Only ever called with the network locked, so nothing can disappear in the middle of it
+void LoopbackNetwork::Post(LoopbackTransport* to, int type, int peerID, const GamePacket* packet) {
+	LoopbackTransport::QueuedEvent q;
+	q.event.type	= type;
+	q.event.peerID	= peerID;
+	q.deliverAt		= Clock::now() + latency;
+	if (packet) {
+		q.event.size = packet->GetTotalSize();
+		q.event.data = new char[q.event.size];
+		memcpy(q.event.data, packet, q.event.size);
+	}
+	std::lock_guard<std::mutex> guard(to->queueLock);
+	to->queue.emplace_back(q);
+}
+
+LoopbackTransport::LoopbackTransport(LoopbackNetwork& network, bool listen) : network(network) {
+	peerID = -1;
+	if (listen) {
+		network.Listen(this);
+	}
+}
+
+LoopbackTransport::~LoopbackTransport() {
+	network.Disconnect(this);
+
+	std::lock_guard<std::mutex> guard(queueLock);
+	for (QueuedEvent& q : queue) {
+		delete[] q.event.data;
+	}
+}
+
+bool LoopbackTransport::Connect(uint32_t /*address*/, int /*port*/) {
+	if (peerID >= 0) {
+		return false;
+	}
+	peerID = network.Connect(this);
+	return peerID >= 0;
+}
+
+bool LoopbackTransport::Send(int peerID, const GamePacket& packet) {
+	return network.Send(this, peerID, packet);
+}
+
+//The latency is the same for everything, so the queue is always in delivery order
+bool LoopbackTransport::PopEvent(NetworkEvent& e) {
+	std::lock_guard<std::mutex> guard(queueLock);
+	if (queue.empty() || queue.front().deliverAt > LoopbackNetwork::Clock::now()) {
+		return false;
+	}
+	e = queue.front().event;
+	queue.pop_front();
+	if (e.type == Event_Disconnected && e.peerID < 0) {
+		peerID = -1; //the server has gone, so we're free to connect again
+	}
+	return true;
+}
+
+void LoopbackTransport::ReleaseEvent(const NetworkEvent& e) {
+	delete[] e.data;
+}
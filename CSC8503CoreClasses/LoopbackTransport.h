@@ -0,0 +1,92 @@
+#pragma once
+#include "NetworkTransport.h"
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <random>
+
+namespace NCL {
+	namespace CSC8503 {
+		class LoopbackTransport;
+
+		/*
+		A pretend network, entirely inside one process - one server, and as many
+		clients as it has room for, passing packets straight between each other's
+		queues. It's for running a GameServer and lots of GameClients without any
+		sockets, such as in the load tester, so it can also hold packets back for a
+		while, or lose some of them, to look a bit more like a real network.
+
+		It keeps count of everything that goes between the server and each client,
+		including anything it then loses, so those are what the server really sent.
+		Transports can be used from different threads, as long as each one is only
+		used by one thread at a time.
+		*/
+		class LoopbackNetwork	{
+		public:
+			LoopbackNetwork(int maxClients);
+			~LoopbackNetwork();
+
+			//Each way, in seconds
+			void SetLatency(float seconds);
+			void SetPacketLoss(float chance);
+
+			struct PeerStats {
+				size_t	bytesToClient		= 0;
+				size_t	packetsToClient		= 0;
+				size_t	bytesFromClient		= 0;
+				size_t	packetsFromClient	= 0;
+			};
+			PeerStats	GetStats(int peerID) const;
+			int			GetClientCount() const;
+
+		protected:
+			friend class LoopbackTransport;
+			typedef std::chrono::steady_clock Clock;
+
+			bool	Listen(LoopbackTransport* t);
+			int		Connect(LoopbackTransport* t);
+			void	Disconnect(LoopbackTransport* t);
+			bool	Send(LoopbackTransport* from, int peerID, const GamePacket& packet);
+
+			void Post(LoopbackTransport* to, int type, int peerID, const GamePacket* packet = nullptr);
+
+			mutable std::mutex	lock;
+			LoopbackTransport*	server;
+			std::vector<LoopbackTransport*>	clients;	//by peer ID
+			std::vector<PeerStats>			stats;
+
+			Clock::duration						latency;
+			float								packetLoss;
+			std::mt19937						random;
+			std::uniform_real_distribution<float>	lossRoll;
+		};
+
+		class LoopbackTransport : public NetworkTransport	{
+		public:
+			//Servers should listen - clients then connect to them by calling Connect, with any address
+			LoopbackTransport(LoopbackNetwork& network, bool listen = false);
+			~LoopbackTransport();
+
+			bool Connect(uint32_t address, int port) override;
+			bool Send(int peerID, const GamePacket& packet) override;
+			bool PopEvent(NetworkEvent& e) override;
+			void ReleaseEvent(const NetworkEvent& e) override;
+
+		protected:
+			friend class LoopbackNetwork;
+
+			struct QueuedEvent {
+				NetworkEvent					event;
+				LoopbackNetwork::Clock::time_point	deliverAt;
+			};
+
+			LoopbackNetwork&	network;
+			int					peerID;	//for clients, which peer the server knows us as - only ever used by the client's own thread
+
+			std::mutex				queueLock;
+			std::deque<QueuedEvent>	queue;
+		};
+	}
+}
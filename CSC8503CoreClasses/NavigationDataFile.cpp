@@ -0,0 +1,182 @@
+#include "NavigationDataFile.h"
+#include "Assets.h"
+
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace NCL;
+using namespace CSC8503;
+
+const size_t CHUNK_ALIGNMENT = 16;
+
+NavigationDataFile::NavigationDataFile() {
+	data		= nullptr;
+	dataSize	= 0;
+#ifdef _WIN32
+	fileHandle		= INVALID_HANDLE_VALUE;
+	mappingHandle	= nullptr;
+#else
+	fileDescriptor	= -1;
+#endif
+}
+
+NavigationDataFile::~NavigationDataFile() {
+	Close();
+}
+
+bool NavigationDataFile::Open(const std::string& filename) {
+	Close();
+	std::string path = Assets::DATADIR + filename;
+
+#ifdef _WIN32
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+		Close();
+		return false;
+	}
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle) {
+		Close();
+		return false;
+	}
+	data		= (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	dataSize	= (size_t)fileSize.QuadPart;
+#else
+	fileDescriptor = open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0) {
+		return false;
+	}
+	struct stat fileInfo;
+	if (fstat(fileDescriptor, &fileInfo) != 0 || fileInfo.st_size == 0) {
+		Close();
+		return false;
+	}
+	void* mapping = mmap(nullptr, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (mapping == MAP_FAILED) {
+		Close();
+		return false;
+	}
+	data		= (const char*)mapping;
+	dataSize	= (size_t)fileInfo.st_size;
+#endif
+	if (!data) {
+		Close();
+		return false;
+	}
+
+	const NavDataHeader* header = (const NavDataHeader*)data;
+	if (dataSize < sizeof(NavDataHeader) ||
+		header->magic != NAVDATA_MAGIC ||
+		header->version != NAVDATA_VERSION ||
+		dataSize < sizeof(NavDataHeader) + (header->chunkCount * sizeof(NavDataChunk))) {
+		std::cout << __FUNCTION__ << ": " << filename << " is not a valid navigation data file!\n";
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void NavigationDataFile::Close() {
+#ifdef _WIN32
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle) {
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(fileHandle);
+	}
+	fileHandle		= INVALID_HANDLE_VALUE;
+	mappingHandle	= nullptr;
+#else
+	if (data) {
+		munmap((void*)data, dataSize);
+	}
+	if (fileDescriptor >= 0) {
+		close(fileDescriptor);
+	}
+	fileDescriptor = -1;
+#endif
+	data		= nullptr;
+	dataSize	= 0;
+}
+
+const char* NavigationDataFile::GetChunk(NavDataChunkType type, size_t& size) const {
+	if (!data) {
+		return nullptr;
+	}
+	const NavDataHeader* header	= (const NavDataHeader*)data;
+	const NavDataChunk* chunks	= (const NavDataChunk*)(data + sizeof(NavDataHeader));
+
+	for (uint32_t i = 0; i < header->chunkCount; ++i) {
+		if (chunks[i].type != type) {
+			continue;
+		}
+		if ((size_t)chunks[i].offset + chunks[i].size > dataSize) {
+			return nullptr; //truncated file!
+		}
+		if (chunks[i].offset % CHUNK_ALIGNMENT != 0) {
+			return nullptr; //the loaders read straight out of the chunk, so it has to be aligned
+		}
+		size = chunks[i].size;
+		return data + chunks[i].offset;
+	}
+	return nullptr;
+}
+
+std::vector<char>& NavigationDataWriter::AddChunk(NavDataChunkType type) {
+	chunks.push_back({ type, std::vector<char>() });
+	return chunks.back().second;
+}
+
+bool NavigationDataWriter::Save(const std::string& filename) const {
+	std::ofstream file(Assets::DATADIR + filename, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	auto Aligned = [](size_t offset) {
+		return (offset + CHUNK_ALIGNMENT - 1) & ~(CHUNK_ALIGNMENT - 1);
+	};
+
+	NavDataHeader header;
+	header.magic		= NAVDATA_MAGIC;
+	header.version		= NAVDATA_VERSION;
+	header.chunkCount	= (uint32_t)chunks.size();
+	header.flags		= 0;
+	file.write((const char*)&header, sizeof(header));
+
+	size_t offset = Aligned(sizeof(NavDataHeader) + (chunks.size() * sizeof(NavDataChunk)));
+	for (const auto& c : chunks) {
+		NavDataChunk entry;
+		entry.type		= c.first;
+		entry.offset	= (uint32_t)offset;
+		entry.size		= (uint32_t)c.second.size();
+		entry.reserved	= 0;
+		file.write((const char*)&entry, sizeof(entry));
+		offset = Aligned(offset + c.second.size());
+	}
+
+	const char padding[CHUNK_ALIGNMENT] = { 0 };
+	size_t written = sizeof(NavDataHeader) + (chunks.size() * sizeof(NavDataChunk));
+	for (const auto& c : chunks) {
+		file.write(padding, Aligned(written) - written);
+		written = Aligned(written);
+		file.write(c.second.data(), c.second.size());
+		written += c.second.size();
+	}
+	return file.good();
+}
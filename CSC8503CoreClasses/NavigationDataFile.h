@@ -0,0 +1,164 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Compiled navigation data. Rather than parsing text and then working out all
+		of the links between nodes, a level's navigation data can be converted
+		offline into a single binary file, that is memory mapped at load time and
+		read straight out of the mapping.
+
+		The file is a header, then a table of chunks, then the chunks themselves,
+		each starting on a 16 byte boundary. Everything is stored little endian, in
+		32 bit ints and floats. A file can hold any mix of chunks - a grid, the HPA*
+		clusters built on top of that grid, and a navigation mesh.
+		*/
+		const uint32_t NAVDATA_MAGIC	= 0x4456414E;	//'NAVD'
+		const uint32_t NAVDATA_VERSION	= 1;
+
+		enum NavDataChunkType : uint32_t {
+			NavDataGrid			= 0x44495247,	//'GRID'
+			NavDataHierarchy	= 0x43415048,	//'HPAC'
+			NavDataMesh			= 0x4853454D,	//'MESH'
+		};
+
+		struct NavDataHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t chunkCount;
+			uint32_t flags;
+		};
+
+		struct NavDataChunk {
+			uint32_t type;
+			uint32_t offset;	//from the start of the file
+			uint32_t size;
+			uint32_t reserved;
+		};
+
+		/*
+		GRID: NavDataGridHeader, then for each node its type, then for each node the
+		4 indices of its connected neighbours (-1 if not connected), then for each
+		node its 4 costs. Neighbours are in the same order as GridNode::connected.
+		*/
+		struct NavDataGridHeader {
+			int32_t nodeSize;
+			int32_t width;
+			int32_t height;
+			int32_t reserved;
+		};
+
+		/*
+		HPAC: NavDataHierarchyHeader, then the borders, the node ID list for the
+		borders, the abstract nodes, and finally all of their edges. The clusters
+		themselves are just rectangles, so they're worked out from the cluster size.
+		*/
+		struct NavDataHierarchyHeader {
+			int32_t clusterSize;
+			int32_t clustersWide;
+			int32_t clustersHigh;
+			int32_t borderCount;
+			int32_t borderNodeCount;
+			int32_t nodeCount;
+			int32_t edgeCount;
+			int32_t reserved;
+		};
+		struct NavDataBorder {
+			int32_t clusterA;
+			int32_t clusterB;
+			int32_t firstNode;	//into the border node list
+			int32_t nodeCount;
+		};
+		struct NavDataAbstractNode {
+			int32_t gridIndex;
+			int32_t cluster;
+			int32_t firstEdge;
+			int32_t edgeCount;
+		};
+		struct NavDataAbstractEdge {
+			int32_t to;
+			float	cost;
+			int32_t inter;
+			int32_t reserved;
+		};
+
+		/*
+		MESH: NavDataMeshHeader, then the vertices, the triangles, then the start
+		offsets and triangle lists for the triangle lookup grid.
+		*/
+		struct NavDataMeshHeader {
+			int32_t vertexCount;
+			int32_t triCount;
+			int32_t lookupWidth;
+			int32_t lookupHeight;
+			float	lookupMin[3];
+			float	lookupCellSize;
+			int32_t lookupTriCount;
+			int32_t reserved[3];
+		};
+		struct NavDataVertex {
+			float position[3];
+		};
+		struct NavDataTri {
+			int32_t indices[3];
+			int32_t neighbours[3];
+			int32_t portals[3][2];
+			float	planeNormal[3];
+			float	planeDistance;
+			float	centroid[3];
+			float	area;
+		};
+
+		class NavigationDataFile	{
+		public:
+			NavigationDataFile();
+			~NavigationDataFile();
+
+			bool Open(const std::string& filename); //relative to Assets::DATADIR, like the text formats
+			void Close();
+
+			bool IsOpen() const {
+				return data != nullptr;
+			}
+
+			//Returns nullptr if the file doesn't contain this chunk
+			const char* GetChunk(NavDataChunkType type, size_t& size) const;
+
+		protected:
+			const char*	data;
+			size_t		dataSize;
+#ifdef _WIN32
+			void*		fileHandle;
+			void*		mappingHandle;
+#else
+			int			fileDescriptor;
+#endif
+		};
+
+		class NavigationDataWriter	{
+		public:
+			NavigationDataWriter() {}
+			~NavigationDataWriter() {}
+
+			std::vector<char>& AddChunk(NavDataChunkType type);
+
+			template<class T>
+			static void Write(std::vector<char>& chunk, const T* items, size_t count) {
+				const char* bytes = (const char*)items;
+				chunk.insert(chunk.end(), bytes, bytes + (sizeof(T) * count));
+			}
+			template<class T>
+			static void Write(std::vector<char>& chunk, const T& item) {
+				Write(chunk, &item, 1);
+			}
+
+			bool Save(const std::string& filename) const; //relative to Assets::DATADIR
+
+		protected:
+			std::vector<std::pair<NavDataChunkType, std::vector<char>>> chunks;
+		};
+	}
+}
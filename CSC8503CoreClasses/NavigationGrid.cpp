@@ -2,6 +2,8 @@
 #include "Assets.h"
 
 #include <fstream>
+#include <algorithm>
+#include <cmath>
 
 using namespace NCL;
 using namespace CSC8503;
@@ -19,23 +21,128 @@ NavigationGrid::NavigationGrid()	{
 	gridWidth	= 0;
 	gridHeight	= 0;
 	allNodes	= nullptr;
+	nextListenerID	= 0;
+	editDepth		= 0;
 }
 
 NavigationGrid::NavigationGrid(const std::string&filename) : NavigationGrid() {
 	std::ifstream infile(Assets::DATADIR + filename);
 
-	infile >> nodeSize;
-	infile >> gridWidth;
-	infile >> gridHeight;
+	int size	= 0;
+	int width	= 0;
+	int height	= 0;
+
+	infile >> size;
+	infile >> width;
+	infile >> height;
+
+	std::vector<char> types(width * height);
+	for (char& t : types) {
+		infile >> t;
+	}
+	BuildNodes(size, width, height, types.data());
+}
+
+NavigationGrid::NavigationGrid(int nodeSize, int width, int height, const char* types) : NavigationGrid() {
+	BuildNodes(nodeSize, width, height, types);
+}
+
+/*
+Loads a grid from compiled navigation data - the links between nodes are
+already in there, so there's no need to work them out again. Nothing in the
+file is trusted: if the sizes or any of the links don't make sense, the grid
+is left empty (GetNodeCount returns 0), and should be built from its text
+file instead.
+*/
+NavigationGrid::NavigationGrid(const NavigationDataFile& file) : NavigationGrid() {
+	size_t chunkSize = 0;
+	const char* chunk = file.GetChunk(NavDataGrid, chunkSize);
+	if (!chunk || chunkSize < sizeof(NavDataGridHeader)) {
+		return;
+	}
+	const NavDataGridHeader* header = (const NavDataGridHeader*)chunk;
+	if (header->nodeSize <= 0 || header->width <= 0 || header->height <= 0) {
+		return;
+	}
+	//Divided rather than multiplied, so a huge width / height can't overflow its way past this
+	size_t nodeCount = (size_t)header->width * header->height;
+	if ((chunkSize - sizeof(NavDataGridHeader)) / (sizeof(int32_t) * 9) < nodeCount) {
+		return;
+	}
+	const int32_t* types	= (const int32_t*)(chunk + sizeof(NavDataGridHeader));
+	const int32_t* links	= types + nodeCount;
+	const int32_t* costs	= links + (nodeCount * 4);
+
+	for (size_t i = 0; i < nodeCount * 4; ++i) {
+		if (links[i] < -1 || links[i] >= (int64_t)nodeCount) {
+			return;
+		}
+	}
+	nodeSize	= header->nodeSize;
+	gridWidth	= header->width;
+	gridHeight	= header->height;
+
+	allNodes = new GridNode[nodeCount];
+
+	for (size_t i = 0; i < nodeCount; ++i) {
+		GridNode& n = allNodes[i];
+		int x = (int)(i % gridWidth);
+		int y = (int)(i / gridWidth);
+
+		n.type		= types[i];
+		n.position	= Vector3((float)(x * nodeSize), 0, (float)(y * nodeSize));
+		for (int j = 0; j < 4; ++j) {
+			int32_t link	= links[(i * 4) + j];
+			n.connected[j]	= link >= 0 ? &allNodes[link] : nullptr;
+			n.costs[j]		= costs[(i * 4) + j];
+		}
+	}
+}
+
+void NavigationGrid::WriteNavData(NavigationDataWriter& writer) const {
+	std::vector<char>& chunk = writer.AddChunk(NavDataGrid);
+
+	NavDataGridHeader header;
+	header.nodeSize = nodeSize;
+	header.width	= gridWidth;
+	header.height	= gridHeight;
+	header.reserved = 0;
+	NavigationDataWriter::Write(chunk, header);
+
+	int nodeCount = GetNodeCount();
+	std::vector<int32_t> values(nodeCount);
+	for (int i = 0; i < nodeCount; ++i) {
+		values[i] = allNodes[i].type;
+	}
+	NavigationDataWriter::Write(chunk, values.data(), values.size());
+
+	values.resize(nodeCount * 4);
+	for (int i = 0; i < nodeCount; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			values[(i * 4) + j] = allNodes[i].connected[j] ? (int32_t)(allNodes[i].connected[j] - allNodes) : -1;
+		}
+	}
+	NavigationDataWriter::Write(chunk, values.data(), values.size());
+
+	for (int i = 0; i < nodeCount; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			values[(i * 4) + j] = allNodes[i].costs[j];
+		}
+	}
+	NavigationDataWriter::Write(chunk, values.data(), values.size());
+}
+
+void NavigationGrid::BuildNodes(int size, int width, int height, const char* types) {
+	nodeSize	= size;
+	gridWidth	= width;
+	gridHeight	= height;
 
 	allNodes = new GridNode[gridWidth * gridHeight];
 
 	for (int y = 0; y < gridHeight; ++y) {
 		for (int x = 0; x < gridWidth; ++x) {
 			GridNode&n = allNodes[(gridWidth * y) + x];
-			char type = 0;
-			infile >> type;
-			n.type = type;
+			n.type = types[(gridWidth * y) + x];
 			n.position = Vector3((float)(x * nodeSize), 0, (float)(y * nodeSize));
 		}
 	}
@@ -43,31 +150,183 @@ NavigationGrid::NavigationGrid(const std::string&filename) : NavigationGrid() {
 	//now to build the connectivity between the nodes
 	for (int y = 0; y < gridHeight; ++y) {
 		for (int x = 0; x < gridWidth; ++x) {
-			GridNode&n = allNodes[(gridWidth * y) + x];		
+			ConnectNode(x, y);
+		}	
+	}
+}
 
-			if (y > 0) { //get the above node
-				n.connected[0] = &allNodes[(gridWidth * (y - 1)) + x];
-			}
-			if (y < gridHeight - 1) { //get the below node
-				n.connected[1] = &allNodes[(gridWidth * (y + 1)) + x];
-			}
-			if (x > 0) { //get left node
-				n.connected[2] = &allNodes[(gridWidth * (y)) + (x - 1)];
-			}
-			if (x < gridWidth - 1) { //get right node
-				n.connected[3] = &allNodes[(gridWidth * (y)) + (x + 1)];
+void NavigationGrid::ConnectNode(int x, int y) {
+	GridNode&n = allNodes[(gridWidth * y) + x];
+
+	for (int i = 0; i < 4; ++i) {
+		n.connected[i]	= nullptr;
+		n.costs[i]		= 0;
+	}
+	if (y > 0) { //get the above node
+		n.connected[0] = &allNodes[(gridWidth * (y - 1)) + x];
+	}
+	if (y < gridHeight - 1) { //get the below node
+		n.connected[1] = &allNodes[(gridWidth * (y + 1)) + x];
+	}
+	if (x > 0) { //get left node
+		n.connected[2] = &allNodes[(gridWidth * (y)) + (x - 1)];
+	}
+	if (x < gridWidth - 1) { //get right node
+		n.connected[3] = &allNodes[(gridWidth * (y)) + (x + 1)];
+	}
+	for (int i = 0; i < 4; ++i) {
+		if (n.connected[i]) {
+			if (n.connected[i]->type == '.') {
+				n.costs[i]		= 1;
 			}
-			for (int i = 0; i < 4; ++i) {
-				if (n.connected[i]) {
-					if (n.connected[i]->type == '.') {
-						n.costs[i]		= 1;
-					}
-					if (n.connected[i]->type == 'x') {
-						n.connected[i] = nullptr; //actually a wall, disconnect!
-					}
-				}
+			if (n.connected[i]->type == 'x') {
+				n.connected[i] = nullptr; //actually a wall, disconnect!
 			}
-		}	
+		}
+	}
+}
+
+void NavigationGrid::SetNodeType(int x, int y, int type) {
+	if (x < 0 || x > gridWidth - 1 ||
+		y < 0 || y > gridHeight - 1) {
+		return;
+	}
+	int index = (gridWidth * y) + x;
+	if (allNodes[index].type == type) {
+		return;
+	}
+	pendingEdits.insert({ index, allNodes[index].type }); //keeps the type from before the first edit
+	allNodes[index].type = type;
+
+	if (editDepth == 0) {
+		ApplyEdits();
+	}
+}
+
+void NavigationGrid::BeginEdit() {
+	editDepth++;
+}
+
+void NavigationGrid::EndEdit() {
+	if (editDepth > 0 && --editDepth == 0) {
+		ApplyEdits();
+	}
+}
+
+/*
+Changing a node's type can change whether its neighbours can step onto it, so
+their links need patching up, too - as does the JPS+ table around it, if there
+is one (see UpdateJumpPointTable). Nodes that were changed and then changed
+back again during the batch are left out.
+*/
+void NavigationGrid::ApplyEdits() {
+	std::vector<int> changed;
+	for (auto& e : pendingEdits) {
+		if (allNodes[e.first].type != e.second) {
+			changed.emplace_back(e.first);
+		}
+	}
+	pendingEdits.clear();
+	if (changed.empty()) {
+		return;
+	}
+	for (int node : changed) {
+		int x = node % gridWidth;
+		int y = node / gridWidth;
+		ConnectNode(x, y);
+		if (y > 0)				{ ConnectNode(x, y - 1); }
+		if (y < gridHeight - 1) { ConnectNode(x, y + 1); }
+		if (x > 0)				{ ConnectNode(x - 1, y); }
+		if (x < gridWidth - 1)	{ ConnectNode(x + 1, y); }
+	}
+	UpdateJumpPointTable(changed);
+
+	for (auto& l : changeListeners) {
+		l.second(changed);
+	}
+}
+
+void NavigationGrid::AddBlocker(int x, int y) {
+	if (x < 0 || x > gridWidth - 1 ||
+		y < 0 || y > gridHeight - 1) {
+		return;
+	}
+	int index = (gridWidth * y) + x;
+	auto i = blockers.find(index);
+	if (i != blockers.end()) {
+		i->second.count++;
+		return;
+	}
+	blockers[index] = { 1, allNodes[index].type };
+	SetNodeType(x, y, WALL_NODE);
+}
+
+void NavigationGrid::RemoveBlocker(int x, int y) {
+	auto i = blockers.find((gridWidth * y) + x);
+	if (i == blockers.end()) {
+		return;
+	}
+	if (--i->second.count > 0) {
+		return;
+	}
+	int type = i->second.originalType;
+	blockers.erase(i);
+	SetNodeType(x, y, type);
+}
+
+//Works out which nodes a world space box covers, looking down from above
+bool NavigationGrid::GetNodeRect(const Vector3& boundsMin, const Vector3& boundsMax, GridRect& outRect) const {
+	if (nodeSize <= 0) {
+		return false;
+	}
+	//the same mapping from positions to nodes as GetNodeIndex
+	outRect.minX = std::max(0, (int)std::floor(boundsMin.x / nodeSize));
+	outRect.minY = std::max(0, (int)std::floor(boundsMin.z / nodeSize));
+	outRect.maxX = std::min(gridWidth - 1,	(int)std::floor(boundsMax.x / nodeSize));
+	outRect.maxY = std::min(gridHeight - 1, (int)std::floor(boundsMax.z / nodeSize));
+
+	return outRect.minX <= outRect.maxX && outRect.minY <= outRect.maxY;
+}
+
+void NavigationGrid::AddBlocker(const Vector3& boundsMin, const Vector3& boundsMax) {
+	GridRect r;
+	if (!GetNodeRect(boundsMin, boundsMax, r)) {
+		return;
+	}
+	BeginEdit();
+	for (int y = r.minY; y <= r.maxY; ++y) {
+		for (int x = r.minX; x <= r.maxX; ++x) {
+			AddBlocker(x, y);
+		}
+	}
+	EndEdit();
+}
+
+void NavigationGrid::RemoveBlocker(const Vector3& boundsMin, const Vector3& boundsMax) {
+	GridRect r;
+	if (!GetNodeRect(boundsMin, boundsMax, r)) {
+		return;
+	}
+	BeginEdit();
+	for (int y = r.minY; y <= r.maxY; ++y) {
+		for (int x = r.minX; x <= r.maxX; ++x) {
+			RemoveBlocker(x, y);
+		}
+	}
+	EndEdit();
+}
+
+int NavigationGrid::AddChangeListener(GridChangeListener listener) {
+	changeListeners.push_back({ nextListenerID, listener });
+	return nextListenerID++;
+}
+
+void NavigationGrid::RemoveChangeListener(int listenerID) {
+	for (auto i = changeListeners.begin(); i != changeListeners.end(); ++i) {
+		if (i->first == listenerID) {
+			changeListeners.erase(i);
+			return;
+		}
 	}
 }
 
@@ -76,101 +335,527 @@ NavigationGrid::~NavigationGrid()	{
 }
 
 bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
-	//need to work out which node 'from' sits in, and 'to' sits in
-	int fromX = ((int)from.x / nodeSize);
-	int fromZ = ((int)from.z / nodeSize);
+	return FindPath(from, to, outPath, scratch);
+}
 
-	int toX = ((int)to.x / nodeSize);
-	int toZ = ((int)to.z / nodeSize);
+int NavigationGrid::GetNodeIndex(const Vector3& position) const {
+	if (nodeSize <= 0) {
+		return -1;
+	}
+	int x = ((int)position.x / nodeSize);
+	int z = ((int)position.z / nodeSize);
 
-	if (fromX < 0 || fromX > gridWidth - 1 ||
-		fromZ < 0 || fromZ > gridHeight - 1) {
-		return false; //outside of map region!
+	if (x < 0 || x > gridWidth - 1 ||
+		z < 0 || z > gridHeight - 1) {
+		return -1; //outside of map region!
 	}
+	return (z * gridWidth) + x;
+}
 
-	if (toX < 0 || toX > gridWidth - 1 ||
-		toZ < 0 || toZ > gridHeight - 1) {
+bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, GridSearchScratch& s, GridSearchMode mode) const {
+	//need to work out which node 'from' sits in, and 'to' sits in
+	int startIndex	= GetNodeIndex(from);
+	int endIndex	= GetNodeIndex(to);
+
+	if (startIndex < 0 || endIndex < 0) {
 		return false; //outside of map region!
 	}
 
-	GridNode* startNode = &allNodes[(fromZ * gridWidth) + fromX];
-	GridNode* endNode	= &allNodes[(toZ * gridWidth) + toX];
+	bool found = false;
+	if (mode == AStarSearch) {
+		GridRect bounds = { 0, 0, gridWidth - 1, gridHeight - 1 };
+		found = SearchNodes(startIndex, endIndex, bounds, s);
+	}
+	else {
+		found = JumpPointSearchNodes(startIndex, endIndex, s, mode == JumpPointPlusSearch && !jumpDistances.empty());
+	}
+	if (!found) {
+		return false;
+	}
+	int node = endIndex;
+	while (node >= 0) {
+		outPath.PushWaypoint(allNodes[node].position);
+		node = s.parent[node];
+	}
+	return true;
+}
 
-	std::vector<GridNode*>  openList;
-	std::vector<GridNode*>  closedList;
+/*
+The actual A* search, which can be limited to a sub-rectangle of the grid. If it
+succeeds, the route can be read back by following scratch.parent from endIndex,
+and scratch.g[endIndex] holds its total cost.
+*/
+bool NavigationGrid::SearchNodes(int startIndex, int endIndex, const GridRect& bounds, GridSearchScratch& s) const {
+	const int offsetX[4] = { 0, 0, -1, 1 };	//matches the order of GridNode::connected
+	const int offsetY[4] = { -1, 1, 0, 0 };
 
-	openList.push_back(startNode);
+	const GridNode* endNode = &allNodes[endIndex];
 
-	startNode->f = 0;
-	startNode->g = 0;
-	startNode->parent = nullptr;
+	BeginSearch(s);
 
-	GridNode* currentBestNode = nullptr;
+	s.generation[startIndex]	= s.currentGeneration;
+	s.g[startIndex]				= 0;
+	s.f[startIndex]				= 0;
+	s.parent[startIndex]		= -1;
+	HeapPush(s, startIndex);
 
-	while (!openList.empty()) {
-		currentBestNode = RemoveBestNode(openList);
+	while (!s.heap.empty()) {
+		int current = HeapPop(s);
 
-		if (currentBestNode == endNode) {			//we've found the path!
-			GridNode* node = endNode;
-			while (node != nullptr) {
-				outPath.PushWaypoint(node->position);
-				node = node->parent;
-			}
+		if (current == endIndex) {			//we've found the path!
 			return true;
 		}
-		else {
-			for (int i = 0; i < 4; ++i) {
-				GridNode* neighbour = currentBestNode->connected[i];
-				if (!neighbour) { //might not be connected...
-					continue;
-				}	
-				bool inClosed	= NodeInList(neighbour, closedList);
-				if (inClosed) {
-					continue; //already discarded this neighbour...
-				}
+		if (s.closed[current >> 6] == 0) {
+			s.closedWords.emplace_back(current >> 6);
+		}
+		s.closed[current >> 6] |= (uint64_t)1 << (current & 63);
 
-				float h = Heuristic(neighbour, endNode);				
-				float g = currentBestNode->g + currentBestNode->costs[i];
-				float f = h + g;
+		const GridNode& currentNode = allNodes[current];
+		int x = current % gridWidth;
+		int y = current / gridWidth;
 
-				bool inOpen		= NodeInList(neighbour, openList);
+		for (int i = 0; i < 4; ++i) {
+			const GridNode* neighbour = currentNode.connected[i];
+			if (!neighbour) { //might not be connected...
+				continue;
+			}
+			int nx = x + offsetX[i];
+			int ny = y + offsetY[i];
+			if (nx < bounds.minX || nx > bounds.maxX ||
+				ny < bounds.minY || ny > bounds.maxY) {
+				continue;
+			}
+			int n = (int)(neighbour - allNodes);
 
-				if (!inOpen) { //first time we've seen this neighbour
-					openList.emplace_back(neighbour);
-				}
-				if (!inOpen || f < neighbour->f) {//might be a better route to this neighbour
-					neighbour->parent = currentBestNode;
-					neighbour->f = f;
-					neighbour->g = g;
-				}
+			if (s.closed[n >> 6] & ((uint64_t)1 << (n & 63))) {
+				continue; //already discarded this neighbour...
+			}
+
+			float g = s.g[current] + currentNode.costs[i];
+
+			if (s.generation[n] != s.currentGeneration) { //first time we've seen this neighbour
+				s.generation[n]	= s.currentGeneration;
+				s.g[n]			= g;
+				s.f[n]			= g + Heuristic(neighbour, endNode);
+				s.parent[n]		= current;
+				HeapPush(s, n);
+			}
+			else if (g < s.g[n]) {//a better route to this neighbour
+				s.f[n]		= g + (s.f[n] - s.g[n]);	//h doesn't change, so no need to recalculate it
+				s.g[n]		= g;
+				s.parent[n]	= current;
+				HeapSiftUp(s, s.heapIndex[n]);
 			}
-			closedList.emplace_back(currentBestNode);
 		}
 	}
 	return false; //open list emptied out with no path!
 }
 
-bool NavigationGrid::NodeInList(GridNode* n, std::vector<GridNode*>& list) const {
-	std::vector<GridNode*>::iterator i = std::find(list.begin(), list.end(), n);
-	return i == list.end() ? false : true;
+void NavigationGrid::BeginSearch(GridSearchScratch& s) const {
+	size_t nodeCount = (size_t)GetNodeCount();
+
+	if (s.generation.size() != nodeCount) {
+		s.g.resize(nodeCount);
+		s.f.resize(nodeCount);
+		s.parent.resize(nodeCount);
+		s.heapIndex.resize(nodeCount);
+		s.generation.assign(nodeCount, 0);
+		s.closed.assign((nodeCount + 63) / 64, 0);
+		s.closedWords.clear();
+		s.currentGeneration = 0;
+	}
+	s.currentGeneration++;
+	if (s.currentGeneration == 0) { //wrapped around, so old stamps might look current
+		std::fill(s.generation.begin(), s.generation.end(), 0);
+		s.currentGeneration = 1;
+	}
+	for (int w : s.closedWords) {
+		s.closed[w] = 0;
+	}
+	s.closedWords.clear();
+	s.heap.clear();
 }
 
-GridNode*  NavigationGrid::RemoveBestNode(std::vector<GridNode*>& list) const {
-	std::vector<GridNode*>::iterator bestI = list.begin();
+void NavigationGrid::HeapPush(GridSearchScratch& s, int node) const {
+	s.heap.push_back(node);
+	s.heapIndex[node] = (int)s.heap.size() - 1;
+	HeapSiftUp(s, (int)s.heap.size() - 1);
+}
 
-	GridNode* bestNode = *list.begin();
+int NavigationGrid::HeapPop(GridSearchScratch& s) const {
+	int best = s.heap[0];
+	int last = s.heap.back();
+	s.heap.pop_back();
 
-	for (auto i = list.begin(); i != list.end(); ++i) {
-		if ((*i)->f < bestNode->f) {
-			bestNode	= (*i);
-			bestI		= i;
+	if (!s.heap.empty()) {
+		s.heap[0]			= last;
+		s.heapIndex[last]	= 0;
+		HeapSiftDown(s, 0);
+	}
+	return best;
+}
+
+void NavigationGrid::HeapSiftUp(GridSearchScratch& s, int pos) const {
+	int node = s.heap[pos];
+	float f  = s.f[node];
+
+	while (pos > 0) {
+		int parentPos = (pos - 1) / 2;
+		int parent = s.heap[parentPos];
+		if (s.f[parent] <= f) {
+			break;
 		}
+		s.heap[pos]			= parent;
+		s.heapIndex[parent] = pos;
+		pos = parentPos;
 	}
-	list.erase(bestI);
+	s.heap[pos]			= node;
+	s.heapIndex[node]	= pos;
+}
 
-	return bestNode;
+void NavigationGrid::HeapSiftDown(GridSearchScratch& s, int pos) const {
+	int count	= (int)s.heap.size();
+	int node	= s.heap[pos];
+	float f		= s.f[node];
+
+	while (true) {
+		int child = (pos * 2) + 1;
+		if (child >= count) {
+			break;
+		}
+		if (child + 1 < count && s.f[s.heap[child + 1]] < s.f[s.heap[child]]) {
+			child++;
+		}
+		if (f <= s.f[s.heap[child]]) {
+			break;
+		}
+		s.heap[pos]					= s.heap[child];
+		s.heapIndex[s.heap[pos]]	= pos;
+		pos = child;
+	}
+	s.heap[pos]			= node;
+	s.heapIndex[node]	= pos;
 }
 
-float NavigationGrid::Heuristic(GridNode* hNode, GridNode* endNode) const {
+float NavigationGrid::Heuristic(const GridNode* hNode, const GridNode* endNode) const {
 	return Vector::Length(hNode->position - endNode->position);
-}
\ No newline at end of file
+}
+
+/*
+Jump Point Search - on a uniform cost 8-connected grid, most of the nodes A* would
+put on the open list are just different orderings of the same moves. JPS instead
+'jumps' along straight and diagonal lines without adding anything, only stopping
+at nodes where the walls force a change of direction (or at the goal). Diagonal
+moves may not cut corners, so both of the orthogonal nodes must be open, too.
+
+The resulting path only contains these jump points, which are all joined by
+straight or 45 degree lines.
+*/
+const int JUMP_DIRECTIONS	= 8;
+const int jumpOffsetX[JUMP_DIRECTIONS] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+const int jumpOffsetY[JUMP_DIRECTIONS] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+
+static int JumpDirection(int dx, int dy) {
+	for (int i = 0; i < JUMP_DIRECTIONS; ++i) {
+		if (jumpOffsetX[i] == dx && jumpOffsetY[i] == dy) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int Sign(int v) {
+	return (v > 0) - (v < 0);
+}
+
+bool NavigationGrid::Walkable(int x, int y) const {
+	if (x < 0 || x > gridWidth - 1 ||
+		y < 0 || y > gridHeight - 1) {
+		return false;
+	}
+	return allNodes[(gridWidth * y) + x].type != WALL_NODE;
+}
+
+bool NavigationGrid::CanStep(int x, int y, int dx, int dy) const {
+	if (!Walkable(x + dx, y + dy)) {
+		return false;
+	}
+	if (dx != 0 && dy != 0) { //no cutting corners!
+		return Walkable(x + dx, y) && Walkable(x, y + dy);
+	}
+	return true;
+}
+
+//Does entering (x,y) travelling in (dx,dy) uncover a neighbour we couldn't have reached any other way?
+bool NavigationGrid::HasForcedNeighbour(int x, int y, int dx, int dy) const {
+	if (dx != 0) {
+		return	(Walkable(x, y - 1) && !Walkable(x - dx, y - 1)) ||
+				(Walkable(x, y + 1) && !Walkable(x - dx, y + 1));
+	}
+	return	(Walkable(x - 1, y) && !Walkable(x - 1, y - dy)) ||
+			(Walkable(x + 1, y) && !Walkable(x + 1, y - dy));
+}
+
+int NavigationGrid::Jump(int x, int y, int dx, int dy, int endIndex) const {
+	while (CanStep(x, y, dx, dy)) {
+		x += dx;
+		y += dy;
+
+		int index = (gridWidth * y) + x;
+		if (index == endIndex) {
+			return index;
+		}
+		if (dx != 0 && dy != 0) {
+			if (Jump(x, y, dx, 0, endIndex) >= 0 || Jump(x, y, 0, dy, endIndex) >= 0) {
+				return index;
+			}
+		}
+		else if (HasForcedNeighbour(x, y, dx, dy)) {
+			return index;
+		}
+	}
+	return -1;
+}
+
+/*
+JPS+ looks the jumps up instead - the distance is positive if there's a jump point
+that many steps away, or zero / negative if there's a wall that many steps away.
+Since the table knows nothing about the goal, we have to check whether the goal
+lies along (or, for diagonals, in line with somewhere along) each jump ourselves.
+*/
+int NavigationGrid::JumpPlus(int x, int y, int direction, int endIndex) const {
+	int distance	= jumpDistances[(((gridWidth * y) + x) * JUMP_DIRECTIONS) + direction];
+	int dx			= jumpOffsetX[direction];
+	int dy			= jumpOffsetY[direction];
+
+	int goalX		= endIndex % gridWidth;
+	int goalY		= endIndex / gridWidth;
+	int reach		= abs(distance);
+
+	if (dx != 0 && dy != 0) {
+		if (Sign(goalX - x) == dx && Sign(goalY - y) == dy) {
+			int steps = std::min(abs(goalX - x), abs(goalY - y));
+			if (steps <= reach) { //a straight jump from here might hit the goal
+				return (gridWidth * (y + (dy * steps))) + x + (dx * steps);
+			}
+		}
+	}
+	else {
+		bool inLine = dx != 0	? (goalY == y && Sign(goalX - x) == dx)
+								: (goalX == x && Sign(goalY - y) == dy);
+		if (inLine && abs(goalX - x) + abs(goalY - y) <= reach) {
+			return endIndex;
+		}
+	}
+	if (distance <= 0) {
+		return -1;
+	}
+	return (gridWidth * (y + (dy * distance))) + x + (dx * distance);
+}
+
+//Works out one entry of the JPS+ table - the next node along must already be up to date
+int NavigationGrid::ComputeJumpDistance(int x, int y, int direction) const {
+	int dx = jumpOffsetX[direction];
+	int dy = jumpOffsetY[direction];
+
+	if (!Walkable(x, y) || !CanStep(x, y, dx, dy)) {
+		return 0;
+	}
+	int nx		= x + dx;
+	int ny		= y + dy;
+	int next	= ((gridWidth * ny) + nx) * JUMP_DIRECTIONS;
+
+	bool isJumpPoint = (dx != 0 && dy != 0)
+		? (jumpDistances[next + JumpDirection(dx, 0)] > 0 || jumpDistances[next + JumpDirection(0, dy)] > 0)
+		: HasForcedNeighbour(nx, ny, dx, dy);
+	if (isJumpPoint) {
+		return 1;
+	}
+	int d = jumpDistances[next + direction];
+	return d > 0 ? d + 1 : d - 1;
+}
+
+void NavigationGrid::BuildJumpPointTable() {
+	jumpDistances.assign(gridWidth * gridHeight * JUMP_DIRECTIONS, 0);
+
+	//Each direction is swept 'backwards', so the next node along has always been done already.
+	//The straight directions come first, as the diagonals are built from them
+	for (int dir = 0; dir < JUMP_DIRECTIONS; ++dir) {
+		int dx = jumpOffsetX[dir];
+		int dy = jumpOffsetY[dir];
+
+		for (int j = 0; j < gridHeight; ++j) {
+			int y = dy > 0 ? gridHeight - 1 - j : j;
+			for (int i = 0; i < gridWidth; ++i) {
+				int x = dx > 0 ? gridWidth - 1 - i : i;
+				jumpDistances[(((gridWidth * y) + x) * JUMP_DIRECTIONS) + dir] = ComputeJumpDistance(x, y, dir);
+			}
+		}
+	}
+}
+
+/*
+Patches the JPS+ table after some nodes have changed type, rather than
+building it all again. An entry only depends on the nodes right next to it,
+and on the entries of the next node along - so the patching starts at every
+node close enough to a change to see it, and works backwards along each
+direction from there, stopping as soon as an entry comes out the same as it
+was before. The diagonals also start behind any node whose straight entries
+changed, as that can move their jump points.
+*/
+void NavigationGrid::UpdateJumpPointTable(const std::vector<int>& changedNodes) {
+	if (jumpDistances.empty()) {
+		return;
+	}
+	std::vector<int> nearby;
+	for (int node : changedNodes) {
+		int x = node % gridWidth;
+		int y = node / gridWidth;
+		for (int oy = -1; oy <= 1; ++oy) {
+			for (int ox = -1; ox <= 1; ++ox) {
+				if (x + ox >= 0 && x + ox < gridWidth && y + oy >= 0 && y + oy < gridHeight) {
+					nearby.emplace_back((gridWidth * (y + oy)) + x + ox);
+				}
+			}
+		}
+	}
+	std::sort(nearby.begin(), nearby.end());
+	nearby.erase(std::unique(nearby.begin(), nearby.end()), nearby.end());
+
+	std::vector<int> straightChanged;
+	std::vector<int> starts;
+
+	for (int dir = 0; dir < JUMP_DIRECTIONS; ++dir) {
+		int dx = jumpOffsetX[dir];
+		int dy = jumpOffsetY[dir];
+		bool diagonal = dx != 0 && dy != 0;
+
+		starts = nearby;
+		if (diagonal) {
+			for (int node : straightChanged) {
+				int x = (node % gridWidth) - dx;
+				int y = (node / gridWidth) - dy;
+				if (x >= 0 && x < gridWidth && y >= 0 && y < gridHeight) {
+					starts.emplace_back((gridWidth * y) + x);
+				}
+			}
+		}
+		//Nodes further along the direction need doing first, just like in BuildJumpPointTable
+		std::sort(starts.begin(), starts.end(), [&](int a, int b) {
+			return ((a % gridWidth) * dx) + ((a / gridWidth) * dy) > ((b % gridWidth) * dx) + ((b / gridWidth) * dy);
+		});
+		for (int start : starts) {
+			int x = start % gridWidth;
+			int y = start / gridWidth;
+			while (x >= 0 && x < gridWidth && y >= 0 && y < gridHeight) {
+				int& entry		= jumpDistances[(((gridWidth * y) + x) * JUMP_DIRECTIONS) + dir];
+				int distance	= ComputeJumpDistance(x, y, dir);
+				if (distance == entry) {
+					break; //so nothing further back will change either
+				}
+				entry = distance;
+				if (!diagonal) {
+					straightChanged.emplace_back((gridWidth * y) + x);
+				}
+				x -= dx;
+				y -= dy;
+			}
+		}
+	}
+}
+
+float NavigationGrid::OctileDistance(int a, int b) const {
+	int dx = abs((a % gridWidth) - (b % gridWidth));
+	int dy = abs((a / gridWidth) - (b / gridWidth));
+	return (float)std::max(dx, dy) + (1.41421356f - 1.0f) * (float)std::min(dx, dy);
+}
+
+bool NavigationGrid::JumpPointSearchNodes(int startIndex, int endIndex, GridSearchScratch& s, bool usePrecomputed) const {
+	if (!Walkable(startIndex % gridWidth, startIndex / gridWidth)) {
+		return false;
+	}
+	BeginSearch(s);
+
+	s.generation[startIndex]	= s.currentGeneration;
+	s.g[startIndex]				= 0;
+	s.f[startIndex]				= 0;
+	s.parent[startIndex]		= -1;
+	HeapPush(s, startIndex);
+
+	int directions[JUMP_DIRECTIONS];
+
+	while (!s.heap.empty()) {
+		int current = HeapPop(s);
+
+		if (current == endIndex) {
+			return true;
+		}
+		if (s.closed[current >> 6] == 0) {
+			s.closedWords.emplace_back(current >> 6);
+		}
+		s.closed[current >> 6] |= (uint64_t)1 << (current & 63);
+
+		int x = current % gridWidth;
+		int y = current / gridWidth;
+
+		//Only the directions that the parent couldn't have reached more cheaply need exploring
+		int directionCount = 0;
+		int parent = s.parent[current];
+		if (parent < 0) {
+			for (int i = 0; i < JUMP_DIRECTIONS; ++i) {
+				directions[directionCount++] = i;
+			}
+		}
+		else {
+			int dx = Sign(x - (parent % gridWidth));
+			int dy = Sign(y - (parent / gridWidth));
+			if (dx != 0 && dy != 0) {
+				directions[directionCount++] = JumpDirection(dx, 0);
+				directions[directionCount++] = JumpDirection(0, dy);
+				directions[directionCount++] = JumpDirection(dx, dy);
+			}
+			else if (dx != 0) {
+				directions[directionCount++] = JumpDirection(dx, 0);
+				directions[directionCount++] = JumpDirection(dx, -1);
+				directions[directionCount++] = JumpDirection(dx, 1);
+				directions[directionCount++] = JumpDirection(0, -1);
+				directions[directionCount++] = JumpDirection(0, 1);
+			}
+			else {
+				directions[directionCount++] = JumpDirection(0, dy);
+				directions[directionCount++] = JumpDirection(-1, dy);
+				directions[directionCount++] = JumpDirection(1, dy);
+				directions[directionCount++] = JumpDirection(-1, 0);
+				directions[directionCount++] = JumpDirection(1, 0);
+			}
+		}
+
+		for (int i = 0; i < directionCount; ++i) {
+			int dir = directions[i];
+			int n = usePrecomputed	? JumpPlus(x, y, dir, endIndex)
+									: (CanStep(x, y, jumpOffsetX[dir], jumpOffsetY[dir]) ? Jump(x, y, jumpOffsetX[dir], jumpOffsetY[dir], endIndex) : -1);
+			if (n < 0) {
+				continue;
+			}
+			if (s.closed[n >> 6] & ((uint64_t)1 << (n & 63))) {
+				continue;
+			}
+			float g = s.g[current] + OctileDistance(current, n);
+
+			if (s.generation[n] != s.currentGeneration) {
+				s.generation[n]	= s.currentGeneration;
+				s.g[n]			= g;
+				s.f[n]			= g + OctileDistance(n, endIndex);
+				s.parent[n]		= current;
+				HeapPush(s, n);
+			}
+			else if (g < s.g[n]) {
+				s.f[n]		= g + (s.f[n] - s.g[n]);
+				s.g[n]		= g;
+				s.parent[n]	= current;
+				HeapSiftUp(s, s.heapIndex[n]);
+			}
+		}
+	}
+	return false;
+}
@@ -1,19 +1,19 @@
 #pragma once
 #include "NavigationMap.h"
+#include "NavigationDataFile.h"
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <map>
 namespace NCL {
 	namespace CSC8503 {
 		struct GridNode {
-			GridNode* parent;
-
 			GridNode* connected[4];
 			int		  costs[4];
 
 			Vector3		position;
 
-			float f;
-			float g;
-
 			int type;
 
 			GridNode() {
@@ -21,31 +21,156 @@ namespace NCL {
 					connected[i] = nullptr;
 					costs[i] = 0;
 				}
-				f = 0;
-				g = 0;
 				type = 0;
-				parent = nullptr;
 			}
 			~GridNode() {	}
 		};
 
+		/*
+		All of the per-search state for an A* query lives in here, rather than in the
+		GridNodes themselves, so that the grid can be searched by more than one agent
+		(or thread) at once, as long as each has its own scratch.
+
+		Rather than clearing the g / f / parent arrays for every search, each node is
+		stamped with the generation of the search that last touched it - anything with
+		an old stamp is treated as unvisited. Likewise, only the words of the closed
+		bitset that a search actually touched get cleared for the next one, so a small
+		search on a big grid stays cheap. The open list is a binary heap of node
+		indices, and heapIndex lets us find a node in the heap to reprioritise it.
+		*/
+		struct GridSearchScratch {
+			std::vector<float>		g;
+			std::vector<float>		f;
+			std::vector<int>		parent;
+			std::vector<int>		heapIndex;
+			std::vector<uint32_t>	generation;
+			std::vector<uint64_t>	closed;		//one bit per node
+			std::vector<int>		closedWords;//which words of closed have bits set
+			std::vector<int>		heap;
+
+			uint32_t currentGeneration = 0;
+		};
+
+		struct GridRect {
+			int minX;
+			int minY;
+			int maxX;	//inclusive
+			int maxY;
+		};
+
+		enum GridSearchMode {
+			AStarSearch,			//4-connected, using each node's costs
+			JumpPointSearch,		//8-connected, uniform cost
+			JumpPointPlusSearch,	//as above, but using the table from BuildJumpPointTable
+		};
+
+		//Called once per batch of edits, with the index of every node whose type changed
+		typedef std::function<void(const std::vector<int>&)> GridChangeListener;
+
 		class NavigationGrid : public NavigationMap	{
 		public:
 			NavigationGrid();
 			NavigationGrid(const std::string&filename);
+			NavigationGrid(int nodeSize, int width, int height, const char* types);
+			NavigationGrid(const NavigationDataFile& file);
 			~NavigationGrid();
 
 			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, GridSearchScratch& scratch, GridSearchMode mode = AStarSearch) const;
+
+			bool SearchNodes(int startIndex, int endIndex, const GridRect& bounds, GridSearchScratch& scratch) const;
+
+			void SetNodeType(int x, int y, int type);
+
+			/*
+			Edits made between BeginEdit and EndEdit are batched up - the links, the
+			JPS+ table and the change listeners are only brought up to date once, at
+			EndEdit, however many nodes changed. They can be nested, and an edit made
+			outside of them is a batch of its own.
+			*/
+			void BeginEdit();
+			void EndEdit();
+
+			/*
+			Dynamic obstacles - while a node has any blockers it's treated as a wall,
+			and it gets its old type back once the last of them is removed.
+			*/
+			void AddBlocker(int x, int y);
+			void RemoveBlocker(int x, int y);
+			void AddBlocker(const Vector3& boundsMin, const Vector3& boundsMax);
+			void RemoveBlocker(const Vector3& boundsMin, const Vector3& boundsMax);
+			bool GetNodeRect(const Vector3& boundsMin, const Vector3& boundsMax, GridRect& outRect) const;
+
+			int  AddChangeListener(GridChangeListener listener);
+			void RemoveChangeListener(int listenerID);
+
+			void WriteNavData(NavigationDataWriter& writer) const;
+
+			//Needed for JumpPointPlusSearch - without it, those queries fall back to plain JPS
+			void BuildJumpPointTable();
+
+			int GetNodeIndex(const Vector3& position) const; //-1 if outside of the grid
+
+			const GridNode& GetNode(int index) const {
+				return allNodes[index];
+			}
+			int GetGridWidth() const {
+				return gridWidth;
+			}
+			int GetGridHeight() const {
+				return gridHeight;
+			}
+			int GetNodeSize() const {
+				return nodeSize;
+			}
+
+			int GetNodeCount() const {
+				return gridWidth * gridHeight;
+			}
 				
 		protected:
-			bool		NodeInList(GridNode* n, std::vector<GridNode*>& list) const;
-			GridNode*	RemoveBestNode(std::vector<GridNode*>& list) const;
-			float		Heuristic(GridNode* hNode, GridNode* endNode) const;
+			void		BuildNodes(int size, int width, int height, const char* types);
+			void		ConnectNode(int x, int y);
+			void		ApplyEdits();
+
+			void		BeginSearch(GridSearchScratch& scratch) const;
+			void		HeapPush(GridSearchScratch& scratch, int node) const;
+			int			HeapPop(GridSearchScratch& scratch) const;
+			void		HeapSiftUp(GridSearchScratch& scratch, int pos) const;
+			void		HeapSiftDown(GridSearchScratch& scratch, int pos) const;
+
+			float		Heuristic(const GridNode* hNode, const GridNode* endNode) const;
+
+			bool		JumpPointSearchNodes(int startIndex, int endIndex, GridSearchScratch& scratch, bool usePrecomputed) const;
+			bool		Walkable(int x, int y) const;
+			bool		CanStep(int x, int y, int dx, int dy) const;
+			bool		HasForcedNeighbour(int x, int y, int dx, int dy) const;
+			int			Jump(int x, int y, int dx, int dy, int endIndex) const;
+			int			JumpPlus(int x, int y, int direction, int endIndex) const;
+			int			ComputeJumpDistance(int x, int y, int direction) const;
+			void		UpdateJumpPointTable(const std::vector<int>& changedNodes);
+			float		OctileDistance(int a, int b) const;
 			int nodeSize;
 			int gridWidth;
 			int gridHeight;
 
 			GridNode* allNodes;
+
+			std::vector<int> jumpDistances;	//8 per node
+
+			struct Blockers {
+				int count;
+				int originalType;
+			};
+			std::map<int, Blockers> blockers;	//only nodes with something on them
+
+			std::vector<std::pair<int, GridChangeListener>> changeListeners;
+			int nextListenerID;
+
+			int					editDepth;
+			std::map<int, int>	pendingEdits;	//node index -> its type before the batch
+
+			GridSearchScratch scratch;
 		};
 	}
 }
@@ -2,15 +2,22 @@
 #include "Assets.h"
 #include "Maths.h"
 #include <fstream>
+#include <queue>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
 using namespace NCL;
 using namespace CSC8503;
 using namespace std;
 
 NavigationMesh::NavigationMesh()
 {
+	lookupCellSize	= 1.0f;
+	lookupWidth		= 0;
+	lookupHeight	= 0;
 }
 
-NavigationMesh::NavigationMesh(const std::string&filename)
+NavigationMesh::NavigationMesh(const std::string&filename) : NavigationMesh()
 {
 	ifstream file(Assets::DATADIR + filename);
 
@@ -59,6 +66,258 @@ NavigationMesh::NavigationMesh(const std::string&filename)
 			}
 		}
 	}
+	BuildPortals();
+	BuildTriLookup();
+}
+
+/*
+Loads a mesh from compiled navigation data, which already has the portals and
+the triangle lookup grid worked out. Every count and index in the file is
+checked before anything is loaded - if any of them don't make sense, the mesh
+is left empty, and should be built from its text file instead.
+*/
+NavigationMesh::NavigationMesh(const NavigationDataFile& file) : NavigationMesh() {
+	size_t chunkSize = 0;
+	const char* chunk = file.GetChunk(NavDataMesh, chunkSize);
+	if (!chunk || chunkSize < sizeof(NavDataMeshHeader)) {
+		return;
+	}
+	const NavDataMeshHeader* header = (const NavDataMeshHeader*)chunk;
+	if (header->vertexCount < 0 || header->triCount < 0 || header->lookupTriCount < 0 ||
+		header->lookupWidth < 0 || header->lookupHeight < 0) {
+		return;
+	}
+	bool hasLookup = header->lookupWidth > 0 && header->lookupHeight > 0;
+	if (hasLookup && !(header->lookupCellSize > 0.0f)) {
+		return;
+	}
+	//Each part is taken off what's left of the chunk in turn, so no total can overflow
+	size_t remaining = chunkSize - sizeof(NavDataMeshHeader);
+	auto Take = [&](size_t count, size_t size) {
+		if (remaining / size < count) {
+			return false;
+		}
+		remaining -= count * size;
+		return true;
+	};
+	size_t lookupCells = hasLookup ? (size_t)header->lookupWidth * header->lookupHeight : 0;
+	if (!Take(header->vertexCount, sizeof(NavDataVertex)) ||
+		!Take(header->triCount, sizeof(NavDataTri)) ||
+		!Take(lookupCells, sizeof(int32_t)) || !Take(1, sizeof(int32_t)) ||
+		!Take(header->lookupTriCount, sizeof(int32_t))) {
+		return;
+	}
+	const NavDataVertex*	verts		= (const NavDataVertex*)(chunk + sizeof(NavDataMeshHeader));
+	const NavDataTri*		tris		= (const NavDataTri*)(verts + header->vertexCount);
+	const int32_t*			cellStarts	= (const int32_t*)(tris + header->triCount);
+	const int32_t*			cellTris	= cellStarts + lookupCells + 1;
+
+	for (int i = 0; i < header->triCount; ++i) {
+		const NavDataTri& from = tris[i];
+		for (int j = 0; j < 3; ++j) {
+			if (from.indices[j] < 0 || from.indices[j] >= header->vertexCount ||
+				from.portals[j][0] < 0 || from.portals[j][0] >= header->vertexCount ||
+				from.portals[j][1] < 0 || from.portals[j][1] >= header->vertexCount ||
+				from.neighbours[j] < -1 || from.neighbours[j] >= header->triCount) {
+				return;
+			}
+		}
+	}
+	//The lookup's starts have to run in order from 0 to the end of its triangle list
+	if (cellStarts[0] != 0 || cellStarts[lookupCells] != header->lookupTriCount) {
+		return;
+	}
+	for (size_t i = 0; i < lookupCells; ++i) {
+		if (cellStarts[i + 1] < cellStarts[i]) {
+			return;
+		}
+	}
+	for (int i = 0; i < header->lookupTriCount; ++i) {
+		if (cellTris[i] < 0 || cellTris[i] >= header->triCount) {
+			return;
+		}
+	}
+
+	allVerts.resize(header->vertexCount);
+	for (int i = 0; i < header->vertexCount; ++i) {
+		allVerts[i] = Vector3(verts[i].position[0], verts[i].position[1], verts[i].position[2]);
+	}
+	allTris.resize(header->triCount);
+	for (int i = 0; i < header->triCount; ++i) {
+		const NavDataTri& from = tris[i];
+		NavTri& t = allTris[i];
+
+		t.triPlane	= Plane(Vector3(from.planeNormal[0], from.planeNormal[1], from.planeNormal[2]), from.planeDistance);
+		t.centroid	= Vector3(from.centroid[0], from.centroid[1], from.centroid[2]);
+		t.area		= from.area;
+		for (int j = 0; j < 3; ++j) {
+			t.indices[j]	= from.indices[j];
+			t.neighbours[j] = from.neighbours[j] >= 0 ? &allTris[from.neighbours[j]] : nullptr;
+			t.portals[j][0] = from.portals[j][0];
+			t.portals[j][1] = from.portals[j][1];
+		}
+	}
+	lookupMin		= Vector3(header->lookupMin[0], header->lookupMin[1], header->lookupMin[2]);
+	lookupCellSize	= hasLookup ? header->lookupCellSize : 1.0f;
+	lookupWidth		= hasLookup ? header->lookupWidth : 0;
+	lookupHeight	= hasLookup ? header->lookupHeight : 0;
+	lookupStart.assign(cellStarts, cellStarts + lookupCells + 1);
+	lookupTris.assign(cellTris, cellTris + header->lookupTriCount);
+}
+
+void NavigationMesh::WriteNavData(NavigationDataWriter& writer) const {
+	NavDataMeshHeader header = {};
+	header.vertexCount		= (int32_t)allVerts.size();
+	header.triCount			= (int32_t)allTris.size();
+	header.lookupWidth		= lookupWidth;
+	header.lookupHeight		= lookupHeight;
+	header.lookupMin[0]		= lookupMin.x;
+	header.lookupMin[1]		= lookupMin.y;
+	header.lookupMin[2]		= lookupMin.z;
+	header.lookupCellSize	= lookupCellSize;
+	header.lookupTriCount	= (int32_t)lookupTris.size();
+
+	std::vector<NavDataVertex> verts(allVerts.size());
+	for (size_t i = 0; i < allVerts.size(); ++i) {
+		verts[i] = { { allVerts[i].x, allVerts[i].y, allVerts[i].z } };
+	}
+	std::vector<NavDataTri> tris(allTris.size());
+	for (size_t i = 0; i < allTris.size(); ++i) {
+		const NavTri& t = allTris[i];
+		NavDataTri& to = tris[i];
+
+		Vector3 normal = t.triPlane.GetNormal();
+		for (int j = 0; j < 3; ++j) {
+			to.indices[j]		= t.indices[j];
+			to.neighbours[j]	= t.neighbours[j] ? (int32_t)(t.neighbours[j] - allTris.data()) : -1;
+			to.portals[j][0]	= t.portals[j][0];
+			to.portals[j][1]	= t.portals[j][1];
+			to.planeNormal[j]	= normal[j];
+			to.centroid[j]		= t.centroid[j];
+		}
+		to.planeDistance	= t.triPlane.GetDistance();
+		to.area				= t.area;
+	}
+	std::vector<int32_t> cellStarts(lookupStart.begin(), lookupStart.end());
+	if (cellStarts.empty()) {
+		cellStarts.emplace_back(0);
+	}
+
+	std::vector<char>& chunk = writer.AddChunk(NavDataMesh);
+	NavigationDataWriter::Write(chunk, header);
+	NavigationDataWriter::Write(chunk, verts.data(), verts.size());
+	NavigationDataWriter::Write(chunk, tris.data(), tris.size());
+	NavigationDataWriter::Write(chunk, cellStarts.data(), cellStarts.size());
+	NavigationDataWriter::Write(chunk, lookupTris.data(), lookupTris.size());
+}
+
+/*
+The file doesn't say which edge each neighbour is across, and neighbouring
+triangles don't always share vertex indices, so we find the two vertices of each
+triangle that sit in the same place as a vertex of the neighbour.
+*/
+void NavigationMesh::BuildPortals() {
+	const float epsilon = 0.001f;
+
+	for (NavTri& t : allTris) {
+		for (int j = 0; j < 3; ++j) {
+			t.portals[j][0] = t.indices[0];
+			t.portals[j][1] = t.indices[1];
+
+			const NavTri* n = t.neighbours[j];
+			if (!n) {
+				continue;
+			}
+			int shared[3];
+			int sharedCount = 0;
+			for (int a = 0; a < 3; ++a) {
+				for (int b = 0; b < 3; ++b) {
+					if (Vector::Length(allVerts[t.indices[a]] - allVerts[n->indices[b]]) < epsilon) {
+						shared[sharedCount++] = t.indices[a];
+						break;
+					}
+				}
+			}
+			if (sharedCount >= 2) {
+				t.portals[j][0] = shared[0];
+				t.portals[j][1] = shared[1];
+			}
+			else { //bad data - use the edge closest to the neighbour's centre instead
+				float bestDist = FLT_MAX;
+				for (int a = 0; a < 3; ++a) {
+					int v0 = t.indices[a];
+					int v1 = t.indices[(a + 1) % 3];
+					float dist = Vector::Length(((allVerts[v0] + allVerts[v1]) * 0.5f) - n->centroid);
+					if (dist < bestDist) {
+						bestDist = dist;
+						t.portals[j][0] = v0;
+						t.portals[j][1] = v1;
+					}
+				}
+			}
+		}
+	}
+}
+
+void NavigationMesh::BuildTriLookup() {
+	lookupStart.clear();
+	lookupTris.clear();
+	if (allTris.empty()) {
+		lookupWidth		= 0;
+		lookupHeight	= 0;
+		return;
+	}
+	Vector3 minBounds(FLT_MAX, FLT_MAX, FLT_MAX);
+	Vector3 maxBounds(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (const Vector3& v : allVerts) {
+		minBounds = Vector3(std::min(minBounds.x, v.x), std::min(minBounds.y, v.y), std::min(minBounds.z, v.z));
+		maxBounds = Vector3(std::max(maxBounds.x, v.x), std::max(maxBounds.y, v.y), std::max(maxBounds.z, v.z));
+	}
+	//aim for roughly one triangle per cell
+	int cellsPerSide	= std::max(1, (int)std::sqrt((float)allTris.size()));
+	float extent		= std::max(maxBounds.x - minBounds.x, maxBounds.z - minBounds.z);
+
+	lookupMin		= minBounds;
+	lookupCellSize	= std::max(extent / cellsPerSide, 0.001f);
+	lookupWidth		= (int)((maxBounds.x - minBounds.x) / lookupCellSize) + 1;
+	lookupHeight	= (int)((maxBounds.z - minBounds.z) / lookupCellSize) + 1;
+
+	auto CellRange = [&](const NavTri& t, int& x0, int& z0, int& x1, int& z1) {
+		Vector3 a = allVerts[t.indices[0]];
+		Vector3 b = allVerts[t.indices[1]];
+		Vector3 c = allVerts[t.indices[2]];
+		x0 = (int)((std::min({ a.x, b.x, c.x }) - lookupMin.x) / lookupCellSize);
+		z0 = (int)((std::min({ a.z, b.z, c.z }) - lookupMin.z) / lookupCellSize);
+		x1 = std::min((int)((std::max({ a.x, b.x, c.x }) - lookupMin.x) / lookupCellSize), lookupWidth - 1);
+		z1 = std::min((int)((std::max({ a.z, b.z, c.z }) - lookupMin.z) / lookupCellSize), lookupHeight - 1);
+	};
+
+	//Two passes - count how many triangles land in each cell, then fill them in
+	lookupStart.assign((lookupWidth * lookupHeight) + 1, 0);
+	for (const NavTri& t : allTris) {
+		int x0, z0, x1, z1;
+		CellRange(t, x0, z0, x1, z1);
+		for (int z = z0; z <= z1; ++z) {
+			for (int x = x0; x <= x1; ++x) {
+				lookupStart[(z * lookupWidth) + x + 1]++;
+			}
+		}
+	}
+	for (size_t i = 1; i < lookupStart.size(); ++i) {
+		lookupStart[i] += lookupStart[i - 1];
+	}
+	lookupTris.resize(lookupStart.back());
+
+	std::vector<int> fill(lookupStart.begin(), lookupStart.end() - 1);
+	for (int i = 0; i < (int)allTris.size(); ++i) {
+		int x0, z0, x1, z1;
+		CellRange(allTris[i], x0, z0, x1, z1);
+		for (int z = z0; z <= z1; ++z) {
+			for (int x = x0; x <= x1; ++x) {
+				lookupTris[fill[(z * lookupWidth) + x]++] = i;
+			}
+		}
+	}
 }
 
 NavigationMesh::~NavigationMesh()
@@ -66,31 +325,247 @@ NavigationMesh::~NavigationMesh()
 }
 
 bool NavigationMesh::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
+	return FindPath(from, to, outPath, scratch);
+}
+
+bool NavigationMesh::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, MeshSearchScratch& s) const {
 	const NavTri* start	= GetTriForPosition(from);
 	const NavTri* end	= GetTriForPosition(to);
 
+	if (!start || !end) {
+		return false;
+	}
+	if (!SearchTris(start, end, to, s)) {
+		return false;
+	}
+	StringPull(from, to, s, outPath);
+	return true;
+}
+
+/*
+A* across the triangles, stepping between their centroids. If it succeeds, the
+triangles passed through are left in scratch.triPath, from start to end.
+*/
+bool NavigationMesh::SearchTris(const NavTri* start, const NavTri* end, const Vector3& to, MeshSearchScratch& s) const {
+	int startIndex	= (int)(start - allTris.data());
+	int endIndex	= (int)(end - allTris.data());
+
+	s.g.assign(allTris.size(), FLT_MAX);
+	s.parent.assign(allTris.size(), -1);
+	s.closed.assign(allTris.size(), false);
+	s.triPath.clear();
+
+	typedef std::pair<float, int> OpenEntry;
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openList;
+
+	s.g[startIndex] = 0.0f;
+	openList.push({ 0.0f, startIndex });
+
+	while (!openList.empty()) {
+		int current = openList.top().second;
+		openList.pop();
+
+		if (s.closed[current]) {
+			continue; //a stale entry, we've already found a better route to it
+		}
+		s.closed[current] = true;
+
+		if (current == endIndex) {
+			for (int t = endIndex; t >= 0; t = s.parent[t]) {
+				s.triPath.emplace_back(t);
+			}
+			std::reverse(s.triPath.begin(), s.triPath.end());
+			return true;
+		}
+		const NavTri& tri = allTris[current];
+		for (int i = 0; i < 3; ++i) {
+			if (!tri.neighbours[i]) {
+				continue;
+			}
+			int n = (int)(tri.neighbours[i] - allTris.data());
+			if (s.closed[n]) {
+				continue;
+			}
+			float g = s.g[current] + Vector::Length(allTris[n].centroid - tri.centroid);
+			if (g < s.g[n]) {
+				s.g[n]		= g;
+				s.parent[n]	= current;
+				openList.push({ g + Vector::Length(to - allTris[n].centroid), n });
+			}
+		}
+	}
 	return false;
 }
 
+//Twice the signed area of the triangle abc, looking down from above
+static float TriArea2(const Vector3& a, const Vector3& b, const Vector3& c) {
+	float abx = b.x - a.x;
+	float abz = b.z - a.z;
+	float acx = c.x - a.x;
+	float acz = c.z - a.z;
+	return (acx * abz) - (abx * acz);
+}
+
+static bool NearlyEqual(const Vector3& a, const Vector3& b) {
+	return Vector::LengthSquared(a - b) < 0.000001f;
+}
+
+//Is p on the edge ab (including its ends), looking down from above?
+static bool OnEdgeXZ(const Vector3& p, const Vector3& a, const Vector3& b) {
+	const float epsilon = 0.001f;
+	float abx = b.x - a.x;
+	float abz = b.z - a.z;
+	float area = TriArea2(a, b, p);
+	if (area * area > epsilon * epsilon * (abx * abx + abz * abz)) {
+		return false; //too far from the line through a and b
+	}
+	return ((a.x - p.x) * (b.x - p.x)) + ((a.z - p.z) * (b.z - p.z)) <= epsilon;
+}
+
 /*
-If you have triangles on top of triangles in a full 3D environment, you'll need to change this slightly,
-as it is currently ignoring height. You might find tri/plane raycasting is handy.
+The 'simple stupid funnel algorithm' - the funnel starts at the start point, and
+is narrowed by each portal (shared edge) along the triangle path in turn. When a
+side of the funnel would have to cross over the other, the path has to bend
+round that corner, so it's added as a waypoint and becomes the new funnel apex.
+
+A portal that the apex is sitting on (the start point on an edge between two
+triangles, or a corner shared by the next few portals) has already been passed,
+so it's skipped - otherwise the funnel has no width to it, and which way it
+'crosses' is just down to rounding.
 */
+void NavigationMesh::StringPull(const Vector3& from, const Vector3& to, MeshSearchScratch& s, NavigationPath& outPath) const {
+	s.portalLeft.clear();
+	s.portalRight.clear();
 
-const NavigationMesh::NavTri* NavigationMesh::GetTriForPosition(const Vector3& pos) const {
-	for (const NavTri& t : allTris) {
-		Vector3 planePoint = t.triPlane.ProjectPointOntoPlane(pos);
+	s.portalLeft.emplace_back(from);
+	s.portalRight.emplace_back(from);
+	for (size_t i = 0; i + 1 < s.triPath.size(); ++i) {
+		const NavTri& tri = allTris[s.triPath[i]];
+		const NavTri* next = &allTris[s.triPath[i + 1]];
+		for (int j = 0; j < 3; ++j) {
+			if (tri.neighbours[j] != next) {
+				continue;
+			}
+			Vector3 a = allVerts[tri.portals[j][0]];
+			Vector3 b = allVerts[tri.portals[j][1]];
+			if (TriArea2(tri.centroid, a, b) < 0.0f) {
+				s.portalRight.emplace_back(a);
+				s.portalLeft.emplace_back(b);
+			}
+			else {
+				s.portalRight.emplace_back(b);
+				s.portalLeft.emplace_back(a);
+			}
+			break;
+		}
+	}
+	s.portalLeft.emplace_back(to);
+	s.portalRight.emplace_back(to);
 
-		float ta = Maths::AreaofTri3D(allVerts[t.indices[0]], allVerts[t.indices[1]], planePoint);
-		float tb = Maths::AreaofTri3D(allVerts[t.indices[1]], allVerts[t.indices[2]], planePoint);
-		float tc = Maths::AreaofTri3D(allVerts[t.indices[2]], allVerts[t.indices[0]], planePoint);
+	std::vector<Vector3> points;
+	points.emplace_back(from);
 
-		float areaSum = ta + tb + tc;
+	Vector3 apex	= from;
+	Vector3 left	= s.portalLeft[0];
+	Vector3 right	= s.portalRight[0];
+	int apexIndex	= 0;
+	int leftIndex	= 0;
+	int rightIndex	= 0;
 
-		if (abs(areaSum - t.area)  > 0.001f) { //floating points are annoying! Are we more or less inside the triangle?
+	int portalCount = (int)s.portalLeft.size();
+	for (int i = 1; i < portalCount; ++i) {
+		const Vector3& newLeft	= s.portalLeft[i];
+		const Vector3& newRight	= s.portalRight[i];
+
+		if (i + 1 < portalCount && OnEdgeXZ(apex, newLeft, newRight)) {
 			continue;
 		}
-		return &t;
+		if (TriArea2(apex, right, newRight) <= 0.0f) { //does the right side of the funnel narrow?
+			if (NearlyEqual(apex, right) || TriArea2(apex, left, newRight) > 0.0f) {
+				right		= newRight;
+				rightIndex	= i;
+			}
+			else { //it crossed over the left side, so the left side is a corner
+				if (!NearlyEqual(points.back(), left)) {
+					points.emplace_back(left);
+				}
+				apex		= left;
+				apexIndex	= leftIndex;
+				right		= apex;
+				rightIndex	= apexIndex;
+				i			= apexIndex;
+				continue;
+			}
+		}
+		if (TriArea2(apex, left, newLeft) >= 0.0f) { //does the left side of the funnel narrow?
+			if (NearlyEqual(apex, left) || TriArea2(apex, right, newLeft) < 0.0f) {
+				left		= newLeft;
+				leftIndex	= i;
+			}
+			else {
+				if (!NearlyEqual(points.back(), right)) {
+					points.emplace_back(right);
+				}
+				apex		= right;
+				apexIndex	= rightIndex;
+				left		= apex;
+				leftIndex	= apexIndex;
+				i			= apexIndex;
+				continue;
+			}
+		}
+	}
+	if (!NearlyEqual(points.back(), to)) {
+		points.emplace_back(to);
+	}
+	for (auto i = points.rbegin(); i != points.rend(); ++i) {
+		outPath.PushWaypoint(*i);
+	}
+}
+
+bool NavigationMesh::PointInTriXZ(const NavTri& t, const Vector3& pos) const {
+	const Vector3& a = allVerts[t.indices[0]];
+	const Vector3& b = allVerts[t.indices[1]];
+	const Vector3& c = allVerts[t.indices[2]];
+
+	const float epsilon = 0.0001f; //floating points are annoying! Let points on an edge count
+	float ab = TriArea2(a, b, pos);
+	float bc = TriArea2(b, c, pos);
+	float ca = TriArea2(c, a, pos);
+
+	bool hasNegative = ab < -epsilon || bc < -epsilon || ca < -epsilon;
+	bool hasPositive = ab >  epsilon || bc >  epsilon || ca >  epsilon;
+	return !(hasNegative && hasPositive);
+}
+
+/*
+Finds the triangles under the point from above, using the lookup grid. If there
+are triangles on top of triangles (a bridge, say), we pick the one closest to the
+point's height.
+*/
+const NavigationMesh::NavTri* NavigationMesh::GetTriForPosition(const Vector3& pos) const {
+	if (lookupWidth == 0) {
+		return nullptr;
+	}
+	int x = (int)std::floor((pos.x - lookupMin.x) / lookupCellSize);
+	int z = (int)std::floor((pos.z - lookupMin.z) / lookupCellSize);
+	if (x < 0 || x > lookupWidth - 1 || z < 0 || z > lookupHeight - 1) {
+		return nullptr;
+	}
+	int cell = (z * lookupWidth) + x;
+
+	const NavTri* best	= nullptr;
+	float bestHeight	= FLT_MAX;
+	for (int i = lookupStart[cell]; i < lookupStart[cell + 1]; ++i) {
+		const NavTri& t = allTris[lookupTris[i]];
+		if (!PointInTriXZ(t, pos)) {
+			continue;
+		}
+		float height = std::abs(t.triPlane.DistanceFromPlane(pos));
+		if (height < bestHeight) {
+			bestHeight	= height;
+			best		= &t;
+		}
 	}
-	return nullptr;
+	return best;
 }
\ No newline at end of file
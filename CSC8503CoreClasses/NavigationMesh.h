@@ -1,17 +1,31 @@
 #pragma once
 #include "NavigationMap.h"
+#include "NavigationDataFile.h"
 #include "Plane.h"
 #include <string>
 #include <vector>
 namespace NCL {
 	namespace CSC8503 {
+		struct MeshSearchScratch {
+			std::vector<float>	g;
+			std::vector<int>	parent;
+			std::vector<bool>	closed;
+			std::vector<int>	triPath;
+			std::vector<Vector3> portalLeft;
+			std::vector<Vector3> portalRight;
+		};
+
 		class NavigationMesh : public NavigationMap	{
 		public:
 			NavigationMesh();
 			NavigationMesh(const std::string&filename);
+			NavigationMesh(const NavigationDataFile& file);
 			~NavigationMesh();
 
 			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, MeshSearchScratch& scratch) const;
+
+			void WriteNavData(NavigationDataWriter& writer) const;
 		
 		protected:
 			struct NavTri {
@@ -21,6 +35,7 @@ namespace NCL {
 				NavTri* neighbours[3];
 
 				int indices[3];
+				int portals[3][2];	//which of our vertices form the edge shared with each neighbour
 
 				NavTri() {
 					area = 0.0f;
@@ -36,8 +51,29 @@ namespace NCL {
 
 			const NavTri* GetTriForPosition(const Vector3& pos) const;
 
+			void	BuildPortals();
+			void	BuildTriLookup();
+			bool	PointInTriXZ(const NavTri& t, const Vector3& pos) const;
+
+			bool	SearchTris(const NavTri* start, const NavTri* end, const Vector3& to, MeshSearchScratch& scratch) const;
+			void	StringPull(const Vector3& from, const Vector3& to, MeshSearchScratch& scratch, NavigationPath& outPath) const;
+
 			std::vector<NavTri>		allTris;
 			std::vector<Vector3>	allVerts;
+
+			/*
+			A uniform grid over the mesh's XZ bounds - each cell lists the triangles
+			whose bounds overlap it, so finding the triangle under a point only has to
+			test a handful of them, rather than every triangle in the mesh.
+			*/
+			Vector3				lookupMin;
+			float				lookupCellSize;
+			int					lookupWidth;
+			int					lookupHeight;
+			std::vector<int>	lookupStart;	//cell i's triangles are lookupTris[lookupStart[i]] to lookupTris[lookupStart[i+1]]
+			std::vector<int>	lookupTris;
+
+			MeshSearchScratch	scratch;
 		};
 	}
-}
\ No newline at end of file
+}
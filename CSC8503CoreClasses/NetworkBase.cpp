@@ -1,41 +1,42 @@
 #include "NetworkBase.h"
-#include "./enet/enet.h"
+#include "ENetTransport.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
 NetworkBase::NetworkBase()	{
-	netHandle = nullptr;
+	transport = nullptr;
 }
 
 NetworkBase::~NetworkBase()	{
-	if (netHandle) {
-		enet_host_destroy(netHandle);
-	}
+	delete transport;
 }
 
 void NetworkBase::Initialise() {
-	enet_initialize();
+	ENetTransport::Initialise();
 }
 
 void NetworkBase::Destroy() {
-	enet_deinitialize();
+	ENetTransport::Destroy();
 }
 
 bool NetworkBase::ProcessPacket(GamePacket* packet, int peerID) {
-    PacketHandlerIterator firstHandler;
-    PacketHandlerIterator lastHandler;
-
-    // Get the packet handlers for the packet type
-    bool canHandle = GetPacketHandlers(packet->type, firstHandler, lastHandler);
-
-    if (canHandle) {
-        // Iterate through all handlers for the packet type
-        for (auto i = firstHandler; i != lastHandler; ++i) {
-            i->second->ReceivePacket(packet->type, packet, peerID);
-        }
-        return true; // Packet was handled
-    }
-
-    // No handler was found for the packet type
-    std::cout << __FUNCTION__ << " no handler for packet type "
-        << packet->type << std::endl;
+	if (packet->type < 0 || packet->type >= (int)packetHandlers.size() || packetHandlers[packet->type].empty()) {
+		std::cout << __FUNCTION__ << " no handler for packet type "
+			<< packet->type << std::endl;
+		return false;
+	}
+	for (PacketReceiver* r : packetHandlers[packet->type]) {
+		r->ReceivePacket(packet->type, packet, peerID);
+	}
+	return true;
+}
 
-    return false; // Packet was not handled
-}
\ No newline at end of file
+bool NetworkBase::ProcessPacket(const NetworkEvent& e, int peerID) {
+	GamePacket* gamePacket = (GamePacket*)e.data;
+	if (!gamePacket || e.size < sizeof(GamePacket) || gamePacket->size < 0 ||
+		(size_t)gamePacket->GetTotalSize() > e.size) {
+		return false;
+	}
+	return ProcessPacket(gamePacket, peerID);
+}
@@ -1,20 +1,20 @@
 #pragma once
 //#include "./enet/enet.h"
-struct _ENetHost;
-struct _ENetPeer;
-struct _ENetEvent;
+#include "NetworkTransport.h"
+#include <vector>
 
 enum BasicNetworkMessages {
 	None,
 	Hello,
 	Message,
 	String_Message,
-	Delta_State,	//1 byte per channel since the last state
-	Full_State,		//Full transform etc
+	Delta_State,	//object states now travel as records inside a Snapshot_Batch,
+	Full_State,		//see NetworkStateRecord
 	Received_State, //received from a client, informs that its received packet n
 	Player_Connected,
 	Player_Disconnected,
-	Shutdown
+	Shutdown,
+	Snapshot_Batch	//many state packets packed into one datagram, see SnapshotBuilder
 };
 
 struct GamePacket {
@@ -30,9 +30,19 @@ struct GamePacket {
 		this->type	= type;
 	}
 
-	int GetTotalSize() {
+	int GetTotalSize() const {
 		return sizeof(GamePacket) + size;
 	}
+
+	/*
+	Handlers are given a GamePacket pointing straight into the network's receive
+	buffer - this views it as the packet type it really is, without copying it
+	anywhere, as long as it's big enough to be one.
+	*/
+	template <typename T>
+	T* As() {
+		return GetTotalSize() >= (int)sizeof(T) ? (T*)this : nullptr;
+	}
 };
 
 struct StringPacket : public GamePacket {
@@ -67,28 +77,23 @@ public:
 	}
 
 	void RegisterPacketHandler(int msgID, PacketReceiver* receiver) {
-		packetHandlers.insert(std::make_pair(msgID, receiver));
+		if (msgID < 0) {
+			return;
+		}
+		if (msgID >= (int)packetHandlers.size()) {
+			packetHandlers.resize(msgID + 1);
+		}
+		packetHandlers[msgID].emplace_back(receiver);
 	}
 protected:
 	NetworkBase();
 	~NetworkBase();
 
 	bool ProcessPacket(GamePacket* p, int peerID = -1);
+	//Checks a received packet really is as big as it claims to be, before handing it out
+	bool ProcessPacket(const NCL::CSC8503::NetworkEvent& e, int peerID = -1);
 
-	typedef std::multimap<int, PacketReceiver*>::const_iterator PacketHandlerIterator;
-
-	bool GetPacketHandlers(int msgID, PacketHandlerIterator& first, PacketHandlerIterator& last) const {
-		auto range = packetHandlers.equal_range(msgID);
-
-		if (range.first == packetHandlers.end()) {
-			return false; //no handlers for this message type!
-		}
-		first	= range.first;
-		last	= range.second;
-		return true;
-	}
-
-	_ENetHost* netHandle;
+	NCL::CSC8503::NetworkTransport* transport;	//owned by us
 
-	std::multimap<int, PacketReceiver*> packetHandlers;
+	std::vector<std::vector<PacketReceiver*>> packetHandlers;	//indexed by message type
 };
\ No newline at end of file
@@ -1,133 +1,241 @@
 #include "NetworkObject.h"
+#include "BitStream.h"
 #include "./enet/enet.h"
 using namespace NCL;
 using namespace CSC8503;
 
 NetworkObject::NetworkObject(GameObject& o, int id) : object(o)	{
-	deltaErrors = 0;
-	fullErrors  = 0;
-	networkID   = id;
+	networkID		= id;
+	lastStateID		= -1;
+	timelineStart	= 0;
+	timelineCount	= 0;
+	interpolated	= false;
+	settled			= true;
+
+	captured.stateID	= -1;
+	capturedChangeCount	= 0;
 }
 
 NetworkObject::~NetworkObject()	{
 }
 
-bool NetworkObject::ReadPacket(GamePacket& p) {
-	if (p.type == Delta_State) {
-		return ReadDeltaPacket((DeltaPacket&)p);
-	}
-	if (p.type == Full_State) {
-		return ReadFullPacket((FullPacket&)p);
-	}
-	return false; //this isn't a packet we care about!
+void* NetworkObject::operator new(size_t size) {
+	return GetPool().AllocateSized(size);
 }
 
-bool NetworkObject::WritePacket(GamePacket** p, bool deltaFrame, int stateID) {
-	if (deltaFrame) {
-		if (!WriteDeltaPacket(p, stateID)) {
-			return WriteFullPacket(p);
-		}
-	}
-	return WriteFullPacket(p);
+void NetworkObject::operator delete(void* p, size_t size) {
+	GetPool().FreeSized(p, size);
 }
-//Client objects recieve these packets
-bool NetworkObject::ReadDeltaPacket(DeltaPacket &p) {
-	if (p.fullID != lastFullState.stateID) {
-		return false;
-	}
-	UpdateStateHistory(p.fullID);
-
-	Vector3 fullPos = lastFullState.position;
-	Quaternion fullOrientation = lastFullState.orientation;
 
-	fullPos.x += p.pos[0];
-	fullPos.y += p.pos[1];
-	fullPos.z += p.pos[2];
-
-	fullOrientation.x += ((float)p.orientation[0]) / 127.0f;
-	fullOrientation.y += ((float)p.orientation[1]) / 127.0f;
-	fullOrientation.z += ((float)p.orientation[2]) / 127.0f;
-	fullOrientation.w += ((float)p.orientation[3]) / 127.0f;
+ObjectPool<NetworkObject>& NetworkObject::GetPool() {
+	static ObjectPool<NetworkObject> pool;
+	return pool;
+}
 
-	object.GetTransform().SetPosition(fullPos);
-	object.GetTransform().SetOrientation(fullOrientation);
-	return true;
+NetworkQuantisation& NetworkObject::GetQuantisation() {
+	static NetworkQuantisation quantisation;
+	return quantisation;
 }
 
-bool NetworkObject::ReadFullPacket(FullPacket &p) {
-	if (p.fullState.stateID < lastFullState.stateID) {
-		return false;
-	}
-	lastFullState = p.fullState;
+bool NetworkObject::ReadRecord(BitReader& stream, NetworkStateRecord& record) {
+	const NetworkQuantisation& q = GetQuantisation();
 
-	object.GetTransform().SetPosition(lastFullState.position);
-	object.GetTransform().SetOrientation(lastFullState.orientation);
+	record.objectID = (int)stream.ReadVarint();
+	record.isDelta	= stream.ReadBool();
 
-	stateHistory.emplace_back(lastFullState);
+	if (record.isDelta) {
+		for (int i = 0; i < 3; ++i) {
+			record.position[i] = stream.ReadSignedCompact();
+		}
+		record.hasOrientation = stream.ReadBool();
+	}
+	else {
+		for (int i = 0; i < 3; ++i) {
+			record.position[i] = (int32_t)stream.ReadBits(q.GetPositionBits(i));
+		}
+		record.hasOrientation = true;
+	}
+	if (record.hasOrientation) {
+		record.orientation = stream.ReadBits(q.GetOrientationBits());
+	}
+	return !stream.IsOverflowed();
+}
 
+bool NetworkObject::DecodeRecord(const NetworkStateRecord& record, const NetworkState* baseline, NetworkState& state) {
+	if (record.isDelta) {
+		if (!baseline) {
+			return false;
+		}
+		state = *baseline;
+		for (int i = 0; i < 3; ++i) {
+			state.quantisedPosition[i] += record.position[i];
+		}
+	}
+	else {
+		for (int i = 0; i < 3; ++i) {
+			state.quantisedPosition[i] = record.position[i];
+		}
+	}
+	if (record.hasOrientation) {
+		state.quantisedOrientation = record.orientation;
+	}
+	state.Dequantise(GetQuantisation());
 	return true;
 }
 
-bool NetworkObject::WriteDeltaPacket(GamePacket**p, int stateID) {
-	DeltaPacket* dp = new DeltaPacket();
-	NetworkState state;
-	if (!GetNetworkState(stateID, state)) {
+//Client objects recieve these states
+bool NetworkObject::ReadPacket(const NetworkState& state) {
+	if (state.stateID < lastStateID) {
 		return false;
 	}
+	lastStateID = state.stateID;
+	if (interpolated) {
+		AddToTimeline(state);
+	}
+	else {
+		object.GetTransform().SetPosition(state.position);
+		object.GetTransform().SetOrientation(state.orientation);
+	}
+	return true;
+}
+
+void NetworkObject::SetInterpolated(bool state) {
+	interpolated	= state;
+	timelineCount	= 0;
+	settled			= true;
+}
 
-	dp->fullID = stateID;
-	dp->objectID = networkID;
+/*
+Deltas mean an object that isn't moving isn't sent, so a long gap since the
+last state we have for it is usually time it spent sat still - interpolating
+across the whole gap would have it start creeping towards its new state long
+before it really moved. So the last state gets repeated just before the new
+one, holding the object in place until then. Short gaps are more likely to be
+a lost snapshot, which is better smoothed over.
+*/
+void NetworkObject::AddToTimeline(const NetworkState& state) {
+	if (timelineCount > 0) {
+		const NetworkState& newest = timeline[(timelineStart + timelineCount - 1) % TimelineSize];
+		if (state.stateID == newest.stateID) {
+			timelineCount--; //replacing it
+		}
+		else if (state.stateID - newest.stateID > TimelineHoldGap) {
+			NetworkState hold = newest;
+			hold.stateID = state.stateID - 1;
+			AddToTimeline(hold);
+		}
+	}
+	if (timelineCount == TimelineSize) {
+		timelineStart = (timelineStart + 1) % TimelineSize;
+		timelineCount--;
+	}
+	timeline[(timelineStart + timelineCount) % TimelineSize] = state;
+	timelineCount++;
+	settled = false;
+}
 
-	Vector3 currentPos = object.GetTransform().GetPosition();
-	Quaternion currentOrientation = object.GetTransform().GetOrientation();
+void NetworkObject::UpdateInterpolation(float renderTick) {
+	if (!interpolated || settled || timelineCount == 0) {
+		return;
+	}
+	//Finds the newest state at or before renderTick, if there is one
+	int from = 0;
+	while (from + 1 < timelineCount && timeline[(timelineStart + from + 1) % TimelineSize].stateID <= renderTick) {
+		from++;
+	}
+	const NetworkState& a = timeline[(timelineStart + from) % TimelineSize];
+	Transform& transform = object.GetTransform();
 
-	currentPos -= state.position;
-	currentOrientation -= state.orientation;
+	if (from + 1 < timelineCount && renderTick > a.stateID) {
+		const NetworkState& b = timeline[(timelineStart + from + 1) % TimelineSize];
+		float t = (renderTick - a.stateID) / (float)(b.stateID - a.stateID);
 
-	dp->pos[0] = (char)currentPos.x;
-	dp->pos[1] = (char)currentPos.y;
-	dp->pos[2] = (char)currentPos.z;
+		transform.SetPosition(a.position + ((b.position - a.position) * t));
+		transform.SetOrientation(Quaternion::Slerp(a.orientation, b.orientation, t));
+		return;
+	}
+	/*
+	The next state is late - rather than stop dead and then jump once it turns
+	up, the object carries on along its last known heading for a little while.
+	Only the position is extrapolated, as a wrong guess there is far less
+	noticeable than an object spinning the wrong way.
+	*/
+	float late = renderTick - a.stateID;
+	if (late > 0.0f && late < MaxExtrapolationTicks && from > 0) {
+		const NetworkState& previous = timeline[(timelineStart + from - 1) % TimelineSize];
+		Vector3 velocity = (a.position - previous.position) / (float)(a.stateID - previous.stateID);
+
+		transform.SetPosition(a.position + (velocity * late));
+		transform.SetOrientation(a.orientation);
+		return;
+	}
+	//Either we're still behind the oldest state, or there's nothing newer coming
+	transform.SetPosition(a.position);
+	transform.SetOrientation(a.orientation);
+	settled = late > 0.0f;
+}
 
-	dp->orientation[0] = (char)(currentOrientation.x * 127.0f);
-	dp->orientation[1] = (char)(currentOrientation.y * 127.0f);
-	dp->orientation[2] = (char)(currentOrientation.z * 127.0f);
-	dp->orientation[3] = (char)(currentOrientation.w * 127.0f);
-	*p = dp;
-	return true;
+void NetworkObject::CaptureState(NetworkState& state) const {
+	state.Quantise(object.GetTransform().GetPosition(), object.GetTransform().GetOrientation(), GetQuantisation());
 }
 
-bool NetworkObject::WriteFullPacket(GamePacket**p) {
-	FullPacket* fp = new FullPacket();
+bool NetworkObject::UpdateCapturedState(int stateID) {
+	uint32_t changeCount = object.GetTransform().GetChangeCount();
+	if (captured.stateID >= 0 && changeCount == capturedChangeCount) {
+		return false;
+	}
+	capturedChangeCount = changeCount;
 
-	fp->objectID = networkID;
-	fp->fullState.position = object.GetTransform().GetPosition();
-	fp->fullState.orientation = object.GetTransform().GetOrientation();
-	fp->fullState.stateID = lastFullState.stateID++;
-	*p = fp;
+	NetworkState state;
+	CaptureState(state);
+	//Small enough moves can quantise to exactly what we had, which still isn't a change
+	if (captured.stateID >= 0 &&
+		state.quantisedPosition[0]	== captured.quantisedPosition[0] &&
+		state.quantisedPosition[1]	== captured.quantisedPosition[1] &&
+		state.quantisedPosition[2]	== captured.quantisedPosition[2] &&
+		state.quantisedOrientation	== captured.quantisedOrientation) {
+		return false;
+	}
+	state.stateID	= stateID;
+	captured		= state;
 	return true;
 }
 
-NetworkState& NetworkObject::GetLatestNetworkState() {
-	return lastFullState;
+bool NetworkObject::WritePacket(BitWriter& stream, const NetworkState& state, const NetworkState* baseline) {
+	if (!baseline) {
+		WriteFullPacket(stream, state);
+		return true;
+	}
+	if (state.quantisedPosition[0]	== baseline->quantisedPosition[0] &&
+		state.quantisedPosition[1]	== baseline->quantisedPosition[1] &&
+		state.quantisedPosition[2]	== baseline->quantisedPosition[2] &&
+		state.quantisedOrientation	== baseline->quantisedOrientation) {
+		return false; //the client already has this exact state
+	}
+	WriteDeltaPacket(stream, state, *baseline);
+	return true;
 }
 
-bool NetworkObject::GetNetworkState(int stateID, NetworkState& state) {
-	for (auto i = stateHistory.begin(); i < stateHistory.end(); ++i) {
-		if ((*i).stateID == stateID) {
-			state = (*i);
-			return true;
-		}
+void NetworkObject::WriteDeltaPacket(BitWriter& stream, const NetworkState& state, const NetworkState& baseline) {
+	stream.WriteVarint(networkID);
+	stream.WriteBool(true);
+	for (int i = 0; i < 3; ++i) {
+		stream.WriteSignedCompact(state.quantisedPosition[i] - baseline.quantisedPosition[i]);
+	}
+	bool orientationChanged = state.quantisedOrientation != baseline.quantisedOrientation;
+	stream.WriteBool(orientationChanged);
+	if (orientationChanged) {
+		stream.WriteBits(state.quantisedOrientation, GetQuantisation().GetOrientationBits());
 	}
-	return false;
 }
 
-void NetworkObject::UpdateStateHistory(int minID) {
-	for (auto i = stateHistory.begin(); i < stateHistory.end(); ) {
-		if ((*i).stateID < minID) {
-			i = stateHistory.erase(i);
-		}
-		else {
-			++i;
-		}
+void NetworkObject::WriteFullPacket(BitWriter& stream, const NetworkState& state) {
+	const NetworkQuantisation& q = GetQuantisation();
+
+	stream.WriteVarint(networkID);
+	stream.WriteBool(false);
+	for (int i = 0; i < 3; ++i) {
+		stream.WriteBits(state.quantisedPosition[i], q.GetPositionBits(i));
 	}
-}
\ No newline at end of file
+	stream.WriteBits(state.quantisedOrientation, q.GetOrientationBits());
+}
@@ -3,37 +3,76 @@
 #include "NetworkBase.h"
 #include "NetworkState.h"
 
+#include <algorithm>
+
 namespace NCL::CSC8503 {
 	class GameObject;
-
-	struct FullPacket : public GamePacket {
-		int		objectID = -1;
-		NetworkState fullState;
-
-		FullPacket() {
-			type = Full_State;
-			size = sizeof(FullPacket) - sizeof(GamePacket);
-		}
+	class BitWriter;
+	class BitReader;
+
+	/*
+	One object's state in a snapshot, as it appears on the wire:
+
+	varint	objectID
+	1 bit	isDelta
+	full:	quantised position (see NetworkQuantisation), quantised orientation
+	delta:	compact signed difference per position axis, 1 bit orientation
+			changed, then the quantised orientation if it did
+
+	Deltas are always relative to the object's state in the snapshot's baseline
+	(see SnapshotHeader), so records don't need their own state IDs. They can be
+	read without knowing anything about the object, so a client can skip over
+	states for objects it doesn't have.
+	*/
+	struct NetworkStateRecord {
+		int			objectID		= -1;
+		bool		isDelta			= false;
+		int32_t		position[3]		= { 0, 0, 0 };	//for deltas, the difference from the baseline state
+		bool		hasOrientation	= false;
+		uint32_t	orientation		= 0;
 	};
 
-	struct DeltaPacket : public GamePacket {
-		int		fullID		= -1;
-		int		objectID	= -1;
-		char	pos[3];
-		char	orientation[4];
-
-		DeltaPacket() {
-			type = Delta_State;
-			size = sizeof(DeltaPacket) - sizeof(GamePacket);
-		}
+	//One fixed timestep's worth of a player's controls - what the buttons mean is up to the game
+	struct PlayerInput {
+		float	yaw		= 0.0f;
+		uint8_t	buttons	= 0;
 	};
 
+	const int MaxClientInputs = 16;
+
+	/*
+	Doubles as the client's acknowledgement - lastID is the newest snapshot it has
+	all of. It also carries every input the server hasn't acknowledged yet (see
+	SnapshotHeader::lastInput), oldest first, so a lost packet's inputs just
+	arrive in the next one. Only the inputs actually in use are sent, so the
+	packet's size varies.
+	*/
 	struct ClientPacket : public GamePacket {
-		int		lastID;
-		char	buttonstates[8];
+		int			lastID;
+		int			firstInput;	//the sequence number of inputs[0]
+		uint8_t		inputCount;
+		PlayerInput	inputs[MaxClientInputs];
 
 		ClientPacket() {
-			size = sizeof(ClientPacket);
+			type		= Received_State;
+			lastID		= -1;
+			firstInput	= 0;
+			SetInputCount(0);
+		}
+
+		static int GetHeaderSize() {
+			return (int)(sizeof(ClientPacket) - sizeof(inputs));
+		}
+
+		void SetInputCount(int count) {
+			inputCount	= (uint8_t)count;
+			size		= (short)(GetHeaderSize() + (sizeof(PlayerInput) * count) - sizeof(GamePacket));
+		}
+
+		//How many inputs a received packet really holds - never more than it's big enough for
+		int GetInputCount() const {
+			int fits = (GetTotalSize() - GetHeaderSize()) / (int)sizeof(PlayerInput);
+			return std::max(0, std::min({ (int)inputCount, fits, MaxClientInputs }));
 		}
 	};
 
@@ -42,34 +81,74 @@ namespace NCL::CSC8503 {
 		NetworkObject(GameObject& o, int id);
 		virtual ~NetworkObject();
 
-		//Called by clients
-		virtual bool ReadPacket(GamePacket& p);
-		//Called by servers
-		virtual bool WritePacket(GamePacket** p, bool deltaFrame, int stateID);
+		static void* operator new(size_t size);
+		static void  operator delete(void* p, size_t size);
 
-		void UpdateStateHistory(int minID);
-
-	protected:
+		static ObjectPool<NetworkObject>& GetPool();
 
-		NetworkState& GetLatestNetworkState();
+		//Shared by every object, and must match on the server and clients!
+		static NetworkQuantisation& GetQuantisation();
 
-		bool GetNetworkState(int frameID, NetworkState& state);
-
-		virtual bool ReadDeltaPacket(DeltaPacket &p);
-		virtual bool ReadFullPacket(FullPacket &p);
+		//Called by clients
+		static bool ReadRecord(BitReader& stream, NetworkStateRecord& record);
+		//Turns a record back into a state - deltas need the object's state from the snapshot's baseline
+		static bool DecodeRecord(const NetworkStateRecord& record, const NetworkState* baseline, NetworkState& state);
+		//false if we've already been moved to a newer state
+		virtual bool ReadPacket(const NetworkState& state);
+
+		/*
+		Interpolated objects don't move as soon as a state arrives - it goes on
+		their timeline instead, and UpdateInterpolation moves them to wherever
+		they were at the given server tick (see InterpolationClock). Objects that
+		are being predicted locally should turn this off, as should servers.
+		*/
+		void SetInterpolated(bool state);
+		bool IsInterpolated() const {
+			return interpolated;
+		}
+		void UpdateInterpolation(float renderTick);
 
-		virtual bool WriteDeltaPacket(GamePacket**p, int stateID);
-		virtual bool WriteFullPacket(GamePacket**p);
+		//Called by servers
+		void CaptureState(NetworkState& state) const;
+		/*
+		Only recaptures our state if the transform has been written to since the
+		last time, and returns true if the quantised state actually changed. The
+		captured state's stateID is the tick it last changed on, so an object
+		that's resting keeps the same one for as long as it stays put.
+		*/
+		bool UpdateCapturedState(int stateID);
+		const NetworkState& GetCapturedState() const {
+			return captured;
+		}
+		//Sent as a delta if the client has a baseline state for us, and not at all if nothing has changed since it
+		virtual bool WritePacket(BitWriter& stream, const NetworkState& state, const NetworkState* baseline);
 
-		GameObject& object;
+		int GetNetworkID() const {
+			return networkID;
+		}
 
-		NetworkState lastFullState;
+	protected:
+		virtual void WriteDeltaPacket(BitWriter& stream, const NetworkState& state, const NetworkState& baseline);
+		virtual void WriteFullPacket(BitWriter& stream, const NetworkState& state);
 
-		std::vector<NetworkState> stateHistory;
+		void AddToTimeline(const NetworkState& state);
 
-		int deltaErrors;
-		int fullErrors;
+		GameObject& object;
 
 		int networkID;
+		int lastStateID;	//datagrams can arrive out of order, so older states are ignored
+
+		//A ring of the newest states received, oldest first from timelineStart
+		static const int TimelineSize		= 8;
+		static const int TimelineHoldGap	= 4;	//in ticks, see AddToTimeline
+		static constexpr float MaxExtrapolationTicks = 1.0f;
+		NetworkState	timeline[TimelineSize];
+		int				timelineStart;
+		int				timelineCount;
+		bool			interpolated;
+		bool			settled;	//already showing the newest state, so there's nothing to do until another arrives
+
+		NetworkState	captured;
+		uint32_t		capturedChangeCount;
 	};
-}
\ No newline at end of file
+}
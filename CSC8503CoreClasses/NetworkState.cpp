@@ -1,11 +1,101 @@
 #include "NetworkState.h"
 
+#include <cmath>
+#include <algorithm>
+
 using namespace NCL;
 using namespace CSC8503;
 
+const float ComponentLimit = 0.70710678f; //the smallest three components are all within +/- 1 / sqrt(2)
+
 NetworkState::NetworkState()	{
 	stateID = 0;
+	quantisedPosition[0]	= 0;
+	quantisedPosition[1]	= 0;
+	quantisedPosition[2]	= 0;
+	quantisedOrientation	= 0;
 }
 
 NetworkState::~NetworkState()	{
-}
\ No newline at end of file
+}
+
+void NetworkState::Quantise(const Vector3& pos, const Quaternion& orient, const NetworkQuantisation& q) {
+	for (int i = 0; i < 3; ++i) {
+		quantisedPosition[i] = q.QuantisePosition(pos[i], i);
+	}
+	quantisedOrientation = q.QuantiseOrientation(orient);
+	Dequantise(q);
+}
+
+void NetworkState::Dequantise(const NetworkQuantisation& q) {
+	for (int i = 0; i < 3; ++i) {
+		position[i] = q.DequantisePosition(quantisedPosition[i], i);
+	}
+	orientation = q.DequantiseOrientation(quantisedOrientation);
+}
+
+int NetworkQuantisation::GetPositionBits(int axis) const {
+	float steps = (worldMax[axis] - worldMin[axis]) / positionResolution;
+	int bits = 1;
+	while (bits < 31 && (float)(1u << bits) <= steps) {
+		bits++;
+	}
+	return bits;
+}
+
+int32_t NetworkQuantisation::QuantisePosition(float value, int axis) const {
+	int32_t maxValue = (int32_t)((1u << GetPositionBits(axis)) - 1);
+	float	steps	 = std::round((value - worldMin[axis]) / positionResolution);
+	return (int32_t)std::clamp(steps, 0.0f, (float)maxValue);
+}
+
+float NetworkQuantisation::DequantisePosition(int32_t value, int axis) const {
+	return worldMin[axis] + (value * positionResolution);
+}
+
+uint32_t NetworkQuantisation::QuantiseOrientation(const Quaternion& q) const {
+	Quaternion	n = q.Normalised();
+	float		c[4] = { n.x, n.y, n.z, n.w };
+
+	int largest = 0;
+	for (int i = 1; i < 4; ++i) {
+		if (std::fabs(c[i]) > std::fabs(c[largest])) {
+			largest = i;
+		}
+	}
+	//q and -q are the same rotation, so flip it to make the largest positive - then it doesn't need a sign
+	float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+
+	uint32_t maxValue	= (1u << orientationBits) - 1;
+	uint32_t result		= (uint32_t)largest;
+	int		 shift		= 2;
+	for (int i = 0; i < 4; ++i) {
+		if (i == largest) {
+			continue;
+		}
+		float normalised = ((c[i] * sign) + ComponentLimit) / (2.0f * ComponentLimit);
+		uint32_t value	 = (uint32_t)std::clamp(std::round(normalised * maxValue), 0.0f, (float)maxValue);
+		result |= value << shift;
+		shift += orientationBits;
+	}
+	return result;
+}
+
+Quaternion NetworkQuantisation::DequantiseOrientation(uint32_t value) const {
+	uint32_t maxValue	= (1u << orientationBits) - 1;
+	int		 largest	= (int)(value & 3);
+	int		 shift		= 2;
+	float	 c[4];
+	float	 sumSquares = 0.0f;
+	for (int i = 0; i < 4; ++i) {
+		if (i == largest) {
+			continue;
+		}
+		uint32_t bits = (value >> shift) & maxValue;
+		c[i] = ((bits / (float)maxValue) * 2.0f * ComponentLimit) - ComponentLimit;
+		sumSquares += c[i] * c[i];
+		shift += orientationBits;
+	}
+	c[largest] = std::sqrt(std::max(0.0f, 1.0f - sumSquares));
+	return Quaternion(c[0], c[1], c[2], c[3]).Normalised();
+}
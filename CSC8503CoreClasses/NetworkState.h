@@ -1,17 +1,52 @@
 #pragma once
+#include <cstdint>
 
 namespace NCL {
 	using namespace Maths;
 	namespace CSC8503 {
-		//class GameObject;
+		class BitWriter;
+		class BitReader;
+
+		/*
+		How precisely states are sent over the network. Positions are sent as fixed
+		point numbers inside the world bounds (anything outside gets clamped), using
+		just enough bits per axis to hit positionResolution. Orientations are sent
+		as their three smallest components, as the largest can be worked out from
+		the other three.
+		*/
+		struct NetworkQuantisation {
+			Vector3 worldMin			= Vector3(-512.0f, -64.0f, -512.0f);
+			Vector3 worldMax			= Vector3(512.0f, 192.0f, 512.0f);
+			float	positionResolution	= 1.0f / 256.0f;
+			int		orientationBits		= 10;	//per component
+
+			int		GetPositionBits(int axis) const;
+			int32_t QuantisePosition(float value, int axis) const;
+			float	DequantisePosition(int32_t value, int axis) const;
+
+			uint32_t	QuantiseOrientation(const Quaternion& q) const;
+			Quaternion	DequantiseOrientation(uint32_t value) const;
+			int			GetOrientationBits() const {
+				return 2 + (orientationBits * 3);
+			}
+		};
+
+		//Plain data - so no virtual destructor, and no vtable pointer to send around
 		class NetworkState	{
 		public:
 			NetworkState();
-			virtual ~NetworkState();
+			~NetworkState();
+
+			//Fills in the quantised values, and snaps position / orientation to exactly what the other end will see
+			void Quantise(const Vector3& pos, const Quaternion& orient, const NetworkQuantisation& q);
+			void Dequantise(const NetworkQuantisation& q);
 
 			Vector3		position;
 			Quaternion	orientation;
 			int			stateID;
+
+			int32_t		quantisedPosition[3];
+			uint32_t	quantisedOrientation;
 		};
 	}
 }
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+struct GamePacket;
+
+namespace NCL {
+	namespace CSC8503 {
+		enum NetworkEventType {
+			Event_None,
+			Event_Connected,
+			Event_Disconnected,
+			Event_Received
+		};
+
+		//Something that's happened on the network, waiting for the game thread to deal with it
+		struct NetworkEvent {
+			int		type	= Event_None;
+			int		peerID	= -1;
+			char*	data	= nullptr;	//for received packets - only valid until the event is released
+			size_t	size	= 0;
+			void*	handle	= nullptr;	//whatever the transport needs to free the data again
+		};
+
+		/*
+		Gets packets to and from our peers. GameServer and GameClient only ever
+		talk to the network through one of these, so they don't care whether
+		it's really going over sockets (ENetTransport) or just across to another
+		object in the same process (LoopbackTransport).
+
+		All of these are called from the game thread. Whatever a transport does
+		behind the scenes, events come out of PopEvent in the order they happened,
+		and each one must be handed back to ReleaseEvent once it's been handled.
+		*/
+		class NetworkTransport	{
+		public:
+			virtual ~NetworkTransport() {}
+
+			//Servers are connected to, rather than connecting to anything themselves
+			virtual bool Connect(uint32_t address, int port) = 0;
+
+			//A peerID of -1 sends to every connected peer - for clients, that's just the server
+			virtual bool Send(int peerID, const GamePacket& packet) = 0;
+
+			virtual bool PopEvent(NetworkEvent& e) = 0;
+			virtual void ReleaseEvent(const NetworkEvent& e) = 0;
+		};
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <vector>
+#include <new>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A simple typed pool allocator. Objects are carved out of large blocks of slots,
+		so everything of the same type sits together in memory, and freeing an object
+		just pushes its slot back onto a free list instead of going back to the heap.
+
+		Classes that want to be pooled route their operator new / delete through
+		AllocateSized / FreeSized - anything that isn't exactly sizeof(T) (i.e a
+		derived class) falls back to the normal heap, so subclassing still works.
+		*/
+		template<class T, size_t SlotsPerBlock = 256>
+		class ObjectPool	{
+		public:
+			ObjectPool() {
+				freeList	= nullptr;
+				liveCount	= 0;
+			}
+			~ObjectPool() {
+				for (Slot* b : blocks) {
+					delete[] b;
+				}
+			}
+
+			void* Allocate() {
+				if (!freeList) {
+					AddBlock();
+				}
+				Slot* s		= freeList;
+				freeList	= s->next;
+				liveCount++;
+				return s->storage;
+			}
+
+			void Free(void* p) {
+				Slot* s		= (Slot*)p;
+				s->next		= freeList;
+				freeList	= s;
+				liveCount--;
+			}
+
+			void* AllocateSized(size_t size) {
+				if (size != sizeof(T)) {
+					return ::operator new(size);
+				}
+				return Allocate();
+			}
+
+			void FreeSized(void* p, size_t size) {
+				if (!p) {
+					return;
+				}
+				if (size != sizeof(T)) {
+					::operator delete(p);
+					return;
+				}
+				Free(p);
+			}
+
+			bool Owns(const void* p) const {
+				for (const Slot* b : blocks) {
+					if (p >= (const void*)b && p < (const void*)(b + SlotsPerBlock)) {
+						return true;
+					}
+				}
+				return false;
+			}
+
+			/*
+			Throws away every slot in one go, and rebuilds the free list in address order
+			so that the next batch of objects is handed out contiguously again. Only valid
+			once everything allocated from the pool has been destroyed!
+			*/
+			bool Reset() {
+				if (liveCount != 0) {
+					return false;
+				}
+				freeList = nullptr;
+				for (auto b = blocks.rbegin(); b != blocks.rend(); ++b) {
+					ThreadBlock(*b);
+				}
+				return true;
+			}
+
+			size_t GetLiveCount() const {
+				return liveCount;
+			}
+
+			size_t GetCapacity() const {
+				return blocks.size() * SlotsPerBlock;
+			}
+
+		protected:
+			union Slot {
+				Slot* next;
+				alignas(T) unsigned char storage[sizeof(T)];
+			};
+
+			void AddBlock() {
+				Slot* block = new Slot[SlotsPerBlock];
+				blocks.emplace_back(block);
+				ThreadBlock(block);
+			}
+
+			void ThreadBlock(Slot* block) {
+				for (size_t i = SlotsPerBlock; i > 0; --i) {
+					block[i - 1].next	= freeList;
+					freeList			= &block[i - 1];
+				}
+			}
+
+			std::vector<Slot*>	blocks;
+			Slot*				freeList;
+			size_t				liveCount;
+		};
+	}
+}
@@ -0,0 +1,99 @@
+#include "PathCache.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace NCL;
+using namespace CSC8503;
+
+PathCache::PathCache(NavigationGrid& grid, size_t capacity, GridSearchMode mode) : grid(grid) {
+	this->capacity	= std::max((size_t)1, capacity);
+	this->mode		= mode;
+	hits			= 0;
+	misses			= 0;
+
+	listenerID = grid.AddChangeListener([this](const std::vector<int>& changedNodes) {
+		for (int node : changedNodes) {
+			OnNodeChanged(node % this->grid.GetGridWidth(), node / this->grid.GetGridWidth());
+		}
+	});
+}
+
+PathCache::~PathCache() {
+	grid.RemoveChangeListener(listenerID);
+}
+
+void PathCache::Clear() {
+	entries.clear();
+	lookup.clear();
+}
+
+bool PathCache::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
+	int startIndex	= grid.GetNodeIndex(from);
+	int endIndex	= grid.GetNodeIndex(to);
+
+	if (startIndex < 0 || endIndex < 0) {
+		return false; //outside of map region!
+	}
+	uint64_t key = ((uint64_t)startIndex << 32) | (uint32_t)endIndex;
+
+	auto cached = lookup.find(key);
+	if (cached != lookup.end()) {
+		hits++;
+		entries.splice(entries.begin(), entries, cached->second); //it's now the most recently used
+		for (const Vector3& wp : cached->second->waypoints) {
+			outPath.PushWaypoint(wp);
+		}
+		return cached->second->found;
+	}
+	misses++;
+
+	CachedPath entry;
+	entry.key	= key;
+	entry.found	= grid.FindPath(from, to, outPath, scratch, mode);
+
+	if (entry.found) {
+		NavigationPath copy = outPath;
+		Vector3 wp;
+		while (copy.PopWaypoint(wp)) {	//pops come out in reverse order to how they were pushed
+			entry.waypoints.emplace_back(wp);
+		}
+		std::reverse(entry.waypoints.begin(), entry.waypoints.end());
+
+		int size = grid.GetNodeSize();
+		entry.bounds = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+		for (const Vector3& p : entry.waypoints) {
+			int x = (int)p.x / size;
+			int y = (int)p.z / size;
+			entry.bounds.minX = std::min(entry.bounds.minX, x);
+			entry.bounds.minY = std::min(entry.bounds.minY, y);
+			entry.bounds.maxX = std::max(entry.bounds.maxX, x);
+			entry.bounds.maxY = std::max(entry.bounds.maxY, y);
+		}
+	}
+	else {
+		entry.bounds = { 0, 0, grid.GetGridWidth() - 1, grid.GetGridHeight() - 1 };
+	}
+
+	if (entries.size() >= capacity) {
+		lookup.erase(entries.back().key);
+		entries.pop_back();
+	}
+	entries.push_front(std::move(entry));
+	lookup[key] = entries.begin();
+
+	return entries.front().found;
+}
+
+void PathCache::OnNodeChanged(int x, int y) {
+	for (auto i = entries.begin(); i != entries.end(); ) {
+		const GridRect& b = i->bounds;
+		if (x >= b.minX && x <= b.maxX && y >= b.minY && y <= b.maxY) {
+			lookup.erase(i->key);
+			i = entries.erase(i);
+		}
+		else {
+			++i;
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "NavigationGrid.h"
+
+#include <list>
+#include <unordered_map>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Sits in front of a NavigationGrid, and remembers the paths it has found -
+		lots of agents end up asking for the same routes over and over (from a
+		spawn point to the player, between patrol points, etc). As grid paths only
+		depend on which nodes the start and end are in, that's what they're keyed by.
+
+		When a node changes type, any cached path whose bounding rectangle covers
+		that node is thrown away, as it might now walk through a wall. Paths that
+		were never found can't be bounded like that, so any change at all throws
+		those away. Once the cache is full, the least recently used path goes.
+		*/
+		class PathCache : public NavigationMap	{
+		public:
+			PathCache(NavigationGrid& grid, size_t capacity = 256, GridSearchMode mode = AStarSearch);
+			~PathCache();
+
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
+
+			void Clear();
+
+			size_t GetSize() const {
+				return entries.size();
+			}
+			size_t GetHitCount() const {
+				return hits;
+			}
+			size_t GetMissCount() const {
+				return misses;
+			}
+
+		protected:
+			struct CachedPath {
+				uint64_t				key;
+				bool					found;
+				GridRect				bounds;
+				std::vector<Vector3>	waypoints;	//in the order they were pushed
+			};
+			typedef std::list<CachedPath> EntryList;
+
+			void OnNodeChanged(int x, int y);
+
+			NavigationGrid&		grid;
+			GridSearchMode		mode;
+			GridSearchScratch	scratch;
+			size_t				capacity;
+			int					listenerID;
+
+			EntryList entries;	//most recently used at the front
+			std::unordered_map<uint64_t, EntryList::iterator> lookup;
+
+			size_t hits;
+			size_t misses;
+		};
+	}
+}
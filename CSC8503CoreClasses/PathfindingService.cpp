@@ -0,0 +1,145 @@
+#include "PathfindingService.h"
+
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+PathfindingService::PathfindingService(const NavigationGrid& grid, int workerCount) : grid(grid) {
+	quit			= false;
+	pauseCount		= 0;
+	activeSearches	= 0;
+
+	if (workerCount <= 0) { //leave one core free for the game thread
+		workerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+	}
+	for (int i = 0; i < workerCount; ++i) {
+		workers.emplace_back(&PathfindingService::WorkerThread, this);
+	}
+}
+
+PathfindingService::~PathfindingService() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		quit = true;
+	}
+	wakeUp.notify_all();
+
+	for (std::thread& t : workers) {
+		t.join();
+	}
+	//anything nobody got round to is reported as a failed search, rather than a broken promise
+	for (PathRequestPtr& r : queue) {
+		r->promise.set_value(PathResult());
+	}
+}
+
+std::shared_future<PathResult> PathfindingService::RequestPath(const Vector3& from, const Vector3& to) {
+	return RequestPath(from, to, nullptr);
+}
+
+std::shared_future<PathResult> PathfindingService::RequestPath(const Vector3& from, const Vector3& to, PathCallback callback) {
+	int startIndex	= grid.GetNodeIndex(from);
+	int endIndex	= grid.GetNodeIndex(to);
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	if (startIndex < 0 || endIndex < 0) { //no point bothering the workers with this one
+		std::promise<PathResult> failed;
+		failed.set_value(PathResult());
+		std::shared_future<PathResult> future = failed.get_future().share();
+		if (callback) {
+			completed.push_back({ callback, future });
+		}
+		return future;
+	}
+
+	uint64_t key = ((uint64_t)startIndex << 32) | (uint32_t)endIndex;
+
+	auto existing = pending.find(key);
+	if (existing != pending.end()) {
+		if (callback) {
+			existing->second->callbacks.emplace_back(callback);
+		}
+		return existing->second->future;
+	}
+
+	PathRequestPtr r = std::make_shared<PathRequest>();
+	r->from		= from;
+	r->to		= to;
+	r->key		= key;
+	r->future	= r->promise.get_future().share();
+	if (callback) {
+		r->callbacks.emplace_back(callback);
+	}
+	pending.insert({ key, r });
+	queue.emplace_back(r);
+
+	wakeUp.notify_one();
+	return r->future;
+}
+
+void PathfindingService::DispatchCallbacks() {
+	std::vector<CompletedCallback> toRun;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		toRun.swap(completed);
+	}
+	for (CompletedCallback& c : toRun) {
+		c.callback(c.future.get());
+	}
+}
+
+size_t PathfindingService::GetPendingCount() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return pending.size();
+}
+
+void PathfindingService::Pause() {
+	std::unique_lock<std::mutex> guard(lock);
+	pauseCount++;
+	idle.wait(guard, [&] { return activeSearches == 0; });
+}
+
+void PathfindingService::Resume() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (pauseCount == 0 || --pauseCount > 0) {
+			return;
+		}
+	}
+	wakeUp.notify_all();
+}
+
+void PathfindingService::WorkerThread() {
+	GridSearchScratch scratch;
+
+	while (true) {
+		PathRequestPtr r;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			wakeUp.wait(guard, [&] { return quit || (pauseCount == 0 && !queue.empty()); });
+			if (quit) {
+				return;
+			}
+			r = queue.front();
+			queue.pop_front();
+			activeSearches++;
+		}
+
+		PathResult result;
+		result.found = grid.FindPath(r->from, r->to, result.path, scratch);
+
+		{	//once it's out of pending, no more callbacks can be attached to it
+			std::lock_guard<std::mutex> guard(lock);
+			pending.erase(r->key);
+			r->promise.set_value(std::move(result));
+			for (PathCallback& c : r->callbacks) {
+				completed.push_back({ c, r->future });
+			}
+			if (--activeSearches == 0) {
+				idle.notify_all();
+			}
+		}
+	}
+}
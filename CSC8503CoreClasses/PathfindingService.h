@@ -0,0 +1,96 @@
+#pragma once
+#include "NavigationGrid.h"
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace NCL {
+	namespace CSC8503 {
+		struct PathResult {
+			bool			found = false;
+			NavigationPath	path;
+		};
+
+		typedef std::function<void(const PathResult&)> PathCallback;
+
+		/*
+		Runs NavigationGrid searches on a pool of worker threads, so that lots of
+		agents can ask for a new path in the same frame without it showing up in the
+		frame time. Each worker has its own GridSearchScratch, so they can all search
+		the same grid at once.
+
+		Requests that start and end in the same pair of grid cells would produce the
+		same path, so while one is still waiting (or running), any duplicates just
+		attach themselves to it rather than doing the search again.
+
+		Results can be picked up either from the returned future, or by passing in a
+		callback - callbacks are run on whichever thread calls DispatchCallbacks (i.e
+		the game thread, once per frame), so they're free to touch game state.
+
+		The grid must not be changed while a search might be running on it - wrap
+		any changes in Pause / Resume, which waits for the searches in flight to
+		finish, and holds the workers back from starting any more until Resume.
+		Requests can still be made while paused, they just queue up.
+		*/
+		class PathfindingService	{
+		public:
+			PathfindingService(const NavigationGrid& grid, int workerCount = 0);
+			~PathfindingService();
+
+			std::shared_future<PathResult> RequestPath(const Vector3& from, const Vector3& to);
+			std::shared_future<PathResult> RequestPath(const Vector3& from, const Vector3& to, PathCallback callback);
+
+			void DispatchCallbacks();
+
+			size_t GetPendingCount() const;
+
+			//Blocks until no searches are running - can be nested
+			void Pause();
+			void Resume();
+
+			int GetWorkerCount() const {
+				return (int)workers.size();
+			}
+
+		protected:
+			struct PathRequest {
+				Vector3		from;
+				Vector3		to;
+				uint64_t	key;
+
+				std::promise<PathResult>		promise;
+				std::shared_future<PathResult>	future;
+				std::vector<PathCallback>		callbacks;
+			};
+			typedef std::shared_ptr<PathRequest> PathRequestPtr;
+
+			struct CompletedCallback {
+				PathCallback					callback;
+				std::shared_future<PathResult>	future;
+			};
+
+			void WorkerThread();
+
+			const NavigationGrid&	grid;
+
+			std::vector<std::thread>			workers;
+			std::deque<PathRequestPtr>			queue;
+			std::map<uint64_t, PathRequestPtr>	pending;	//queued or in flight, by (start cell, end cell)
+			std::vector<CompletedCallback>		completed;
+
+			mutable std::mutex		lock;
+			std::condition_variable	wakeUp;
+			std::condition_variable	idle;
+			bool					quit;
+			int						pauseCount;
+			int						activeSearches;
+		};
+	}
+}
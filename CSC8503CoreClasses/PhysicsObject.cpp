@@ -17,6 +17,19 @@ PhysicsObject::~PhysicsObject()	{
 
 }
 
+void* PhysicsObject::operator new(size_t size) {
+	return GetPool().AllocateSized(size);
+}
+
+void PhysicsObject::operator delete(void* p, size_t size) {
+	GetPool().FreeSized(p, size);
+}
+
+ObjectPool<PhysicsObject>& PhysicsObject::GetPool() {
+	static ObjectPool<PhysicsObject> pool;
+	return pool;
+}
+
 void PhysicsObject::ApplyAngularImpulse(const Vector3& force) {
 	angularVelocity += inverseInteriaTensor * force;
 }
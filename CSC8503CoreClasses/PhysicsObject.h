@@ -1,4 +1,5 @@
 #pragma once
+#include "ObjectPool.h"
 using namespace NCL::Maths;
 
 namespace NCL {
@@ -12,6 +13,11 @@ namespace NCL {
 			PhysicsObject(Transform* parentTransform, const CollisionVolume* parentVolume);
 			~PhysicsObject();
 
+			static void* operator new(size_t size);
+			static void  operator delete(void* p, size_t size);
+
+			static ObjectPool<PhysicsObject>& GetPool();
+
 			Vector3 GetLinearVelocity() const {
 				return linearVelocity;
 			}
@@ -175,9 +175,11 @@ void PhysicsSystem::UpdateCollisionList() {
 }
 
 void PhysicsSystem::UpdateObjectAABBs() {
-	gameWorld.OperateOnContents(
-		[](GameObject* g) {
-			g->UpdateBroadphaseAABB();
+	gameWorld.OperateOnArchetypes(VolumeComponent,
+		[](Archetype& a) {
+			for (GameObject* g : a.objects) {
+				g->UpdateBroadphaseAABB();
+			}
 		}
 	);
 }
@@ -192,23 +194,19 @@ a particular pair will only be added once, so objects colliding for
 multiple frames won't flood the set with duplicates.
 */
 void PhysicsSystem::BasicCollisionDetection() {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-
-	// Get all objects in the game world
-	gameWorld.GetObjectIterators(first, last);
+	// Gather every object with a physics component, straight from the archetypes
+	physicsObjects.clear();
+	gameWorld.OperateOnArchetypes(PhysicsComponent,
+		[&](Archetype& a) {
+			physicsObjects.insert(physicsObjects.end(), a.objects.begin(), a.objects.end());
+		}
+	);
+	auto first	= physicsObjects.begin();
+	auto last	= physicsObjects.end();
 
 	// Loop through all pairs of objects
 	for (auto i = first; i != last; ++i) {
-		if ((*i)->GetPhysicsObject() == nullptr) {
-			continue; // Skip objects without physics components
-		}
-
 		for (auto j = i + 1; j != last; ++j) {
-			if ((*j)->GetPhysicsObject() == nullptr) {
-				continue; // Skip objects without physics components
-			}
-
 			CollisionDetection::CollisionInfo info;
 
 			// Check for collision between the two objects
@@ -309,21 +307,16 @@ void PhysicsSystem::BroadPhase() {
 	// Create a quadtree with specified dimensions and depth
 	QuadTree<GameObject*> tree(Vector2(1024, 1024), 7, 6);
 
-	// Get iterators for all objects in the game world
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
-
-	// Insert all objects into the quadtree
-	for (auto i = first; i != last; ++i) {
-		Vector3 halfSizes;
-		if (!(*i)->GetBroadphaseAABB(halfSizes)) {
-			continue; // Skip objects without a valid AABB
+	// Insert every object that has a bounding volume into the quadtree
+	gameWorld.OperateOnArchetypes(VolumeComponent,
+		[&](Archetype& a) {
+			for (size_t i = 0; i < a.Size(); ++i) {
+				Vector3 halfSizes;
+				a.objects[i]->GetBroadphaseAABB(halfSizes);
+				tree.Insert(a.objects[i], a.transforms[i]->GetPosition(), halfSizes);
+			}
 		}
-
-		Vector3 pos = (*i)->GetTransform().GetPosition();
-		tree.Insert(*i, pos, halfSizes);
-	}
+	);
 
 	// Operate on the quadtree to gather potential collision pairs
 	tree.OperateOnContents(
@@ -373,50 +366,47 @@ based on any forces that have been accumulated in the objects during
 the course of the previous game frame.
 */
 void PhysicsSystem::IntegrateAccel(float dt) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-
-	gameWorld.GetObjectIterators(first, last);
-
-	for (auto i = first; i != last; ++i) {
-		PhysicsObject* object = (*i)->GetPhysicsObject();
-
-		if (object == nullptr) {
-			continue; // No physics object for this GameObject
+	gameWorld.OperateOnArchetypes(PhysicsComponent,
+		[&](Archetype& a) {
+			for (PhysicsObject* object : a.physics) {
+				IntegrateAccel(*object, dt);
+			}
 		}
+	);
+}
 
-		float inverseMass = object->GetInverseMass();
-		Vector3 linearVel = object->GetLinearVelocity();
-		Vector3 force = object->GetForce();
+void PhysicsSystem::IntegrateAccel(PhysicsObject& object, float dt) {
+	float inverseMass = object.GetInverseMass();
+	Vector3 linearVel = object.GetLinearVelocity();
+	Vector3 force = object.GetForce();
 
-		// Calculate acceleration from force and mass
-		Vector3 accel = force * inverseMass;
+	// Calculate acceleration from force and mass
+	Vector3 accel = force * inverseMass;
 
-		// Apply gravity if enabled and object is not infinitely massive
-		if (applyGravity && inverseMass > 0) {
-			accel += gravity;
-		}
+	// Apply gravity if enabled and object is not infinitely massive
+	if (applyGravity && inverseMass > 0) {
+		accel += gravity;
+	}
 
-		// Integrate acceleration into velocity
-		linearVel += accel * dt;
-		object->SetLinearVelocity(linearVel);
+	// Integrate acceleration into velocity
+	linearVel += accel * dt;
+	object.SetLinearVelocity(linearVel);
 
-		// Angular integration additions
-		Vector3 torque = object->GetTorque();
-		Vector3 angVel = object->GetAngularVelocity();
+	// Angular integration additions
+	Vector3 torque = object.GetTorque();
+	Vector3 angVel = object.GetAngularVelocity();
 
-		// Update the inertia tensor based on the current orientation
-		object->UpdateInertiaTensor();
+	// Update the inertia tensor based on the current orientation
+	object.UpdateInertiaTensor();
 
-		// Calculate angular acceleration using the inertia tensor
-		Vector3 angAccel = object->GetInertiaTensor() * torque;
+	// Calculate angular acceleration using the inertia tensor
+	Vector3 angAccel = object.GetInertiaTensor() * torque;
 
-		// Integrate angular acceleration into angular velocity
-		angVel += angAccel * dt;
+	// Integrate angular acceleration into angular velocity
+	angVel += angAccel * dt;
 
-		// Update the angular velocity of the object
-		object->SetAngularVelocity(angVel);
-	}
+	// Update the angular velocity of the object
+	object.SetAngularVelocity(angVel);
 }
 
 /*
@@ -426,50 +416,45 @@ throughout a physics update, to slowly move the objects through
 the world, looking for collisions.
 */
 void PhysicsSystem::IntegrateVelocity(float dt) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-
-	gameWorld.GetObjectIterators(first, last);
+	gameWorld.OperateOnArchetypes(PhysicsComponent,
+		[&](Archetype& a) {
+			for (size_t i = 0; i < a.Size(); ++i) {
+				IntegrateVelocity(*a.physics[i], *a.transforms[i], dt);
+			}
+		}
+	);
+}
 
+void PhysicsSystem::IntegrateVelocity(PhysicsObject& object, Transform& transform, float dt) {
 	// Calculate linear damping based on the frame time
 	float frameLinearDamping = 1.0f - (0.4f * dt);
 
-	for (auto i = first; i != last; ++i) {
-		PhysicsObject* object = (*i)->GetPhysicsObject();
-
-		if (object == nullptr) {
-			continue; // No physics object for this GameObject
-		}
+	// Integrate velocity into position
+	Vector3 position = transform.GetPosition();
+	Vector3 linearVel = object.GetLinearVelocity();
 
-		Transform& transform = (*i)->GetTransform();
+	position += linearVel * dt;
+	transform.SetPosition(position);
 
-		// Integrate velocity into position
-		Vector3 position = transform.GetPosition();
-		Vector3 linearVel = object->GetLinearVelocity();
+	// Apply linear damping to velocity
+	linearVel = linearVel * frameLinearDamping;
+	object.SetLinearVelocity(linearVel);
 
-		position += linearVel * dt;
-		transform.SetPosition(position);
+	// Orientation integration additions
+	Quaternion orientation = transform.GetOrientation();
+	Vector3 angVel = object.GetAngularVelocity();
 
-		// Apply linear damping to velocity
-		linearVel = linearVel * frameLinearDamping;
-		object->SetLinearVelocity(linearVel);
+	// Integrate angular velocity into the orientation quaternion
+	orientation = orientation + (Quaternion(angVel * dt * 0.5f, 0.0f) * orientation);
+	orientation.Normalise();
 
-		// Orientation integration additions
-		Quaternion orientation = transform.GetOrientation();
-		Vector3 angVel = object->GetAngularVelocity();
+	// Update the object's orientation
+	transform.SetOrientation(orientation);
 
-		// Integrate angular velocity into the orientation quaternion
-		orientation = orientation + (Quaternion(angVel * dt * 0.5f, 0.0f) * orientation);
-		orientation.Normalise();
-
-		// Update the object's orientation
-		transform.SetOrientation(orientation);
-
-		// Apply damping to the angular velocity
-		float frameAngularDamping = 1.0f - (0.4f * dt);
-		angVel = angVel * frameAngularDamping;
-		object->SetAngularVelocity(angVel);
-	}
+	// Apply damping to the angular velocity
+	float frameAngularDamping = 1.0f - (0.4f * dt);
+	angVel = angVel * frameAngularDamping;
+	object.SetAngularVelocity(angVel);
 }
 
 /*
@@ -478,9 +463,11 @@ clear out any accumulated forces, ready to receive new
 ones in the next 'game' frame.
 */
 void PhysicsSystem::ClearForces() {
-	gameWorld.OperateOnContents(
-		[](GameObject* o) {
-			o->GetPhysicsObject()->ClearForces();
+	gameWorld.OperateOnArchetypes(PhysicsComponent,
+		[](Archetype& a) {
+			for (PhysicsObject* o : a.physics) {
+				o->ClearForces();
+			}
 		}
 	);
 }
@@ -31,6 +31,9 @@ namespace NCL {
 			void IntegrateAccel(float dt);
 			void IntegrateVelocity(float dt);
 
+			void IntegrateAccel(PhysicsObject& object, float dt);
+			void IntegrateVelocity(PhysicsObject& object, Transform& transform, float dt);
+
 			void UpdateConstraints(float dt);
 
 			void UpdateCollisionList();
@@ -48,6 +51,7 @@ namespace NCL {
 			std::set<CollisionDetection::CollisionInfo> allCollisions;
 			std::set<CollisionDetection::CollisionInfo> broadphaseCollisions;
 			std::vector<CollisionDetection::CollisionInfo> broadphaseCollisionsVec;
+			std::vector<GameObject*> physicsObjects;
 			bool useBroadPhase		= true;
 			int numCollisionFrames	= 5;
 		};
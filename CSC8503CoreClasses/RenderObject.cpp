@@ -17,4 +17,17 @@ RenderObject::RenderObject(Transform* parentTransform, Mesh* mesh, Texture* tex,
 
 RenderObject::~RenderObject() {
 
+}
+
+void* RenderObject::operator new(size_t size) {
+	return GetPool().AllocateSized(size);
+}
+
+void RenderObject::operator delete(void* p, size_t size) {
+	GetPool().FreeSized(p, size);
+}
+
+ObjectPool<RenderObject>& RenderObject::GetPool() {
+	static ObjectPool<RenderObject> pool;
+	return pool;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Texture.h"
 #include "Shader.h"
 #include "Mesh.h"
+#include "ObjectPool.h"
 
 namespace NCL {
 	using namespace NCL::Rendering;
@@ -16,6 +17,11 @@ namespace NCL {
 			RenderObject(Transform* parentTransform, Mesh* mesh, Texture* tex, Shader* shader);
 			~RenderObject();
 
+			static void* operator new(size_t size);
+			static void  operator delete(void* p, size_t size);
+
+			static ObjectPool<RenderObject>& GetPool();
+
 			void SetDefaultTexture(Texture* t) {
 				texture = t;
 			}
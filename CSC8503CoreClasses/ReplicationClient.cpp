@@ -0,0 +1,114 @@
+#include "ReplicationClient.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+ReplicationClient::ReplicationClient() {
+	predictedObject = -1;
+	Reset();
+}
+
+ReplicationClient::~ReplicationClient() {
+}
+
+void ReplicationClient::Reset() {
+	receivedSnapshots.Clear();
+	interpolation.Reset();
+	latestSnapshot	= -1;
+	lastCorrection	= -1;
+	hasCorrection	= false;
+	correctionInput = -1;
+}
+
+void ReplicationClient::SetPredictedObject(int networkID) {
+	predictedObject = networkID;
+	hasCorrection	= false;
+}
+
+/*
+A snapshot starts off as a copy of its baseline, and then has each record
+applied to it as its datagrams arrive. As each object is in a snapshot at most
+once, the copy still holds the baseline state for any object not yet read, so
+that's what deltas are applied to. Only once every datagram has arrived is the
+snapshot complete, and so safe for the server to use as a baseline.
+*/
+bool ReplicationClient::ReadSnapshot(GamePacket& payload, const std::vector<NetworkObject*>& networkObjects) {
+	SnapshotHeader header;
+	if (!SnapshotBuilder::ReadHeader(payload, header)) {
+		return false;
+	}
+	WorldSnapshot* current = receivedSnapshots.Get(header.snapshotID);
+	if (!current) {
+		if (header.snapshotID <= latestSnapshot) {
+			return false; //we already have something newer
+		}
+		const WorldSnapshot* baseline = nullptr;
+		if (header.baselineID >= 0) {
+			baseline = receivedSnapshots.Get(header.baselineID);
+			if (!baseline || !baseline->IsComplete()) {
+				latestSnapshot = -1; //we've lost the state the server thinks we have, so ask for full states
+				return false;
+			}
+		}
+		current = &receivedSnapshots.Begin(header.snapshotID, baseline);
+		current->datagramsReceived.resize(header.datagramCount, 0);
+		current->datagramsRemaining = header.datagramCount;
+		interpolation.OnSnapshotReceived(header.snapshotID);
+	}
+	if (header.datagramIndex >= current->datagramsReceived.size() || current->datagramsReceived[header.datagramIndex]) {
+		return false;
+	}
+	current->datagramsReceived[header.datagramIndex] = 1;
+
+	bool read = SnapshotBuilder::ReadBatch(payload, [&](BitReader& stream) {
+		NetworkStateRecord	record;
+		NetworkState		state;
+		if (!NetworkObject::ReadRecord(stream, record) ||
+			!NetworkObject::DecodeRecord(record, current->GetState(record.objectID), state)) {
+			return false;
+		}
+		state.stateID = header.snapshotID;
+		current->SetState(record.objectID, state);
+
+		if (record.objectID != predictedObject && record.objectID < (int)networkObjects.size() && networkObjects[record.objectID]) {
+			networkObjects[record.objectID]->ReadPacket(state);
+		}
+		return true;
+	});
+	//The predicted object is always in the first datagram if it's changed, and if it hasn't, the baseline already has it
+	if (read && header.datagramIndex == 0 && predictedObject >= 0 && header.snapshotID > lastCorrection) {
+		const NetworkState* state = current->GetState(predictedObject);
+		if (state) {
+			correction		= *state;
+			correctionInput = header.lastInput;
+			lastCorrection	= header.snapshotID;
+			hasCorrection	= true;
+		}
+	}
+	if (read && --current->datagramsRemaining == 0) {
+		latestSnapshot = std::max(latestSnapshot, header.snapshotID);
+	}
+	return read;
+}
+
+void ReplicationClient::UpdateInterpolation(float dt, const std::vector<NetworkObject*>& networkObjects) {
+	float renderTick = interpolation.Update(dt);
+	if (!interpolation.IsRunning()) {
+		return;
+	}
+	for (NetworkObject* o : networkObjects) {
+		if (o) {
+			o->UpdateInterpolation(renderTick);
+		}
+	}
+}
+
+bool ReplicationClient::PopCorrection(NetworkState& state, int& lastInput) {
+	if (!hasCorrection) {
+		return false;
+	}
+	state			= correction;
+	lastInput		= correctionInput;
+	hasCorrection	= false;
+	return true;
+}
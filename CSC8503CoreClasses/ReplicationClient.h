@@ -0,0 +1,61 @@
+#pragma once
+#include "SnapshotBuilder.h"
+#include "SnapshotHistory.h"
+#include "InterpolationClock.h"
+#include "NetworkObject.h"
+
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		The client's half of ReplicationServer - rebuilds each snapshot from its
+		datagrams, hands the states on to the objects they're for, and keeps track
+		of which snapshot to acknowledge.
+
+		One object can be predicted locally instead (see SetPredictedObject). Its
+		states aren't applied - instead, each time a newer snapshot arrives, the
+		state is kept along with the newest of our inputs the server had applied
+		by then, for the game to correct its prediction with (see PopCorrection).
+		*/
+		class ReplicationClient	{
+		public:
+			ReplicationClient();
+			~ReplicationClient();
+
+			void Reset();
+
+			//-1 if nothing is being predicted
+			void SetPredictedObject(int networkID);
+
+			//Reads one datagram of a snapshot - networkObjects is indexed by network ID
+			bool ReadSnapshot(GamePacket& payload, const std::vector<NetworkObject*>& networkObjects);
+
+			//Moves every interpolated object along to wherever it was at the clock's render time
+			void UpdateInterpolation(float dt, const std::vector<NetworkObject*>& networkObjects);
+
+			//True at most once per snapshot, if it had a newer state for the predicted object
+			bool PopCorrection(NetworkState& state, int& lastInput);
+
+			//The newest snapshot we have every datagram of, to acknowledge - -1 asks for full states
+			int GetLatestSnapshot() const {
+				return latestSnapshot;
+			}
+
+			InterpolationClock& GetClock() {
+				return interpolation;
+			}
+
+		protected:
+			SnapshotHistory		receivedSnapshots;
+			int					latestSnapshot;
+			InterpolationClock	interpolation;
+
+			int				predictedObject;
+			int				lastCorrection;	//the snapshot the newest correction came from
+			bool			hasCorrection;
+			NetworkState	correction;
+			int				correctionInput;
+		};
+	}
+}
@@ -0,0 +1,140 @@
+#include "ReplicationServer.h"
+#include "GameServer.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+ReplicationServer::ReplicationServer() {
+	snapshotCounter		= 0;
+	snapshotByteBudget	= SnapshotDatagramSize * 2;
+	refreshInterval		= 200;
+}
+
+ReplicationServer::~ReplicationServer() {
+}
+
+void ReplicationServer::AddClient(int peerID) {
+	clientStates[peerID] = ClientState();
+}
+
+void ReplicationServer::RemoveClient(int peerID) {
+	clientStates.erase(peerID);
+}
+
+void ReplicationServer::SetClientPlayer(int peerID, GameObject* player) {
+	auto client = clientStates.find(peerID);
+	if (client != clientStates.end()) {
+		client->second.player = player;
+	}
+}
+
+bool ReplicationServer::ReceiveClientPacket(int peerID, GamePacket& payload, const InputFunc& applyInput) {
+	auto client = clientStates.find(peerID);
+	if (client == clientStates.end() || payload.type != Received_State || payload.GetTotalSize() < ClientPacket::GetHeaderSize()) {
+		return false;
+	}
+	ClientPacket*	packet	= (ClientPacket*)&payload;
+	ClientState&	state	= client->second;
+	//Acks can arrive out of order - but -1 always gets through, as it means the client has lost its baseline
+	if (packet->lastID == -1 || packet->lastID > state.lastAcked) {
+		state.lastAcked = packet->lastID;
+	}
+	//Inputs get resent until they're acknowledged, so most of these we'll have already seen
+	int inputCount = packet->GetInputCount();
+	for (int n = 0; n < inputCount; ++n) {
+		int sequence = packet->firstInput + n;
+		if (sequence > state.lastInput) {
+			if (applyInput) {
+				applyInput(packet->inputs[n]);
+			}
+			state.lastInput = sequence;
+		}
+	}
+	return true;
+}
+
+/*
+Only objects whose transforms have been written to since the last tick get
+their state recaptured (see NetworkObject::UpdateCapturedState), and each
+state's stateID is the tick it last changed on. So for each client, any object
+whose state in the client's baseline has the same stateID as now is already
+up to date, and can be skipped without looking at it any further - a world
+that's mostly resting costs next to nothing past the objects that moved.
+
+Deltas against acknowledged baselines shouldn't ever leave a client with the
+wrong state, but if one ever did, a resting object would never get sent again
+to put it right. So every tick, a slice of the network IDs are forgotten from
+each client's snapshot, which has them sent again as full states - after
+refreshInterval ticks, every object the client can see has been refreshed.
+*/
+void ReplicationServer::SendSnapshots(GameWorld& world, const std::vector<NetworkObject*>& networkObjects, GameServer& server) {
+	int snapshotID = snapshotCounter++;
+
+	worldState.snapshotID = snapshotID;
+	std::fill(worldState.hasState.begin(), worldState.hasState.end(), 0);
+	world.OperateOnArchetypes(NetworkComponent,
+		[&](Archetype& a) {
+			for (NetworkObject* o : a.networks) {
+				o->UpdateCapturedState(snapshotID);
+				worldState.SetState(o->GetNetworkID(), o->GetCapturedState());
+			}
+		}
+	);
+	interest.Update(worldState);
+
+	for (auto& i : clientStates) {
+		ClientState& client = i.second;
+
+		//Starts off as a copy of the baseline, so until an object is
+		//written to it, it holds the state the client already has
+		WorldSnapshot& sent = client.sent.Begin(snapshotID, client.sent.Get(client.lastAcked));
+
+		if (refreshInterval > 0) {
+			//Offset by peer, so that clients don't all refresh the same objects on the same tick
+			for (int id = (snapshotID + i.first) % refreshInterval; id < (int)sent.hasState.size(); id += refreshInterval) {
+				sent.hasState[id] = 0;
+			}
+		}
+
+		bool	hasPlayer	= client.player && client.player->GetNetworkObject();
+		Vector3 viewpoint	= hasPlayer ? client.player->GetTransform().GetPosition() : Vector3();
+		int		ownID		= hasPlayer ? client.player->GetNetworkObject()->GetNetworkID() : -1;
+		interest.Prioritise(hasPlayer ? &viewpoint : nullptr, client.priorities, relevantObjects, &sent);
+
+		//false if the snapshot's out of budget
+		auto writeState = [&](int id) {
+			if (id >= (int)networkObjects.size() || !networkObjects[id] || !worldState.GetState(id)) {
+				return true;
+			}
+			const NetworkState& state		= worldState.states[id];
+			const NetworkState* baseline	= sent.GetState(id);
+			if (!baseline || baseline->stateID != state.stateID) {
+				//It can still be a no-op, if the object has since moved back to where the client has it
+				if (networkObjects[id]->WritePacket(snapshot.BeginRecord(), state, baseline) && !snapshot.EndRecord()) {
+					return false;
+				}
+				sent.SetState(id, state);
+			}
+			InterestManager::ResetPriority(client.priorities, id);
+			return true;
+		};
+
+		snapshot.Begin(snapshotID, sent.baselineID, snapshotByteBudget, client.lastInput);
+		//The client's own player always goes first, as it can't correct its prediction without it
+		if (ownID >= 0) {
+			writeState(ownID);
+		}
+		for (int id : relevantObjects) {
+			if (id != ownID && !writeState(id)) {
+				break; //out of budget, everything left keeps its priority for next tick
+			}
+		}
+		snapshot.End();
+
+		for (int d = 0; d < snapshot.GetDatagramCount(); ++d) {
+			server.SendPacketToPeer(i.first, snapshot.GetDatagram(d));
+		}
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "SnapshotBuilder.h"
+#include "SnapshotHistory.h"
+#include "InterestManager.h"
+#include "NetworkObject.h"
+
+#include <map>
+#include <vector>
+#include <functional>
+
+namespace NCL {
+	namespace CSC8503 {
+		class GameServer;
+		class GameWorld;
+		class GameObject;
+
+		/*
+		The server's half of keeping every client's copy of the world up to date.
+
+		Every tick, the state of every networked object is captured, and each client
+		gets its own snapshot of the objects that are relevant to it (see
+		InterestManager), most important first, until its byte budget for the tick
+		runs out.
+
+		The snapshot is a delta against the newest one the client has acknowledged -
+		objects that haven't changed since then aren't sent at all (or even looked
+		at past a stateID check, see SendSnapshots), so the bandwidth and the time
+		taken depend on how much is moving, rather than how much there is. As a client
+		won't hear about everything every tick, we keep a ring per client of what
+		that client will have if each snapshot arrives, and it's those that get used
+		as baselines. Clients that haven't acknowledged anything yet (or not for
+		longer than the ring goes back) get full states.
+		*/
+		class ReplicationServer	{
+		public:
+			ReplicationServer();
+			~ReplicationServer();
+
+			void AddClient(int peerID);
+			void RemoveClient(int peerID);
+			int  GetClientCount() const {
+				return (int)clientStates.size();
+			}
+
+			//A client's interest is centred on its player, which always goes first in its snapshots
+			void SetClientPlayer(int peerID, GameObject* player);
+
+			typedef std::function<void(const PlayerInput&)> InputFunc;
+			//Takes note of a client's ack, and calls applyInput with each of its inputs we haven't already had, oldest first
+			bool ReceiveClientPacket(int peerID, GamePacket& payload, const InputFunc& applyInput);
+
+			//Sends every client a snapshot - networkObjects is indexed by network ID
+			void SendSnapshots(GameWorld& world, const std::vector<NetworkObject*>& networkObjects, GameServer& server);
+
+			//The ID the next snapshot will have
+			int GetSnapshotCounter() const {
+				return snapshotCounter;
+			}
+
+			//Per client, per tick
+			void SetByteBudget(int bytes) {
+				snapshotByteBudget = bytes;
+			}
+
+			//How many ticks it takes for every object to be sent again as a full state - 0 never refreshes
+			void SetRefreshInterval(int ticks) {
+				refreshInterval = ticks;
+			}
+
+			InterestManager& GetInterest() {
+				return interest;
+			}
+
+		protected:
+			struct ClientState {
+				int					lastAcked	= -1;		//the newest snapshot the client has acknowledged
+				SnapshotHistory		sent;					//what the client will have, if each snapshot we sent it arrives
+				std::vector<float>	priorities;				//see InterestManager
+				int					lastInput	= -1;		//the newest of the client's inputs that has been applied
+				GameObject*			player		= nullptr;
+			};
+			std::map<int, ClientState> clientStates;	//by peer ID
+
+			SnapshotBuilder		snapshot;
+			WorldSnapshot		worldState;
+			int					snapshotCounter;
+			InterestManager		interest;
+			std::vector<int>	relevantObjects;
+			int					snapshotByteBudget;
+			int					refreshInterval;
+		};
+	}
+}
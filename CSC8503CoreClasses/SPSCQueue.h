@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A fixed size ring buffer for passing things from exactly one thread to
+		exactly one other, without locks. Only the producer ever writes tail, and
+		only the consumer ever writes head, so each side just needs to see the
+		other's latest value - an acquire load pairs with the other side's release
+		store, which guarantees the item itself is visible before its slot is.
+
+		Head and tail are kept on separate cache lines, so the two threads aren't
+		constantly stealing the same line off each other. Each side also keeps a
+		cached copy of the other's index, and only reloads it when the ring looks
+		full (or empty), which keeps the shared lines quiet most of the time.
+		*/
+		template<class T>
+		class SPSCQueue	{
+		public:
+			SPSCQueue(size_t capacity) {
+				size_t size = 2;
+				while (size < capacity) {
+					size *= 2;
+				}
+				items.resize(size);
+				mask = size - 1;
+
+				head		= 0;
+				tail		= 0;
+				cachedHead	= 0;
+				cachedTail	= 0;
+			}
+
+			//Producer only - false if the queue is full
+			bool Push(const T& item) {
+				size_t t = tail.load(std::memory_order_relaxed);
+				if (t - cachedHead > mask) {
+					cachedHead = head.load(std::memory_order_acquire);
+					if (t - cachedHead > mask) {
+						return false;
+					}
+				}
+				items[t & mask] = item;
+				tail.store(t + 1, std::memory_order_release);
+				return true;
+			}
+
+			//Consumer only - false if the queue is empty
+			bool Pop(T& item) {
+				size_t h = head.load(std::memory_order_relaxed);
+				if (h == cachedTail) {
+					cachedTail = tail.load(std::memory_order_acquire);
+					if (h == cachedTail) {
+						return false;
+					}
+				}
+				item = items[h & mask];
+				head.store(h + 1, std::memory_order_release);
+				return true;
+			}
+
+			size_t GetCapacity() const {
+				return items.size();
+			}
+
+		protected:
+			std::vector<T>	items;
+			size_t			mask;
+
+			alignas(64) std::atomic<size_t>	head;	//next item to pop
+			size_t							cachedTail;	//the consumer's last look at tail
+
+			alignas(64) std::atomic<size_t>	tail;	//next free slot
+			size_t							cachedHead;	//the producer's last look at head
+		};
+	}
+}
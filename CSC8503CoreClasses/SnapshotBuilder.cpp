@@ -0,0 +1,131 @@
+#include "SnapshotBuilder.h"
+
+#include <cstring>
+#include <cstddef>
+
+using namespace NCL;
+using namespace CSC8503;
+
+const int BatchHeaderSize = sizeof(GamePacket) + sizeof(SnapshotHeader);
+const int MaxDatagrams	  = 255;
+
+SnapshotBuilder::SnapshotBuilder(int maxDatagramSize) :
+	datagramBody(maxDatagramSize - BatchHeaderSize),
+	datagramWriter(datagramBody.data(), datagramBody.size()),
+	recordWriter(recordBuffer, sizeof(recordBuffer)) {
+	this->maxDatagramSize	= maxDatagramSize;
+	recordCount				= 0;
+	datagramRecords			= 0;
+	snapshotID				= -1;
+	baselineID				= -1;
+	byteBudget				= INT_MAX;
+	lastInput				= -1;
+}
+
+SnapshotBuilder::~SnapshotBuilder() {
+}
+
+void SnapshotBuilder::Begin(int snapshotID, int baselineID, int byteBudget, int lastInput) {
+	this->snapshotID = snapshotID;
+	this->baselineID = baselineID;
+	this->byteBudget = byteBudget;
+	this->lastInput  = lastInput;
+	buffer.clear();
+	datagramStarts.clear();
+	datagramWriter.Reset();
+	recordCount		= 0;
+	datagramRecords = 0;
+}
+
+BitWriter& SnapshotBuilder::BeginRecord() {
+	recordWriter.Reset();
+	return recordWriter;
+}
+
+bool SnapshotBuilder::EndRecord() {
+	if (recordWriter.IsOverflowed() || recordWriter.GetBitCount() > datagramBody.size() * 8) {
+		return false;
+	}
+	bool newDatagram = recordWriter.GetBitCount() > datagramWriter.GetBitsRemaining() || datagramRecords == 0xFFFF;
+
+	size_t totalBytes = buffer.size() + BatchHeaderSize;
+	if (newDatagram) {
+		totalBytes += datagramWriter.GetByteCount() + BatchHeaderSize + recordWriter.GetByteCount();
+	}
+	else {
+		totalBytes += (datagramWriter.GetBitCount() + recordWriter.GetBitCount() + 7) / 8;
+	}
+	if (totalBytes > (size_t)byteBudget) {
+		return false;
+	}
+	if (newDatagram) {
+		if (GetDatagramCount() == MaxDatagrams - 1) {
+			return false;
+		}
+		FinishDatagram();
+	}
+	datagramWriter.WriteStream(recordWriter);
+	datagramRecords++;
+	recordCount++;
+	return true;
+}
+
+void SnapshotBuilder::End() {
+	//Even a snapshot with nothing in it gets a datagram, so the other end still hears about it
+	if (datagramRecords > 0 || datagramStarts.empty()) {
+		FinishDatagram();
+	}
+	//Only now is it known how many datagrams the snapshot needed
+	uint8_t count = (uint8_t)GetDatagramCount();
+	for (size_t start : datagramStarts) {
+		memcpy(&buffer[start + sizeof(GamePacket) + offsetof(SnapshotHeader, datagramCount)], &count, sizeof(uint8_t));
+	}
+}
+
+void SnapshotBuilder::FinishDatagram() {
+	size_t bodySize = datagramWriter.GetByteCount();
+	size_t start	= buffer.size();
+	datagramStarts.emplace_back(start);
+	buffer.resize(start + BatchHeaderSize + bodySize);
+
+	GamePacket packet(Snapshot_Batch);
+	packet.size = (short)(sizeof(SnapshotHeader) + bodySize);
+
+	SnapshotHeader header;
+	header.snapshotID		= snapshotID;
+	header.baselineID		= baselineID;
+	header.lastInput		= lastInput;
+	header.recordCount		= (uint16_t)datagramRecords;
+	header.datagramIndex	= (uint8_t)(datagramStarts.size() - 1);
+
+	memcpy(&buffer[start], &packet, sizeof(GamePacket));
+	memcpy(&buffer[start + sizeof(GamePacket)], &header, sizeof(SnapshotHeader));
+	memcpy(&buffer[start + BatchHeaderSize], datagramBody.data(), bodySize);
+
+	datagramWriter.Reset();
+	datagramRecords = 0;
+}
+
+bool SnapshotBuilder::ReadHeader(const GamePacket& batch, SnapshotHeader& header) {
+	if (batch.type != Snapshot_Batch || batch.size < (short)sizeof(SnapshotHeader)) {
+		return false;
+	}
+	memcpy(&header, (const char*)&batch + sizeof(GamePacket), sizeof(SnapshotHeader));
+	return header.datagramIndex < header.datagramCount;
+}
+
+bool SnapshotBuilder::ReadBatch(GamePacket& batch, const std::function<bool(BitReader&)>& func) {
+	SnapshotHeader header;
+	if (!ReadHeader(batch, header)) {
+		return false;
+	}
+	char* data = (char*)&batch + sizeof(GamePacket) + sizeof(SnapshotHeader);
+
+	BitReader reader(data, batch.size - sizeof(SnapshotHeader));
+	for (int i = 0; i < header.recordCount; ++i) {
+		if (!func(reader) || reader.IsOverflowed()) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "NetworkBase.h"
+#include "BitStream.h"
+
+#include <vector>
+#include <functional>
+#include <climits>
+
+namespace NCL {
+	namespace CSC8503 {
+		//Keeps each datagram under a typical internet path MTU, once ENet / UDP / IP have added their headers
+		const int SnapshotDatagramSize = 1200;
+
+		//Sent at the start of every datagram, straight after the GamePacket
+		struct SnapshotHeader {
+			int32_t		snapshotID		= -1;
+			int32_t		baselineID		= -1;	//the snapshot the delta records are relative to, or -1 if there are none
+			int32_t		lastInput		= -1;	//the newest of the receiving client's inputs the snapshot includes the effects of
+			uint16_t	recordCount		= 0;
+			uint8_t		datagramIndex	= 0;
+			uint8_t		datagramCount	= 0;	//how many datagrams the whole snapshot was split into
+		};
+
+		/*
+		Packs all of a tick's object updates into as few datagrams as possible. Each
+		datagram is a Snapshot_Batch GamePacket, then a SnapshotHeader, then the
+		bit-packed records one straight after another (see NetworkStateRecord).
+
+		Each record is written into a scratch stream first (BeginRecord / EndRecord),
+		so if it won't fit in the current datagram it can be moved to the next one
+		whole. Everything is kept between ticks, so after the first few ticks
+		building a snapshot doesn't allocate at all.
+		*/
+		class SnapshotBuilder	{
+		public:
+			SnapshotBuilder(int maxDatagramSize = SnapshotDatagramSize);
+			~SnapshotBuilder();
+
+			//byteBudget limits how big the whole snapshot can get, headers included
+			void Begin(int snapshotID = -1, int baselineID = -1, int byteBudget = INT_MAX, int lastInput = -1);
+			BitWriter&	BeginRecord();
+			bool		EndRecord();	//false if the record could never fit in a datagram, or the snapshot is full
+			void End();
+
+			int GetDatagramCount() const {
+				return (int)datagramStarts.size();
+			}
+			GamePacket& GetDatagram(int i) {
+				return *(GamePacket*)&buffer[datagramStarts[i]];
+			}
+			int GetRecordCount() const {
+				return recordCount;
+			}
+			int GetByteCount() const {
+				return (int)buffer.size();
+			}
+
+			static bool ReadHeader(const GamePacket& batch, SnapshotHeader& header);
+			//Calls func for each record in a Snapshot_Batch - it must read exactly one record, and return false to give up
+			static bool ReadBatch(GamePacket& batch, const std::function<bool(BitReader&)>& func);
+
+		protected:
+			void FinishDatagram();
+
+			std::vector<char>	buffer;
+			std::vector<size_t>	datagramStarts;
+			int					maxDatagramSize;
+			int					recordCount;
+			int					snapshotID;
+			int					baselineID;
+			int					byteBudget;
+			int					lastInput;
+
+			std::vector<uint8_t>	datagramBody;
+			BitWriter				datagramWriter;
+			int						datagramRecords;
+
+			uint8_t		recordBuffer[256];
+			BitWriter	recordWriter;
+		};
+	}
+}
@@ -0,0 +1,62 @@
+#include "SnapshotHistory.h"
+
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+void WorldSnapshot::SetState(int networkID, const NetworkState& state) {
+	if (networkID < 0) {
+		return;
+	}
+	if (networkID >= (int)hasState.size()) {
+		states.resize(networkID + 1);
+		hasState.resize(networkID + 1, 0);
+	}
+	states[networkID]	= state;
+	hasState[networkID] = 1;
+}
+
+SnapshotHistory::SnapshotHistory(int size) : snapshots(std::max(size, 2)) {
+}
+
+SnapshotHistory::~SnapshotHistory() {
+}
+
+WorldSnapshot& SnapshotHistory::Begin(int snapshotID, const WorldSnapshot* baseline) {
+	WorldSnapshot& s = snapshots[snapshotID % snapshots.size()];
+
+	//If the baseline is in the same slot, its states are already where they need to be
+	if (baseline != &s) {
+		if (baseline) {
+			s.states	= baseline->states;
+			s.hasState	= baseline->hasState;
+		}
+		else {
+			std::fill(s.hasState.begin(), s.hasState.end(), 0);
+		}
+	}
+	s.snapshotID			= snapshotID;
+	s.baselineID			= baseline ? baseline->snapshotID : -1;
+	s.datagramsReceived.clear();
+	s.datagramsRemaining	= 0;
+	return s;
+}
+
+WorldSnapshot* SnapshotHistory::Get(int snapshotID) {
+	if (snapshotID < 0) {
+		return nullptr;
+	}
+	WorldSnapshot& s = snapshots[snapshotID % snapshots.size()];
+	return s.snapshotID == snapshotID ? &s : nullptr;
+}
+
+void SnapshotHistory::Clear() {
+	for (WorldSnapshot& s : snapshots) {
+		s.snapshotID = -1;
+		s.baselineID = -1;
+		std::fill(s.hasState.begin(), s.hasState.end(), 0);
+		s.datagramsReceived.clear();
+		s.datagramsRemaining = 0;
+	}
+}
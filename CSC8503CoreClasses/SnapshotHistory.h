@@ -0,0 +1,67 @@
+#pragma once
+#include "NetworkState.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		The quantised state of every networked object at one tick, indexed by
+		network ID. The server keeps one per tick it has sent, so it can delta
+		against whichever one a client last acknowledged; clients keep one per
+		snapshot they've received, so they have something to apply those deltas to.
+		*/
+		struct WorldSnapshot {
+			int snapshotID = -1;
+			int baselineID = -1;	//the snapshot this one was built from, or -1 if it was sent as full states
+
+			std::vector<NetworkState>	states;
+			std::vector<uint8_t>		hasState;
+
+			//Client side - which of the datagrams this snapshot was split into have turned up
+			std::vector<uint8_t>		datagramsReceived;
+			int							datagramsRemaining = 0;
+
+			const NetworkState* GetState(int networkID) const {
+				if (networkID < 0 || networkID >= (int)hasState.size() || !hasState[networkID]) {
+					return nullptr;
+				}
+				return &states[networkID];
+			}
+
+			void SetState(int networkID, const NetworkState& state);
+
+			bool IsComplete() const {
+				return datagramsRemaining == 0;
+			}
+		};
+
+		/*
+		A fixed size ring of WorldSnapshots, indexed by snapshot ID. Looking one up
+		is just a modulo and an ID check, and as new snapshots overwrite the oldest,
+		nothing ever needs clearing out - a client that has fallen further behind
+		than the ring is long simply gets sent full states again.
+		*/
+		class SnapshotHistory	{
+		public:
+			SnapshotHistory(int size = 32);
+			~SnapshotHistory();
+
+			//Starts a new snapshot, as a copy of baseline if there is one
+			WorldSnapshot& Begin(int snapshotID, const WorldSnapshot* baseline = nullptr);
+
+			//nullptr if that snapshot was never stored, or has since been overwritten
+			WorldSnapshot* Get(int snapshotID);
+
+			void Clear();
+
+			int GetSize() const {
+				return (int)snapshots.size();
+			}
+
+		protected:
+			std::vector<WorldSnapshot> snapshots;
+		};
+	}
+}
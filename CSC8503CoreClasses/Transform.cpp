@@ -3,34 +3,115 @@
 using namespace NCL::CSC8503;
 
 Transform::Transform()	{
-	scale = Vector3(1, 1, 1);
+	scale		= Vector3(1, 1, 1);
+	parent		= nullptr;
+	worldDirty	= true;
+	localDirty	= true;
+	changeCount	= 0;
+}
+
+//Copies only take the local state - they don't join the other transform's hierarchy
+Transform::Transform(const Transform& other) : Transform() {
+	position	= other.position;
+	orientation	= other.orientation;
+	scale		= other.scale;
 }
 
 Transform::~Transform()	{
+	SetParent(nullptr);
+	for (Transform* c : children) {
+		c->parent = nullptr;
+		c->MarkWorldDirty();
+	}
+}
 
+Transform& Transform::operator=(const Transform& other) {
+	position	= other.position;
+	orientation	= other.orientation;
+	scale		= other.scale;
+	changeCount++;
+	MarkDirty();
+	return *this;
 }
 
-void Transform::UpdateMatrix() {
-	matrix =
+void Transform::UpdateLocalMatrix() const {
+	localMatrix =
 		Matrix::Translation(position) *
 		Quaternion::RotationMatrix<Matrix4>(orientation) *
 		Matrix::Scale(scale);
+	localDirty = false;
+}
+
+void Transform::UpdateMatrix() const {
+	if (parent) {
+		matrix = parent->GetMatrix() * GetLocalMatrix();
+	}
+	else {
+		matrix = GetLocalMatrix();
+	}
+	worldDirty = false;
+}
+
+void Transform::UpdateMatrices(Transform* const* transforms, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		if (transforms[i]->worldDirty) {
+			transforms[i]->UpdateMatrix();
+		}
+	}
+}
+
+void Transform::MarkDirty() {
+	localDirty = true;
+	MarkWorldDirty();
+}
+
+void Transform::MarkWorldDirty() {
+	if (worldDirty) {
+		return; //everything below us must already be dirty
+	}
+	worldDirty = true;
+	for (Transform* c : children) {
+		c->MarkWorldDirty();
+	}
+}
+
+Vector3 Transform::GetWorldPosition() const {
+	if (!parent) {
+		return position;
+	}
+	return Vector3(GetMatrix().GetColumn(3));
+}
+
+void Transform::SetParent(Transform* newParent) {
+	if (newParent == parent) {
+		return;
+	}
+	if (parent) {
+		parent->children.erase(std::remove(parent->children.begin(), parent->children.end(), this), parent->children.end());
+	}
+	parent = newParent;
+	if (parent) {
+		parent->children.emplace_back(this);
+	}
+	MarkWorldDirty();
 }
 
 Transform& Transform::SetPosition(const Vector3& worldPos) {
 	position = worldPos;
-	UpdateMatrix();
+	changeCount++;
+	MarkDirty();
 	return *this;
 }
 
 Transform& Transform::SetScale(const Vector3& worldScale) {
 	scale = worldScale;
-	UpdateMatrix();
+	MarkDirty();
 	return *this;
 }
 
 Transform& Transform::SetOrientation(const Quaternion& worldOrientation) {
 	orientation = worldOrientation;
-	UpdateMatrix();
+	changeCount++;
+	MarkDirty();
 	return *this;
-}
\ No newline at end of file
+}
@@ -6,12 +6,29 @@ using namespace NCL::Maths;
 
 namespace NCL {
 	namespace CSC8503 {
+		/*
+		Transforms only rebuild their matrix when something asks for it, and only if
+		the position, orientation or scale (or those of a parent) have changed since
+		the last time - setting all three in a row no longer means three rebuilds.
+
+		Position, orientation and scale are relative to the parent transform, if
+		there is one. Marking a transform dirty marks everything below it too, but
+		stops early at any child that is already dirty, so moving a parent costs
+		the same however often it happens during a frame.
+
+		Every write to the position or orientation also bumps a change count, so
+		things that only care whether an object has moved (like networking) can
+		tell without comparing the values themselves.
+		*/
 		class Transform
 		{
 		public:
 			Transform();
+			Transform(const Transform& other);
 			~Transform();
 
+			Transform& operator=(const Transform& other);
+
 			Transform& SetPosition(const Vector3& worldPos);
 			Transform& SetScale(const Vector3& worldScale);
 			Transform& SetOrientation(const Quaternion& newOr);
@@ -28,16 +45,62 @@ namespace NCL {
 				return orientation;
 			}
 
-			Matrix4 GetMatrix() const {
+			Vector3 GetWorldPosition() const;
+
+			const Matrix4& GetMatrix() const {
+				if (worldDirty) {
+					UpdateMatrix();
+				}
 				return matrix;
 			}
-			void UpdateMatrix();
+
+			const Matrix4& GetLocalMatrix() const {
+				if (localDirty) {
+					UpdateLocalMatrix();
+				}
+				return localMatrix;
+			}
+
+			bool IsDirty() const {
+				return worldDirty;
+			}
+
+			//Local position / orientation writes only - parents moving don't count
+			uint32_t GetChangeCount() const {
+				return changeCount;
+			}
+
+			void UpdateMatrix() const;
+
+			void		SetParent(Transform* newParent);
+			Transform*	GetParent() const {
+				return parent;
+			}
+			const std::vector<Transform*>& GetChildren() const {
+				return children;
+			}
+
+			//Brings a whole batch of transforms up to date in one pass, skipping clean ones
+			static void UpdateMatrices(Transform* const* transforms, size_t count);
+
 		protected:
-			Matrix4		matrix;
+			void MarkDirty();
+			void MarkWorldDirty();
+			void UpdateLocalMatrix() const;
+
+			mutable Matrix4	matrix;
+			mutable Matrix4	localMatrix;
+			mutable bool	worldDirty;
+			mutable bool	localDirty;
+			uint32_t		changeCount;
+
 			Quaternion	orientation;
 			Vector3		position;
 
 			Vector3		scale;
+
+			Transform*				parent;
+			std::vector<Transform*>	children;
 		};
 	}
 }
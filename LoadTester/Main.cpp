@@ -0,0 +1,380 @@
+#include "GameServer.h"
+#include "GameClient.h"
+#include "LoopbackTransport.h"
+#include "ReplicationServer.h"
+#include "ReplicationClient.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "NetworkObject.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+
+/*
+Headless load tester for the networking. Runs a server and lots of simulated
+clients in one process, all talking over a LoopbackNetwork rather than real
+sockets, so nothing needs a window or a network card. The server replicates a
+world full of objects using the same ReplicationServer as the game does, and
+each client decodes its snapshots with a ReplicationClient, acknowledging them
+and sending inputs for its player just like a real one.
+
+Everything runs in real time on this one thread. At the end, it reports how
+long the server's ticks took, how many bytes went to and from each client
+(packet payloads only - a real network adds around 40 bytes of UDP / ENet
+headers to each packet on top), and how long after being sent each snapshot
+was complete on its client.
+
+LoadTester [-clients <n>] [-objects <n>] [-moving <fraction>] [-seconds <s>] [-rate <hz>]
+		   [-latency <ms>] [-loss <percent>] [-budget <bytes>] [-refresh <ticks>]
+*/
+using Clock		= std::chrono::steady_clock;
+using Seconds	= std::chrono::duration<double>;
+
+const float PlayerSpeed		= 10.0f;
+const float WorldExtent		= 400.0f;
+const float InputRate		= 60.0f;
+const int	MaxPendingInputs = 64;
+
+double Percentile(std::vector<double> values, double p) {
+	if (values.empty()) {
+		return 0.0;
+	}
+	std::sort(values.begin(), values.end());
+	size_t i = std::min(values.size() - 1, (size_t)(p * values.size()));
+	return values[i];
+}
+
+double Mean(const std::vector<double>& values) {
+	double total = 0.0;
+	for (double v : values) {
+		total += v;
+	}
+	return values.empty() ? 0.0 : total / values.size();
+}
+
+void MovePlayer(GameObject& player, const PlayerInput& input, float dt) {
+	Vector3 direction((input.buttons & 1) ? 1.0f : ((input.buttons & 2) ? -1.0f : 0.0f), 0.0f,
+					  (input.buttons & 4) ? 1.0f : ((input.buttons & 8) ? -1.0f : 0.0f));
+	player.GetTransform().SetPosition(player.GetTransform().GetPosition() + (direction * PlayerSpeed * dt));
+}
+
+class TestServer final : public PacketReceiver {
+public:
+	TestServer(LoopbackNetwork& network, int maxClients, int objectCount, float movingFraction) :
+		server(new LoopbackTransport(network, true), maxClients), random(1234), movingFraction(movingFraction) {
+		server.RegisterPacketHandler(Received_State, this);
+		server.RegisterPacketHandler(Player_Connected, this);
+		server.RegisterPacketHandler(Player_Disconnected, this);
+
+		//Each client's player gets the same network ID as the client's peer ID, everything else comes after
+		for (int i = 0; i < maxClients + objectCount; ++i) {
+			GameObject* o = new GameObject();
+			o->GetTransform().SetPosition(RandomPosition());
+			o->SetNetworkObject(new NetworkObject(*o, i));
+			world.AddGameObject(o);
+			objects.emplace_back(o);
+			networkObjects.emplace_back(o->GetNetworkObject());
+			velocities.emplace_back(Vector3());
+		}
+		playerCount = maxClients;
+	}
+
+	~TestServer() {
+		world.ClearAndErase();
+	}
+
+	void ReceivePacket(int type, GamePacket* payload, int source) override {
+		if (type == Received_State) {
+			replication.ReceiveClientPacket(source, *payload, [&](const PlayerInput& input) {
+				MovePlayer(*objects[source], input, 1.0f / InputRate);
+			});
+		}
+		else if (type == Player_Connected) {
+			replication.AddClient(source);
+			replication.SetClientPlayer(source, objects[source]);
+		}
+		else if (type == Player_Disconnected) {
+			replication.RemoveClient(source);
+		}
+	}
+
+	//Returns how long the server's side of the tick took, in seconds
+	double Tick(float dt) {
+		MoveObjects(dt);
+
+		Clock::time_point start = Clock::now();
+		server.UpdateServer();
+		replication.SendSnapshots(world, networkObjects, server);
+		return Seconds(Clock::now() - start).count();
+	}
+
+	void SetByteBudget(int bytes) {
+		replication.SetByteBudget(bytes);
+	}
+
+	void SetRefreshInterval(int ticks) {
+		replication.SetRefreshInterval(ticks);
+	}
+
+	int GetSnapshotCounter() const {
+		return replication.GetSnapshotCounter();
+	}
+
+protected:
+	Vector3 RandomPosition() {
+		std::uniform_real_distribution<float> d(-WorldExtent, WorldExtent);
+		return Vector3(d(random), 0.0f, d(random));
+	}
+
+	//The first movingFraction of the objects wander about, and the rest stay where they are
+	void MoveObjects(float dt) {
+		std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+		int moving = (int)((objects.size() - playerCount) * movingFraction);
+		for (int i = playerCount; i < playerCount + moving; ++i) {
+			Vector3& v = velocities[i];
+			v = Vector::Clamp(v + Vector3(d(random), 0.0f, d(random)), Vector3(-5, 0, -5), Vector3(5, 0, 5));
+
+			Transform& t = objects[i]->GetTransform();
+			t.SetPosition(Vector::Clamp(t.GetPosition() + (v * dt), Vector3(-WorldExtent, 0, -WorldExtent), Vector3(WorldExtent, 0, WorldExtent)));
+			t.SetOrientation(Quaternion::EulerAnglesToQuaternion(0.0f, Maths::RadiansToDegrees(atan2(v.x, v.z)), 0.0f));
+		}
+	}
+
+	GameServer			server;
+	ReplicationServer	replication;
+	GameWorld			world;
+
+	std::vector<GameObject*>	objects;
+	std::vector<NetworkObject*>	networkObjects;
+	std::vector<Vector3>		velocities;
+	int							playerCount;
+
+	std::mt19937	random;
+	float			movingFraction;
+};
+
+/*
+Clients only decode their snapshots, they don't have any objects to apply them
+to - so hundreds of them can share the process without it running out of memory.
+*/
+class TestClient final : public PacketReceiver {
+public:
+	TestClient(LoopbackNetwork& network, int playerID, int seed) : client(new LoopbackTransport(network)), random(seed) {
+		client.RegisterPacketHandler(Snapshot_Batch, this);
+		connected			= client.Connect(127, 0, 0, 1, NetworkBase::GetDefaultPort());
+		firstPendingInput	= 0;
+		latestSnapshot		= -1;
+		replication.SetPredictedObject(playerID);
+	}
+
+	void ReceivePacket(int /*type*/, GamePacket* payload, int /*source*/) override {
+		replication.ReadSnapshot(*payload, noObjects);
+
+		NetworkState	state;
+		int				lastInput;
+		if (replication.PopCorrection(state, lastInput)) {
+			int acknowledged = std::clamp(lastInput - firstPendingInput + 1, 0, (int)pendingInputs.size());
+			pendingInputs.erase(pendingInputs.begin(), pendingInputs.begin() + acknowledged);
+			firstPendingInput += acknowledged;
+		}
+	}
+
+	//Each time a snapshot is complete, how long ago it was sent is recorded
+	void Update(const std::map<int, Clock::time_point>& sendTimes, std::vector<double>& latencies) {
+		client.UpdateClient();
+
+		int latest = replication.GetLatestSnapshot();
+		if (latest > latestSnapshot) {
+			auto sent = sendTimes.find(latest);
+			if (sent != sendTimes.end()) {
+				latencies.emplace_back(Seconds(Clock::now() - sent->second).count());
+			}
+			latestSnapshot = latest;
+		}
+	}
+
+	//Holds a random direction down for a while, like a player would
+	void SampleInput() {
+		if (random() % 30 == 0) {
+			currentInput.buttons = (uint8_t)(random() % 16);
+		}
+		if ((int)pendingInputs.size() == MaxPendingInputs) {
+			pendingInputs.erase(pendingInputs.begin());
+			firstPendingInput++;
+		}
+		pendingInputs.emplace_back(currentInput);
+	}
+
+	void SendInput() {
+		ClientPacket packet;
+		packet.lastID		= replication.GetLatestSnapshot();
+		packet.firstInput	= firstPendingInput;
+
+		int inputCount = std::min((int)pendingInputs.size(), MaxClientInputs);
+		std::copy(pendingInputs.begin(), pendingInputs.begin() + inputCount, packet.inputs);
+		packet.SetInputCount(inputCount);
+
+		client.SendPacket(packet);
+	}
+
+	bool IsConnected() const {
+		return connected;
+	}
+
+protected:
+	GameClient			client;
+	ReplicationClient	replication;
+	bool				connected;
+	int					latestSnapshot;
+
+	std::vector<PlayerInput>	pendingInputs;
+	int							firstPendingInput;
+	PlayerInput					currentInput;
+
+	std::mt19937				random;
+	std::vector<NetworkObject*>	noObjects;
+};
+
+int main(int argc, char** argv) {
+	int		clientCount		= 16;
+	int		objectCount		= 5000;
+	float	movingFraction	= 0.1f;
+	float	seconds			= 10.0f;
+	float	rate			= 20.0f;
+	float	latency			= 50.0f;
+	float	loss			= 0.0f;
+	int		budget			= SnapshotDatagramSize * 2;
+	int		refresh			= 200;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::cout << "Missing value for " << arg << "\n";
+			return 1;
+		}
+		if (arg == "-clients") {
+			clientCount = std::stoi(argv[++i]);
+		}
+		else if (arg == "-objects") {
+			objectCount = std::stoi(argv[++i]);
+		}
+		else if (arg == "-moving") {
+			movingFraction = std::stof(argv[++i]);
+		}
+		else if (arg == "-seconds") {
+			seconds = std::stof(argv[++i]);
+		}
+		else if (arg == "-rate") {
+			rate = std::stof(argv[++i]);
+		}
+		else if (arg == "-latency") {
+			latency = std::stof(argv[++i]);
+		}
+		else if (arg == "-loss") {
+			loss = std::stof(argv[++i]);
+		}
+		else if (arg == "-budget") {
+			budget = std::stoi(argv[++i]);
+		}
+		else if (arg == "-refresh") {
+			refresh = std::stoi(argv[++i]);
+		}
+		else {
+			std::cout << "Unknown argument " << arg << "\n";
+			std::cout << "Usage: LoadTester [-clients <n>] [-objects <n>] [-moving <fraction>] [-seconds <s>] [-rate <hz>] "
+				"[-latency <ms>] [-loss <percent>] [-budget <bytes>] [-refresh <ticks>]\n";
+			return 1;
+		}
+	}
+
+	LoopbackNetwork network(clientCount);
+	network.SetLatency(latency / 1000.0f);
+	network.SetPacketLoss(loss / 100.0f);
+
+	TestServer server(network, clientCount, objectCount, movingFraction);
+	server.SetByteBudget(budget);
+	server.SetRefreshInterval(refresh);
+
+	std::vector<TestClient*> clients;
+	for (int i = 0; i < clientCount; ++i) {
+		clients.emplace_back(new TestClient(network, i, i + 1));
+	}
+
+	std::map<int, Clock::time_point>	sendTimes;	//by snapshot ID
+	std::vector<double>					tickTimes;
+	std::vector<double>					latencies;
+	int									overruns = 0;
+
+	Clock::duration tickInterval	= std::chrono::duration_cast<Clock::duration>(Seconds(1.0 / rate));
+	Clock::duration inputInterval	= std::chrono::duration_cast<Clock::duration>(Seconds(1.0 / InputRate));
+
+	Clock::time_point start		= Clock::now();
+	Clock::time_point end		= start + std::chrono::duration_cast<Clock::duration>(Seconds(seconds));
+	Clock::time_point nextTick	= start;
+	Clock::time_point nextInput	= start;
+
+	while (Clock::now() < end) {
+		Clock::time_point now = Clock::now();
+
+		if (now >= nextTick) {
+			sendTimes[server.GetSnapshotCounter()] = now;
+			double tickTime = server.Tick(1.0f / rate);
+			tickTimes.emplace_back(tickTime);
+			if (tickTime > 1.0 / rate) {
+				overruns++;
+			}
+			for (TestClient* c : clients) {
+				c->SendInput();
+			}
+			nextTick += tickInterval;
+		}
+		if (now >= nextInput) {
+			for (TestClient* c : clients) {
+				c->SampleInput();
+			}
+			nextInput += inputInterval;
+		}
+		for (TestClient* c : clients) {
+			c->Update(sendTimes, latencies);
+		}
+		std::this_thread::sleep_until(std::min({ nextTick, nextInput, now + std::chrono::milliseconds(1) }));
+	}
+	double elapsed = Seconds(Clock::now() - start).count();
+
+	std::vector<double> bytesDown;
+	std::vector<double> bytesUp;
+	int connected = 0;
+	for (int i = 0; i < clientCount; ++i) {
+		LoopbackNetwork::PeerStats stats = network.GetStats(i);
+		bytesDown.emplace_back(stats.bytesToClient / elapsed);
+		bytesUp.emplace_back(stats.bytesFromClient / elapsed);
+		connected += clients[i]->IsConnected() ? 1 : 0;
+	}
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << clientCount << " clients (" << connected << " connected), " << objectCount << " objects, "
+		<< (movingFraction * 100.0f) << "% moving, " << rate << "Hz, " << latency << "ms latency, " << loss << "% loss, "
+		<< budget << " byte budget, refresh every " << refresh << " ticks, " << elapsed << "s\n";
+	std::cout << "Server tick:   mean " << Mean(tickTimes) * 1000.0 << "ms, p99 " << Percentile(tickTimes, 0.99) * 1000.0
+		<< "ms, max " << Percentile(tickTimes, 1.0) * 1000.0 << "ms, " << overruns << " of " << tickTimes.size() << " ticks overran\n";
+	std::cout << "Per client:    down mean " << Mean(bytesDown) << " B/s (min " << Percentile(bytesDown, 0.0)
+		<< ", max " << Percentile(bytesDown, 1.0) << "), up mean " << Mean(bytesUp) << " B/s\n";
+	std::cout << "Server total:  down " << Mean(bytesDown) * clientCount / 1024.0 << " KB/s\n";
+	std::cout << "Snapshot latency: mean " << Mean(latencies) * 1000.0 << "ms, p99 " << Percentile(latencies, 0.99) * 1000.0
+		<< "ms, over " << latencies.size() << " snapshots\n";
+
+	for (TestClient* c : clients) {
+		delete c;
+	}
+	return 0;
+}
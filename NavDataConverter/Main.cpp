@@ -0,0 +1,74 @@
+#include "NavigationGrid.h"
+#include "NavigationMesh.h"
+#include "HierarchicalNavigationGrid.h"
+#include "NavigationDataFile.h"
+
+#include <iostream>
+#include <string>
+
+using namespace NCL;
+using namespace CSC8503;
+
+/*
+Offline converter from the text navigation formats into a compiled .navdata
+file, which the game can then memory map instead of parsing. All of the file
+names are relative to the Assets/Data folder, as with the rest of the game.
+
+NavDataConverter <output.navdata> [-grid <grid.txt> [-clusters <size>]] [-mesh <mesh.navmesh>]
+*/
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cout << "Usage: NavDataConverter <output.navdata> [-grid <grid.txt> [-clusters <size>]] [-mesh <mesh.navmesh>]\n";
+		return 1;
+	}
+	std::string outputName = argv[1];
+	std::string gridName;
+	std::string meshName;
+	int clusterSize = 16;
+
+	for (int i = 2; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "-grid" && i + 1 < argc) {
+			gridName = argv[++i];
+		}
+		else if (arg == "-mesh" && i + 1 < argc) {
+			meshName = argv[++i];
+		}
+		else if (arg == "-clusters" && i + 1 < argc) {
+			clusterSize = std::stoi(argv[++i]);
+		}
+		else {
+			std::cout << "Unknown argument " << arg << "\n";
+			return 1;
+		}
+	}
+
+	NavigationDataWriter writer;
+
+	if (!gridName.empty()) {
+		NavigationGrid grid(gridName);
+		if (grid.GetNodeCount() == 0) {
+			std::cout << "Couldn't load grid " << gridName << "\n";
+			return 1;
+		}
+		HierarchicalNavigationGrid hierarchy(grid, clusterSize);
+
+		grid.WriteNavData(writer);
+		hierarchy.WriteNavData(writer);
+
+		std::cout << "Grid " << gridName << ": " << grid.GetGridWidth() << " x " << grid.GetGridHeight() << " nodes, "
+			<< hierarchy.GetAbstractNodeCount() << " abstract nodes\n";
+	}
+	if (!meshName.empty()) {
+		NavigationMesh mesh(meshName);
+		mesh.WriteNavData(writer);
+		std::cout << "Mesh " << meshName << " converted\n";
+	}
+
+	if (!writer.Save(outputName)) {
+		std::cout << "Couldn't write " << outputName << "\n";
+		return 1;
+	}
+	std::cout << "Wrote " << outputName << "\n";
+	return 0;
+}
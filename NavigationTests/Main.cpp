@@ -0,0 +1,344 @@
+#include "NavigationMesh.h"
+#include "NavigationGrid.h"
+#include "FlowField.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+
+using namespace NCL;
+using namespace CSC8503;
+
+/*
+Regression tests for the navigation code - each test prints what went wrong,
+and the program returns 1 if any of them failed, so it can be run by ctest.
+*/
+static int failures = 0;
+
+static void Check(bool condition, const std::string& test, const std::string& message) {
+	if (!condition) {
+		std::cout << test << ": " << message << "\n";
+		failures++;
+	}
+}
+
+static std::string ToString(const std::vector<Vector3>& points) {
+	std::string s;
+	for (const Vector3& p : points) {
+		s += "(" + std::to_string(p.x) + ", " + std::to_string(p.z) + ") ";
+	}
+	return s;
+}
+
+static bool NearlyEqual(const Vector3& a, const Vector3& b) {
+	return Vector::LengthSquared(a - b) < 0.0001f;
+}
+
+/*
+A navmesh of square cells on the XZ plane, cellSize units across, each split
+into two triangles along one of its diagonals. The neighbours are worked out
+from the shared edges, just as they would be in a .navmesh file.
+*/
+class CellMesh : public NavigationMesh {
+public:
+	struct Cell {
+		int x;
+		int z;
+	};
+
+	CellMesh(const std::vector<Cell>& cells, int width, int height, bool alternateDiagonals) {
+		const float cellSize = 10.0f;
+		for (int z = 0; z <= height; ++z) {
+			for (int x = 0; x <= width; ++x) {
+				allVerts.emplace_back(Vector3(x * cellSize, 0.0f, z * cellSize));
+			}
+		}
+		auto Vert = [&](int x, int z) {
+			return (z * (width + 1)) + x;
+		};
+		for (const Cell& c : cells) {
+			int a = Vert(c.x, c.z);
+			int b = Vert(c.x + 1, c.z);
+			int d = Vert(c.x + 1, c.z + 1);
+			int e = Vert(c.x, c.z + 1);
+
+			bool flip = alternateDiagonals && ((c.x + c.z) & 1);
+			AddTri(a, b, flip ? e : d);
+			AddTri(flip ? b : a, d, e);
+		}
+		for (NavTri& t : allTris) {
+			for (int j = 0; j < 3; ++j) {
+				int e0 = t.indices[j];
+				int e1 = t.indices[(j + 1) % 3];
+				for (NavTri& other : allTris) {
+					int shared = 0;
+					for (int k = 0; k < 3; ++k) {
+						shared += (other.indices[k] == e0 || other.indices[k] == e1) ? 1 : 0;
+					}
+					if (&other != &t && shared == 2) {
+						t.neighbours[j] = &other;
+					}
+				}
+			}
+		}
+		BuildPortals();
+		BuildTriLookup();
+	}
+
+	std::vector<Vector3> Path(const Vector3& from, const Vector3& to) {
+		std::vector<Vector3> points;
+		NavigationPath path;
+		if (FindPath(from, to, path)) {
+			Vector3 p;
+			while (path.PopWaypoint(p)) {
+				points.emplace_back(p);
+			}
+		}
+		return points;
+	}
+
+	bool OnMesh(const Vector3& p) const {
+		for (const NavTri& t : allTris) {
+			if (PointInTriXZ(t, p)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+protected:
+	void AddTri(int a, int b, int c) {
+		NavTri t;
+		t.indices[0] = a;
+		t.indices[1] = b;
+		t.indices[2] = c;
+		t.centroid = (allVerts[a] + allVerts[b] + allVerts[c]) / 3.0f;
+		allTris.emplace_back(t);
+	}
+};
+
+/*
+The start point is on the diagonal between its cell's two triangles, so the
+first portal goes straight through it - that used to make the funnel go back
+to the cell's corner first, and then add the real corner twice.
+*/
+static void TestFunnelStartOnPortal() {
+	const std::string test = "FunnelStartOnPortal";
+	CellMesh mesh({ {2, 0}, {1, 1}, {2, 1}, {0, 2}, {1, 2} }, 3, 3, false);
+
+	std::vector<Vector3> path		= mesh.Path(Vector3(23, 0, 3), Vector3(16, 0, 13));
+	std::vector<Vector3> expected	= { Vector3(23, 0, 3), Vector3(20, 0, 10), Vector3(16, 0, 13) };
+
+	bool same = path.size() == expected.size();
+	for (size_t i = 0; same && i < path.size(); ++i) {
+		same = NearlyEqual(path[i], expected[i]);
+	}
+	Check(same, test, "expected " + ToString(expected) + "got " + ToString(path));
+}
+
+/*
+Lots of random paths across random meshes - none of them should ever have the
+same waypoint twice in a row, or cut across a hole in the mesh.
+*/
+static void TestFunnelRandomPaths() {
+	const std::string test = "FunnelRandomPaths";
+	const int size = 8;
+
+	std::mt19937 random(1);
+	std::uniform_int_distribution<int> cellRoll(0, 3);
+	std::uniform_real_distribution<float> offsetRoll(0.0f, 10.0f);
+
+	int duplicates	= 0;
+	int offMesh		= 0;
+	for (int m = 0; m < 100; ++m) {
+		std::vector<CellMesh::Cell> cells;
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				if (cellRoll(random) > 0) { //a quarter of the cells are holes
+					cells.push_back({ x, z });
+				}
+			}
+		}
+		CellMesh mesh(cells, size, size, true);
+		std::uniform_int_distribution<int> pickCell(0, (int)cells.size() - 1);
+
+		for (int q = 0; q < 30; ++q) {
+			const CellMesh::Cell& a = cells[pickCell(random)];
+			const CellMesh::Cell& b = cells[pickCell(random)];
+			Vector3 from(a.x * 10.0f + offsetRoll(random), 0.0f, a.z * 10.0f + offsetRoll(random));
+			Vector3 to(b.x * 10.0f + offsetRoll(random), 0.0f, b.z * 10.0f + offsetRoll(random));
+
+			std::vector<Vector3> path = mesh.Path(from, to);
+			for (size_t i = 1; i < path.size(); ++i) {
+				duplicates += NearlyEqual(path[i - 1], path[i]) ? 1 : 0;
+				for (int step = 1; step < 20; ++step) {
+					if (!mesh.OnMesh(path[i - 1] + (path[i] - path[i - 1]) * (step / 20.0f))) {
+						offMesh++;
+						break;
+					}
+				}
+			}
+		}
+	}
+	Check(duplicates == 0, test, std::to_string(duplicates) + " duplicate waypoints");
+	Check(offMesh == 0, test, std::to_string(offMesh) + " path segments leave the mesh");
+}
+
+/*
+Compares a flow field against one built from scratch on the same grid - after
+any repair, they should be exactly the same, costs and directions both.
+*/
+static int CountDifferences(const NavigationGrid& grid, const FlowField& field, const FlowField& fresh) {
+	int differences = 0;
+	for (int i = 0; i < grid.GetNodeCount(); ++i) {
+		Vector3 position = grid.GetNode(i).position;
+		Vector3 a;
+		Vector3 b;
+		bool hasA = field.GetDirection(position, a);
+		bool hasB = fresh.GetDirection(position, b);
+		if (field.GetCostToGoal(position) != fresh.GetCostToGoal(position) ||
+			hasA != hasB || (hasA && !NearlyEqual(a, b))) {
+			differences++;
+		}
+	}
+	return differences;
+}
+
+//Follows the directions from start, returning the nodes visited, or nothing if it never gets to the goal
+static std::vector<int> FollowField(const NavigationGrid& grid, const FlowField& field, int start, int goal) {
+	std::vector<int> route;
+	int current = start;
+	while (current >= 0 && (int)route.size() <= grid.GetNodeCount()) {
+		route.emplace_back(current);
+		if (current == goal) {
+			return route;
+		}
+		Vector3 position = grid.GetNode(current).position;
+		Vector3 direction;
+		if (!field.GetDirection(position, direction)) {
+			break;
+		}
+		current = grid.GetNodeIndex(position + direction * (float)grid.GetNodeSize());
+	}
+	return {};
+}
+
+/*
+Blocks a node in the middle of the route the field is sending everything
+along - the field should hear about it, and steer around it from then on,
+without waiting for the goal to move.
+*/
+static void TestFlowFieldBlockedRoute() {
+	const std::string test = "FlowFieldBlockedRoute";
+	const int width		= 40;
+	const int height	= 40;
+	std::string types(width * height, '.');
+	NavigationGrid grid(10, width, height, types.c_str());
+
+	int start	= (20 * width) + 0;
+	int goal	= (20 * width) + 39;
+
+	FlowField field(grid);
+	field.SetGoal(grid.GetNode(goal).position);
+	field.Update();
+
+	std::vector<int> route = FollowField(grid, field, start, goal);
+	Check(route.size() == 40, test, "expected a straight route to the goal before blocking");
+	if (route.size() < 3) {
+		return;
+	}
+	int blocked = route[route.size() / 2];
+	grid.AddBlocker(blocked % width, blocked / width);
+	field.Update();
+
+	route = FollowField(grid, field, start, goal);
+	Check(!route.empty(), test, "no route to the goal after blocking");
+	for (int node : route) {
+		Check(node != blocked, test, "the route still goes through the blocked node");
+	}
+	Check(field.GetRepairedCount() < grid.GetNodeCount(), test, "the repair looked at the whole grid");
+
+	FlowField fresh(grid);
+	fresh.SetGoal(grid.GetNode(goal).position);
+	fresh.Update();
+	Check(CountDifferences(grid, field, fresh) == 0, test, "the field doesn't match a fresh one after blocking");
+
+	grid.RemoveBlocker(blocked % width, blocked / width);
+	field.Update();
+	fresh.Update();
+	Check(FollowField(grid, field, start, goal).size() == 40, test, "expected a straight route again after unblocking");
+	Check(CountDifferences(grid, field, fresh) == 0, test, "the field doesn't match a fresh one after unblocking");
+}
+
+/*
+Lots of random batches of blockers coming and going, sometimes while a build
+for a new goal is only part of the way through, and sometimes on the goal
+itself - after each, the field should match one built from scratch.
+*/
+static void TestFlowFieldRandomEdits() {
+	const std::string test = "FlowFieldRandomEdits";
+	const int width		= 30;
+	const int height	= 30;
+
+	std::mt19937 random(2);
+	std::uniform_int_distribution<int> wallRoll(0, 4);
+	std::uniform_int_distribution<int> nodeRoll(0, (width * height) - 1);
+	std::uniform_int_distribution<int> countRoll(1, 6);
+
+	std::string types(width * height, '.');
+	for (char& c : types) {
+		c = wallRoll(random) == 0 ? 'x' : '.';
+	}
+	NavigationGrid grid(10, width, height, types.c_str());
+	int goal = nodeRoll(random);
+	FlowField field(grid);
+	field.SetGoal(grid.GetNode(goal).position);
+	field.Update();
+
+	std::vector<int> blocked;
+	int failedEdits = 0;
+	for (int edit = 0; edit < 300; ++edit) {
+		if (edit % 25 == 0) { //move the goal, and make changes while it's being built
+			goal = nodeRoll(random);
+			field.SetGoal(grid.GetNode(goal).position);
+			field.Update(50);
+		}
+		grid.BeginEdit();
+		int count = countRoll(random);
+		for (int i = 0; i < count; ++i) {
+			if (!blocked.empty() && wallRoll(random) < 2) {
+				int node = blocked.back();
+				blocked.pop_back();
+				grid.RemoveBlocker(node % width, node / width);
+			}
+			else {
+				int node = nodeRoll(random);
+				blocked.emplace_back(node);
+				grid.AddBlocker(node % width, node / width);
+			}
+		}
+		grid.EndEdit();
+		field.Update();
+
+		FlowField fresh(grid);
+		fresh.SetGoal(grid.GetNode(goal).position);
+		fresh.Update();
+		failedEdits += CountDifferences(grid, field, fresh) > 0 ? 1 : 0;
+	}
+	Check(failedEdits == 0, test, std::to_string(failedEdits) + " edits left the field different to a fresh one");
+}
+
+int main() {
+	TestFunnelStartOnPortal();
+	TestFunnelRandomPaths();
+	TestFlowFieldBlockedRoute();
+	TestFlowFieldRandomEdits();
+
+	if (failures > 0) {
+		std::cout << failures << " check(s) failed\n";
+		return 1;
+	}
+	std::cout << "All navigation tests passed\n";
+	return 0;
+}